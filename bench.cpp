@@ -0,0 +1,773 @@
+#include "include/uri.hpp"
+#include "include/uri_batch.hpp"
+#include "include/uri_host_matcher.hpp"
+#include "include/uri_index.hpp"
+#include "include/uri_policy.hpp"
+#include "include/uri_resolve.hpp"
+#include "include/uri_router.hpp"
+#include "include/uri_static.hpp"
+#include "include/uri_store.hpp"
+#include "include/uri_stream.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "psapi")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+// Benchmarks the parser and builder over a synthetic corpus, or over a file of one href per line.
+//
+//   bench [--count N] [--seed S] [--rounds R] [--corpus FILE] [--filter TEXT] [--dump]
+//
+// Every benchmark reports the best of R passes over its hrefs as ns/URI and MB/s, the heap allocations of one pass
+// per URI, and the peak RSS of the process so far. --dump prints the corpus instead, for reuse with --corpus.
+// Redirect the report to bench_output.txt to keep it out of the tree.
+
+static std::atomic<std::uint64_t> allocations(0);
+
+// The replacements below pair malloc with free, which GCC cannot see through once they are inlined
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+   allocations.fetch_add(1, std::memory_order_relaxed);
+   if (void* p = std::malloc(size ? size : 1)) return p;
+   throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+   return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+   std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+   std::free(p);
+}
+
+static std::size_t peak_rss_kib() {
+#if defined(_WIN32)
+   PROCESS_MEMORY_COUNTERS counters;
+   if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+   return counters.PeakWorkingSetSize / 1024;
+#else
+   struct rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+   return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#else
+   return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// xorshift64*, so the corpus is the same on every platform and standard library
+class Random {
+   public:
+   explicit Random(std::uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+   std::uint64_t next() {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 0x2545F4914F6CDD1Dull;
+   }
+
+   std::size_t below(std::size_t n) {
+      return static_cast<std::size_t>(next() % n);
+   }
+
+   std::size_t between(std::size_t low, std::size_t high) {
+      return low + below(high - low + 1);
+   }
+
+   bool chance(unsigned percent) {
+      return below(100) < percent;
+   }
+
+   private:
+   std::uint64_t state;
+};
+
+enum class Kind { absolute, relative, userinfo, ipv4, ipv6, long_query, opaque, count };
+
+static const char* const kind_names[] = {"absolute", "relative", "userinfo", "ipv4", "ipv6", "long-query", "opaque"};
+
+struct Href {
+   std::string text;
+   Kind kind;
+};
+
+static const char* const words[] = {"api", "v1", "v2", "users", "orders", "items", "search", "static", "assets", "img",
+                                    "css", "js", "blog", "2024", "posts", "docs", "index.html", "login", "cart", "product",
+                                    "media", "video", "download", "latest", "en-US", "help", "account", "settings", "feed", "tags"};
+static const char* const tlds[] = {"com", "org", "net", "io", "de", "co.uk"};
+static const char* const keys[] = {"q", "page", "sort", "utm_source", "utm_medium", "id", "lang", "ref", "session", "filter"};
+
+static std::string word(Random& random) {
+   return words[random.below(sizeof(words) / sizeof(*words))];
+}
+
+static std::string host(Random& random) {
+   std::string h = random.chance(60) ? "www." : random.chance(50) ? word(random) + "." : "";
+   h += word(random) + std::to_string(random.below(500)) + "." + tlds[random.below(sizeof(tlds) / sizeof(*tlds))];
+   return h;
+}
+
+static std::string path(Random& random, std::size_t min_segments = 0) {
+   std::string p;
+   std::size_t segments = random.between(min_segments, 6);
+   for (std::size_t i = 0; i < segments; ++i) {
+      p += "/";
+      p += random.chance(25) ? std::to_string(random.next() % 1000000) : word(random);
+      if (random.chance(5)) p += "%20" + word(random);
+   }
+   return p.empty() ? "/" : p;
+}
+
+static std::string query(Random& random, std::size_t parameters) {
+   std::string q;
+   for (std::size_t i = 0; i < parameters; ++i) {
+      q += i ? "&" : "?";
+      q += keys[random.below(sizeof(keys) / sizeof(*keys))];
+      q += "=";
+      q += random.chance(50) ? word(random) : std::to_string(random.next() % 100000);
+   }
+   return q;
+}
+
+static std::string tail(Random& random) {
+   std::string t = random.chance(40) ? query(random, random.between(1, 5)) : "";
+   if (random.chance(10)) t += "#" + word(random);
+   return t;
+}
+
+// Kinds weighted after web traffic: mostly plain absolute and relative hrefs, with a tail of the costlier shapes
+static Href generate(Random& random) {
+   static const Kind weights[] = {Kind::absolute, Kind::absolute, Kind::absolute, Kind::absolute, Kind::absolute,
+                                  Kind::absolute, Kind::absolute, Kind::absolute, Kind::absolute, Kind::relative,
+                                  Kind::relative, Kind::relative, Kind::relative, Kind::relative, Kind::userinfo,
+                                  Kind::ipv4, Kind::ipv6, Kind::long_query, Kind::opaque, Kind::absolute};
+   Kind kind = weights[random.below(sizeof(weights) / sizeof(*weights))];
+   std::string scheme = random.chance(70) ? "https" : "http";
+   std::string port = random.chance(10) ? ":" + std::to_string(random.between(1024, 65535)) : "";
+
+   std::string text;
+   switch (kind) {
+      case Kind::absolute:
+         text = scheme + "://" + host(random) + port + path(random) + tail(random);
+         break;
+      case Kind::relative:
+         text = path(random, 1) + tail(random);
+         break;
+      case Kind::userinfo:
+         text = scheme + "://" + word(random) + (random.chance(50) ? ":" + word(random) : "") + "@" + host(random) + port + path(random);
+         break;
+      case Kind::ipv4:
+         text = scheme + "://" + std::to_string(random.below(256)) + "." + std::to_string(random.below(256)) + "." +
+                std::to_string(random.below(256)) + "." + std::to_string(random.below(256)) + port + path(random) + tail(random);
+         break;
+      case Kind::ipv6: {
+         std::ostringstream address;
+         address << std::hex << "2001:db8:" << random.below(0x10000) << "::" << random.below(0x10000);
+         text = scheme + "://[" + address.str() + "]" + port + path(random) + tail(random);
+         break;
+      }
+      case Kind::long_query:
+         text = scheme + "://" + host(random) + path(random) + query(random, random.between(20, 120));
+         break;
+      default:
+         kind = Kind::opaque;
+         text = random.chance(50) ? "mailto:" + word(random) + "@" + host(random) : "urn:isbn:" + std::to_string(random.next() % 10000000000ull);
+         break;
+   }
+   return Href{text, kind};
+}
+
+struct Result {
+   std::string name;
+   std::size_t count;
+   double ns_per_uri;
+   double mb_per_second;
+   double allocations_per_uri;
+   std::size_t peak_rss_kib;
+};
+
+static volatile std::size_t sink;
+
+// Runs a pass `rounds` times and keeps the fastest; allocations are counted over the first pass
+static Result measure(const std::string& name, std::size_t count, std::size_t bytes, unsigned rounds, const std::function<std::size_t()>& pass) {
+   double best = 1e300;
+   std::uint64_t pass_allocations = 0;
+   for (unsigned round = 0; round < rounds; ++round) {
+      std::uint64_t before = allocations.load(std::memory_order_relaxed);
+      auto start = std::chrono::steady_clock::now();
+      sink = sink + pass();
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      if (round == 0) pass_allocations = allocations.load(std::memory_order_relaxed) - before;
+      best = std::min(best, elapsed.count());
+   }
+
+   Result result;
+   result.name = name;
+   result.count = count;
+   result.ns_per_uri = count ? best * 1e9 / count : 0;
+   result.mb_per_second = best > 0 ? bytes / best / 1e6 : 0;
+   result.allocations_per_uri = count ? static_cast<double>(pass_allocations) / count : 0;
+   result.peak_rss_kib = peak_rss_kib();
+   return result;
+}
+
+static void print(const Result& result) {
+   std::cout << std::left << std::setw(30) << result.name << std::right << std::setw(9) << result.count << std::fixed
+             << std::setprecision(1) << std::setw(11) << result.ns_per_uri << std::setw(10) << result.mb_per_second
+             << std::setprecision(2) << std::setw(11) << result.allocations_per_uri << std::setw(12) << result.peak_rss_kib
+             << std::endl;
+}
+
+static std::size_t total_size(const std::vector<std::string>& hrefs) {
+   std::size_t size = 0;
+   for (const std::string& href : hrefs) size += href.size();
+   return size;
+}
+
+// Turns an absolute href into builder components, so make() rebuilds an equivalent href
+static bool to_config(const uripp::UriView& uri, uripp::UriBuilderConfig& config) {
+   if (uri.isRelativeUri() || !uri.hasAuthority() || uri.hasUsername()) return false;
+   config = uripp::UriBuilderConfig();
+   config.scheme = uri.getScheme().str();
+   config.host = uri.getHost().str();
+   config.port = uri.getPort().str();
+   config.path = uri.getPath().str();
+   config.query = uri.getQuery().str();
+   config.fragment = uri.getFragment().str();
+   return true;
+}
+
+class NullBuffer : public std::streambuf {
+   protected:
+   int overflow(int c) override {
+      return c;
+   }
+};
+
+int main(int argc, char** argv) {
+   std::size_t count = 100000;
+   std::uint64_t seed = 1;
+   unsigned rounds = 5;
+   std::string corpus_path;
+   std::string filter;
+   bool dump = false;
+
+   for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool has_value = i + 1 < argc;
+      if (arg == "--count" && has_value) count = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+      else if (arg == "--seed" && has_value) seed = std::strtoull(argv[++i], nullptr, 10);
+      else if (arg == "--rounds" && has_value) rounds = std::max(1u, static_cast<unsigned>(std::atoi(argv[++i])));
+      else if (arg == "--corpus" && has_value) corpus_path = argv[++i];
+      else if (arg == "--filter" && has_value) filter = argv[++i];
+      else if (arg == "--dump") dump = true;
+      else {
+         std::cerr << "usage: bench [--count N] [--seed S] [--rounds R] [--corpus FILE] [--filter TEXT] [--dump]" << std::endl;
+         return 2;
+      }
+   }
+
+   std::vector<std::string> all;
+   std::vector<std::string> by_kind[static_cast<int>(Kind::count)];
+   if (!corpus_path.empty()) {
+      std::ifstream in(corpus_path, std::ios::binary);
+      if (!in) {
+         std::cerr << "Cannot open " << corpus_path << std::endl;
+         return 1;
+      }
+      std::string line;
+      while (std::getline(in, line)) {
+         if (!line.empty() && line[line.size() - 1] == '\r') line.pop_back();
+         if (!line.empty()) all.push_back(line);
+      }
+   } else {
+      Random random(seed);
+      for (std::size_t i = 0; i < count; ++i) {
+         Href href = generate(random);
+         by_kind[static_cast<int>(href.kind)].push_back(href.text);
+         all.push_back(href.text);
+      }
+   }
+
+   if (dump) {
+      for (const std::string& href : all) std::cout << href << "\n";
+      return 0;
+   }
+
+   // Only hrefs every parser accepts are timed, so each benchmark does the same work
+   std::vector<std::string> hrefs;
+   for (const std::string& href : all) {
+      if (uripp::try_parse_view(href)) hrefs.push_back(href);
+   }
+   std::vector<uripp::StringView> views(hrefs.begin(), hrefs.end());
+   std::size_t bytes = total_size(hrefs);
+
+   std::cout << "corpus: " << (corpus_path.empty() ? "synthetic, seed " + std::to_string(seed) : corpus_path) << ", "
+             << hrefs.size() << " valid of " << all.size() << " hrefs, " << bytes << " bytes, average "
+             << (hrefs.empty() ? 0 : bytes / hrefs.size()) << " bytes" << std::endl;
+   std::cout << std::left << std::setw(30) << "benchmark" << std::right << std::setw(9) << "uris" << std::setw(11) << "ns/uri"
+             << std::setw(10) << "MB/s" << std::setw(11) << "allocs/uri" << std::setw(12) << "peak KiB" << std::endl;
+
+   auto run = [&](const std::string& name, const std::vector<std::string>& set, const std::function<std::size_t()>& pass) {
+      if (!filter.empty() && name.find(filter) == std::string::npos) return;
+      print(measure(name, set.size(), total_size(set), rounds, pass));
+   };
+
+   auto construct = [](const std::vector<std::string>& set) {
+      return [&set]() {
+         std::size_t n = 0;
+         for (const std::string& href : set) n += uripp::Uri(href).getPath().size();
+         return n;
+      };
+   };
+
+   run("Uri(string)", hrefs, construct(hrefs));
+   for (int kind = 0; kind < static_cast<int>(Kind::count); ++kind) {
+      std::vector<std::string>& set = by_kind[kind];
+      set.erase(std::remove_if(set.begin(), set.end(), [](const std::string& href) { return !uripp::try_parse_view(href); }), set.end());
+      if (!set.empty()) run(std::string("Uri(string) ") + kind_names[kind], set, construct(set));
+   }
+
+   run("Uri(string, lazy)", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href, uripp::parse_mode::lazy).getPath().size();
+      return n;
+   });
+
+   // Reading only the path or the query through the getters of Uri: lazy mode never splits the authority, so it saves
+   // the userinfo, host and port scans. view() would split it, as a UriView holds every component.
+   run("parse + getPath, eager", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href).getPath().size();
+      return n;
+   });
+
+   run("parse + getPath, lazy", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href, uripp::parse_mode::lazy).getPath().size();
+      return n;
+   });
+
+   run("parse + getQuery, eager", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href).getQuery().size();
+      return n;
+   });
+
+   run("parse + getQuery, lazy", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href, uripp::parse_mode::lazy).getQuery().size();
+      return n;
+   });
+
+   // Reading only the host: lazy mode still has to split and validate the authority, so it is no cheaper here
+   run("parse + getHost, eager", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href).view().getHost().size();
+      return n;
+   });
+
+   run("parse + getHost, lazy", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href, uripp::parse_mode::lazy).view().getHost().size();
+      return n;
+   });
+
+   run("Uri(string, UriArena)", hrefs, [&]() {
+      uripp::UriArena arena;
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::Uri(href, arena).getPath().size();
+      return n;
+   });
+
+   run("try_parse", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const std::string& href : hrefs) n += uripp::try_parse(href).getUri().getPath().size();
+      return n;
+   });
+
+   run("try_parse_view", hrefs, [&]() {
+      std::size_t n = 0;
+      for (uripp::StringView href : views) n += uripp::try_parse_view(href).getUri().getPath().size();
+      return n;
+   });
+
+   // The policy scans against the generic one over the hrefs each of them accepts
+   auto parse_views = [](const std::vector<uripp::StringView>& set, uripp::ParseResult<uripp::UriView> (*parse)(uripp::StringView)) {
+      return [&set, parse]() {
+         std::size_t n = 0;
+         for (uripp::StringView href : set) n += parse(href).getUri().getPath().size();
+         return n;
+      };
+   };
+   std::vector<std::string> web_hrefs, opaque_hrefs;
+   for (const std::string& href : hrefs) {
+      if (uripp::try_parse_view<uripp::StrictWebPolicy>(href)) web_hrefs.push_back(href);
+      else if (uripp::try_parse_view<uripp::OpaquePolicy>(href) && !uripp::try_parse_view(href).getUri().hasAuthority()) opaque_hrefs.push_back(href);
+   }
+   std::vector<uripp::StringView> web_views(web_hrefs.begin(), web_hrefs.end()), opaque_views(opaque_hrefs.begin(), opaque_hrefs.end());
+   run("policy: generic, web", web_hrefs, parse_views(web_views, uripp::try_parse_view));
+   run("policy: WebPolicy", web_hrefs, parse_views(web_views, uripp::try_parse_view<uripp::WebPolicy>));
+   run("policy: StrictWebPolicy", web_hrefs, parse_views(web_views, uripp::try_parse_view<uripp::StrictWebPolicy>));
+   run("policy: generic, opaque", opaque_hrefs, parse_views(opaque_views, uripp::try_parse_view));
+   run("policy: OpaquePolicy", opaque_hrefs, parse_views(opaque_views, uripp::try_parse_view<uripp::OpaquePolicy>));
+
+   run("StaticUri(data, size)", hrefs, [&]() {
+      std::size_t n = 0;
+      for (uripp::StringView href : views) n += uripp::StaticUri(href.data(), href.size()).getPath().size();
+      return n;
+   });
+
+   run("UriStreamParser 32B reads", hrefs, [&]() {
+      uripp::UriStreamParser parser;
+      std::size_t n = 0;
+      for (uripp::StringView href : views) {
+         for (std::size_t at = 0; at < href.size(); at += 32) parser.feed(href.substr(at, 32));
+         parser.finish();
+         n += parser.view().getPath().size();
+         parser.reset();
+      }
+      return n;
+   });
+
+   run("UriStore::tryAdd", hrefs, [&]() {
+      uripp::UriStore store;
+      std::size_t n = 0;
+      for (uripp::StringView href : views) n += store.tryAdd(href).ok();
+      return n;
+   });
+
+   // Thread scaling over 1, 2, 4 and 8 threads, and the hardware concurrency when it is none of those
+   uripp::WorkerPool pool;
+   std::vector<unsigned> thread_counts = {1, 2, 4, 8};
+   if (std::find(thread_counts.begin(), thread_counts.end(), pool.size()) == thread_counts.end()) thread_counts.push_back(pool.size());
+   for (unsigned threads : thread_counts) {
+      std::string name = "parse_batch " + std::to_string(threads) + " threads";
+      if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+      uripp::WorkerPool scaling(threads);
+      run(name, hrefs, [&]() {
+         return uripp::parse_batch(views.data(), views.size(), scaling).size();
+      });
+   }
+
+   run("UriIndex build " + std::to_string(pool.size()) + " threads", hrefs, [&]() {
+      return uripp::UriIndex(views.data(), views.size(), pool).size();
+   });
+
+   uripp::UriIndex index(views.data(), views.size(), pool);
+   uripp::UriIndexStats index_stats = index.getStats();
+   if (filter.empty() || std::string("UriIndex").find(filter) != std::string::npos) {
+      std::cout << "UriIndex: " << index_stats.uris << " distinct uris in " << index_stats.blocks << " blocks, "
+                << std::fixed << std::setprecision(1)
+                << static_cast<double>(index_stats.encoded_bytes + index_stats.directory_bytes) / std::max<std::size_t>(1, index_stats.uris)
+                << " bytes/uri against " << static_cast<double>(index_stats.href_bytes) / std::max<std::size_t>(1, index_stats.uris)
+                << " bytes/uri of hrefs" << std::endl;
+      std::cout.unsetf(std::ios::floatfield);
+   }
+
+   run("UriIndex::contains", hrefs, [&]() {
+      std::size_t n = 0;
+      for (uripp::StringView href : views) n += index.contains(href);
+      return n;
+   });
+
+   // One prefix query per absolute href with a host: its "scheme://authority/" and first path segment
+   std::vector<std::string> prefixes;
+   for (const std::string& href : hrefs) {
+      uripp::UriView uri = uripp::try_parse_view(href).getUri();
+      if (uri.isRelativeUri() || !uri.hasAuthority()) continue;
+      uripp::StringView path = uri.getPath();
+      std::size_t segment = 1;
+      while (segment < path.size() && path[segment] != '/') ++segment;
+      prefixes.push_back(href.substr(0, static_cast<std::size_t>(path.data() - href.data()) + std::min(path.size(), segment + 1)));
+   }
+   run("UriIndex::findPrefix", prefixes, [&]() {
+      std::size_t n = 0;
+      for (const std::string& prefix : prefixes) n += index.findPrefix(prefix, [](const uripp::UriView&) {});
+      return n;
+   });
+
+   std::vector<uripp::Uri> parsed(hrefs.begin(), hrefs.end());
+   // Every href of the corpus as a link on one page, absolute ones included, as a crawler resolves them
+   uripp::UriResolver resolver(uripp::Uri("https://www.example.com/docs/guide/page.html?lang=en"));
+   std::vector<char> resolved(4096);
+   run("UriResolver::resolveInto", hrefs, [&]() {
+      std::size_t n = 0;
+      for (uripp::StringView href : views) {
+         std::size_t bound = resolver.maxResolvedSize(href);
+         if (bound > resolved.size()) resolved.resize(bound);
+         n += resolver.resolveInto(href, resolved.data());
+      }
+      return n;
+   });
+
+   uripp::ResolvedBatch resolved_batch;
+   run("UriResolver::resolveBatch", hrefs, [&]() {
+      resolved_batch.clear();
+      resolver.resolveBatch(views, resolved_batch);
+      return resolved_batch.size();
+   });
+
+   run("UriResolver::resolve", hrefs, [&]() {
+      std::size_t n = 0;
+      for (uripp::StringView href : views) n += resolver.resolve(href).getPath().size();
+      return n;
+   });
+
+   // std::vector<Uri> growth without reserve() moves every Uri on each reallocation, as its move constructor is noexcept
+   struct CopiedUri {
+      uripp::Uri uri;
+      explicit CopiedUri(const std::string& href) : uri(href) {}
+      CopiedUri(const CopiedUri& other) : uri(other.uri) {}
+   };
+
+   run("vector<Uri> growth", hrefs, [&]() {
+      std::vector<uripp::Uri> uris;
+      for (const std::string& href : hrefs) uris.emplace_back(href);
+      return uris.size();
+   });
+
+   run("vector<Uri> growth, copying", hrefs, [&]() {
+      std::vector<CopiedUri> uris;
+      for (const std::string& href : hrefs) uris.emplace_back(href);
+      return uris.size();
+   });
+
+   run("vector<Uri> reserved", hrefs, [&]() {
+      std::vector<uripp::Uri> uris;
+      uris.reserve(hrefs.size());
+      for (const std::string& href : hrefs) uris.emplace_back(href);
+      return uris.size();
+   });
+
+   // Routers of 10, 1k and 100k templates of two to four segments, probed with paths spread over every route
+   for (std::size_t routes : {std::size_t(10), std::size_t(1000), std::size_t(100000)}) {
+      std::string name = "Router::match " + std::to_string(routes) + " routes";
+      if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+
+      uripp::Router router;
+      for (std::size_t r = 0; r < routes; ++r) {
+         std::string n = std::to_string(r);
+         switch (r % 3) {
+            case 0: router.add("/api/v" + n + "/users/{id}"); break;
+            case 1: router.add("/static/b" + n + "/{path*}"); break;
+            default: router.add("/t" + n + "/{x}/c"); break;
+         }
+      }
+
+      Random random(seed);
+      std::vector<std::string> probes;
+      for (std::size_t i = 0; i < 20000; ++i) {
+         std::size_t r = random.below(routes);
+         std::string n = std::to_string(r), id = std::to_string(random.below(100000));
+         switch (r % 3) {
+            case 0: probes.push_back("/api/v" + n + "/users/" + id); break;
+            case 1: probes.push_back("/static/b" + n + "/css/" + id + ".css"); break;
+            default: probes.push_back("/t" + n + "/" + id + "/c"); break;
+         }
+      }
+
+      run(name, probes, [&]() {
+         uripp::RouteMatch match;
+         std::size_t n = 0;
+         for (const std::string& probe : probes) n += router.match(uripp::StringView(probe), match) ? match.getRoute() : 0;
+         return n;
+      });
+   }
+
+   // A block list of 1M domains, probed with hosts of which half are subdomains of a rule
+   if (filter.empty() || std::string("HostMatcher").find(filter) != std::string::npos) {
+      Random random(seed);
+      std::vector<std::string> rules, probes;
+      for (std::size_t i = 0; i < 1000000; ++i) {
+         rules.push_back(word(random) + std::to_string(i) + "." + tlds[random.below(sizeof(tlds) / sizeof(*tlds))]);
+      }
+      for (std::size_t i = 0; i < 1000000; ++i) {
+         probes.push_back(random.chance(50) ? word(random) + "." + rules[random.below(rules.size())] : host(random));
+      }
+      std::vector<uripp::StringView> probe_views(probes.begin(), probes.end());
+
+      run("HostMatcher build 1M rules", rules, [&]() {
+         uripp::HostMatcher matcher;
+         for (const std::string& rule : rules) matcher.add(rule);
+         return matcher.size();
+      });
+
+      uripp::HostMatcher matcher;
+      for (const std::string& rule : rules) matcher.add(rule);
+      std::cout << "HostMatcher: " << matcher.size() << " rules in " << std::fixed << std::setprecision(1)
+                << matcher.getMemoryUsage() / 1048576.0 << " MiB, "
+                << static_cast<double>(matcher.getMemoryUsage()) / matcher.size() << " bytes/rule" << std::endl;
+
+      run("HostMatcher::match 1M rules", probes, [&]() {
+         std::size_t n = 0;
+         for (uripp::StringView probe : probe_views) n += matcher.match(probe) != uripp::HostMatcher::no_match;
+         return n;
+      });
+
+      std::vector<std::uint32_t> matched(probes.size());
+      run("HostMatcher::matchBatch 1M rules", probes, [&]() {
+         matcher.matchBatch(probe_views.data(), probe_views.size(), matched.data());
+         return matched.size();
+      });
+   }
+
+   run("Uri getters", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const uripp::Uri& uri : parsed) {
+         n += uri.getHref().size() + uri.getPath().size() + uri.getQuery().size() + uri.getFragment().size() +
+              uri.getPathSegments().size();
+         if (uri.isRelativeUri()) continue;
+         n += uri.getScheme().size() + uri.getURIComponents().size();
+         if (!uri.hasAuthority()) continue;
+         n += uri.getAuthority().size() + uri.getUsername().size() + uri.getPassword().size() + uri.getHost().size() +
+              uri.getPort().size() + uri.getPortNumber() + static_cast<std::size_t>(uri.getHostType()) +
+              uri.getAuthorityComponents().size();
+      }
+      return n;
+   });
+
+   std::vector<uripp::UriView> parsed_views;
+   for (uripp::StringView href : views) parsed_views.push_back(uripp::try_parse_view(href).getUri());
+   run("UriView getters", hrefs, [&]() {
+      std::size_t n = 0;
+      for (const uripp::UriView& uri : parsed_views) {
+         n += uri.getHref().size() + uri.getScheme().size() + uri.getAuthority().size() + uri.getPath().size() +
+              uri.getQuery().size() + uri.getFragment().size() + uri.getUsername().size() + uri.getPassword().size() +
+              uri.getHost().size() + uri.getPort().size() + uri.getPortNumber() + static_cast<std::size_t>(uri.getHostType()) +
+              uri.getPathSegments().size();
+      }
+      return n;
+   });
+
+   std::vector<uripp::UriBuilderConfig> configs;
+   std::vector<std::string> built;
+   for (const uripp::UriView& uri : parsed_views) {
+      uripp::UriBuilderConfig config;
+      if (to_config(uri, config)) {
+         configs.push_back(config);
+         built.push_back(uri.getHref().str());
+      }
+   }
+
+   run("UriBuilder::make", built, [&]() {
+      std::size_t n = 0;
+      for (const uripp::UriBuilderConfig& config : configs) n += uripp::UriBuilder::make(config).getPath().size();
+      return n;
+   });
+
+   run("UriBuilder::buildInto", built, [&]() {
+      std::vector<char> buffer;
+      std::size_t n = 0;
+      for (const uripp::UriBuilderConfig& config : configs) {
+         buffer.resize(std::max(buffer.size(), uripp::UriBuilder::builtSize(config)));
+         n += uripp::UriBuilder::buildInto(config, buffer.data()).getUri().getPath().size();
+      }
+      return n;
+   });
+
+   // build() logs every href it builds to std::cout, which is muted while it runs
+   run("UriBuilder::build", built, [&]() {
+      NullBuffer null;
+      std::streambuf* saved = std::cout.rdbuf(&null);
+      std::size_t n = 0;
+      for (const uripp::UriBuilderConfig& config : configs) {
+         uripp::Uri* uri = uripp::UriBuilder::build(config);
+         n += uri->getHref().size();
+         delete uri;
+      }
+      std::cout.rdbuf(saved);
+      return n;
+   });
+
+   // A reverse proxy rewrite: point at a backend host and port, prefix the path and drop a tracking parameter
+   std::vector<uripp::Uri> originals;
+   for (const std::string& href : built) originals.push_back(uripp::Uri(href));
+
+   auto rewrite_config = [](const uripp::Uri& uri) {
+      uripp::UriBuilderConfig config;
+      config.scheme = uri.getScheme();
+      config.host = "backend.internal";
+      config.port = "8080";
+      config.path = "/api" + uri.getPath();
+      for (const uripp::QueryParameter& parameter : uripp::QueryView(uri.view())) {
+         if (parameter.getKey() == "utm_source") continue;
+         if (!config.query.empty()) config.query += '&';
+         config.query.append(parameter.getKey().data(), parameter.getKey().size());
+         if (parameter.hasValue()) config.query.append(1, '=').append(parameter.getValue().data(), parameter.getValue().size());
+      }
+      config.fragment = uri.getFragment();
+      return config;
+   };
+
+   run("rewrite: UriBuilder::build", built, [&]() {
+      NullBuffer null;
+      std::streambuf* saved = std::cout.rdbuf(&null);
+      std::size_t n = 0;
+      for (const uripp::Uri& original : originals) {
+         uripp::Uri* uri = uripp::UriBuilder::build(rewrite_config(original));
+         n += uri->getHref().size();
+         delete uri;
+      }
+      std::cout.rdbuf(saved);
+      return n;
+   });
+
+   run("rewrite: UriBuilder::make", built, [&]() {
+      std::size_t n = 0;
+      for (const uripp::Uri& original : originals) n += uripp::UriBuilder::make(rewrite_config(original)).getHref().size();
+      return n;
+   });
+
+   // Includes copying the original, so the setters rewrite the same hrefs every pass
+   run("rewrite: Uri setters", built, [&]() {
+      std::size_t n = 0;
+      std::string path;
+      for (const uripp::Uri& original : originals) {
+         uripp::Uri uri(original);
+         uripp::StringView old_path = uri.view().getPath();
+         path.assign("/api").append(old_path.data(), old_path.size());
+         uri.setHost("backend.internal").setPort(8080).setPath(path).removeQueryParam("utm_source");
+         n += uri.view().getHref().size();
+      }
+      return n;
+   });
+
+   return 0;
+}
@@ -1,479 +1,3529 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <new>
 #include <ostream>
-#include <regex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(URIPP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define URIPP_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define URIPP_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define URIPP_THROW(exception) throw exception
+#else
+#define URIPP_THROW(exception) std::abort()
+#endif
+
+// The scanner is constexpr where the language allows loops in constant expressions, and StringView comparisons
+// where std::char_traits allows them
+#if __cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define URIPP_HAS_CONSTEXPR14 1
+#define URIPP_CONSTEXPR14 constexpr
+#else
+#define URIPP_CONSTEXPR14 inline
+#endif
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define URIPP_CONSTEXPR17 constexpr
+#else
+#define URIPP_CONSTEXPR17 inline
+#endif
+
+// Parse counters, see ParseStats; one parse in URIPP_STATS_SAMPLE_RATE, a power of two, is timed
+#ifdef URIPP_ENABLE_STATS
+#include <chrono>
+#include <mutex>
+#ifndef URIPP_STATS_SAMPLE_RATE
+#define URIPP_STATS_SAMPLE_RATE 64
+#endif
+#endif
 
 namespace uripp {
     /**
-     * @brief A class representing an absolute or relative Uri and its components
+     * @brief The reasons an href can be rejected by the parser
      * 
      */
-    class Uri {
-        public:
+    enum class parse_error {
+        none,
+        invalid_character,
+        invalid_authority,
+        invalid_host,
+        invalid_port,
+        too_long
+    };
+
+    /**
+     * @brief returns string representation of a parse error
+     * 
+     * @param error parse_error representation
+     * @return const char* one of "none", "invalid character", "invalid authority", "invalid host", "invalid port", "too long"
+     */
+    inline const char* ErrorToString(parse_error error) {
+        static const char* const strings[] = {"none", "invalid character", "invalid authority", "invalid host", "invalid port", "too long"};
+        return strings[int(error)];
+    }
+
+    /**
+     * @brief How much of an href is split into components when a Uri is constructed
+     * 
+     */
+    enum class parse_mode {
         /**
-        * @brief An enum for the different components in an absolute URI
-        * 
-        */
-        enum class absolute_uri_components {
-            scheme,
-            authority,
-            path,
-            query,
-            fragment
+         * @brief Split the authority into username, password, host and port while parsing
+         */
+        eager,
+
+        /**
+         * @brief Record only scheme, authority, path, query and fragment; split the authority on first access
+         * 
+         * An href whose authority is invalid is then accepted, and the first accessor that needs the authority
+         * split throws the std::invalid_argument the eager constructor would have thrown.
+         */
+        lazy
+    };
+
+    /**
+     * @brief An enum naming every component the parser records, for APIs that address components uniformly
+     * 
+     */
+    enum class uri_components {
+        scheme,
+        authority,
+        path,
+        query,
+        fragment,
+        username,
+        password,
+        host,
+        port
+    };
+
+    namespace detail {
+        /**
+         * @brief Indices of the component slots recorded by the scanner, in the order of uri_components
+         * 
+         */
+        enum part_index {
+            part_scheme,
+            part_authority,
+            part_path,
+            part_query,
+            part_fragment,
+            part_username,
+            part_password,
+            part_host,
+            part_port,
+            part_count
         };
 
         /**
-         * @brief returns string representation of the corresponding absolute URI component
+         * @brief Flags stored next to the per-component presence bits
          * 
-         * @param comp absolute_uri_components representation
-         * @return std::string one of "scheme", authority", "path", "query", "fragment"
          */
-        static std::string ComponentToString(absolute_uri_components comp){
-            std::string strings[] = {"scheme", "authority", "path", "query", "fragment"};
-            return strings[int(comp)];
+        enum part_flags : std::uint16_t {
+            flag_absolute = 1u << part_count,
+            flag_relative = 1u << (part_count + 1),
+            flag_ipv6_host = 1u << (part_count + 2),
+            flag_authority_pending = 1u << (part_count + 3),
+            flag_authority_busy = 1u << (part_count + 4)
+        };
+
+        /**
+         * @brief Offsets and lengths of every component of a parsed href, plus presence bits
+         * 
+         */
+        struct UriParts {
+            std::uint32_t offset[part_count];
+            std::uint32_t length[part_count];
+            std::uint16_t flags;
+
+            constexpr bool has(part_index part) const {
+                return (flags & (1u << part)) != 0;
+            }
+
+            URIPP_CONSTEXPR14 void set(part_index part, std::size_t begin, std::size_t end) {
+                offset[part] = static_cast<std::uint32_t>(begin);
+                length[part] = static_cast<std::uint32_t>(end - begin);
+                flags = static_cast<std::uint16_t>(flags | (1u << part));
+            }
+        };
+    }
+
+    /**
+     * @brief Parse counters summed over every thread, as returned by parse_stats()
+     * 
+     * The counters are only kept when the library is compiled with URIPP_ENABLE_STATS; otherwise the parser carries no
+     * instrumentation and every counter reads 0. Each thread counts into its own counters, without locks or atomic
+     * read-modify-write operations, and they are only summed when parse_stats() is called.
+     */
+    struct ParseStats {
+        /**
+         * @brief Number of length buckets: [0, 16) characters, then doubling up to [2048, 4096), then 4096 and over
+         */
+        static const std::size_t length_buckets = 10;
+
+        /**
+         * @brief Number of latency buckets: [0, 32) ns, then doubling up to [32768, 65536) ns, then 65536 ns and over
+         */
+        static const std::size_t latency_buckets = 12;
+
+        /**
+         * @brief Hrefs scanned, and their total length
+         */
+        std::uint64_t parses;
+        std::uint64_t bytes;
+
+        /**
+         * @brief Parsed hrefs by kind: absolute or relative, with an authority, with an IPv6 or IPvFuture host, and
+         * with the authority left to a lazy split
+         */
+        std::uint64_t absolute;
+        std::uint64_t relative;
+        std::uint64_t authority;
+        std::uint64_t ip_literal_host;
+        std::uint64_t lazy;
+
+        /**
+         * @brief Hrefs scanned by outcome, indexed by parse_error; parse_error::none counts the parsed ones
+         */
+        std::uint64_t outcomes[6];
+
+        /**
+         * @brief Hrefs scanned by length bucket
+         */
+        std::uint64_t length[length_buckets];
+
+        /**
+         * @brief Timed parses, one in URIPP_STATS_SAMPLE_RATE, and their latencies by bucket
+         */
+        std::uint64_t latency_samples;
+        std::uint64_t latency[latency_buckets];
+
+        /**
+         * @brief Allocations made through the allocator of Uri hrefs, and the bytes allocated
+         */
+        std::uint64_t allocations;
+        std::uint64_t allocated_bytes;
+
+        /**
+         * @brief Format the counters as text, one counter or histogram per line
+         * 
+         * @return std::string
+         */
+        std::string toString() const {
+            std::string text;
+            auto line = [&text](const std::string& name, std::uint64_t value) { text += name + " " + std::to_string(value) + "\n"; };
+
+            line("parses", parses);
+            line("bytes", bytes);
+            line("absolute", absolute);
+            line("relative", relative);
+            line("authority", authority);
+            line("ip_literal_host", ip_literal_host);
+            line("lazy", lazy);
+            for (std::size_t i = 0; i < 6; ++i) {
+                std::string reason = ErrorToString(parse_error(i));
+                for (char& c : reason) if (c == ' ') c = '_';
+                line("outcome[" + reason + "]", outcomes[i]);
+            }
+            for (std::size_t i = 0; i < length_buckets; ++i) line("length[<" + (i + 1 < length_buckets ? std::to_string(16u << i) : std::string("inf")) + "]", length[i]);
+            line("latency_samples", latency_samples);
+            for (std::size_t i = 0; i < latency_buckets; ++i) line("latency_ns[<" + (i + 1 < latency_buckets ? std::to_string(32u << i) : std::string("inf")) + "]", latency[i]);
+            line("allocations", allocations);
+            line("allocated_bytes", allocated_bytes);
+            return text;
         }
+    };
+
+    namespace detail {
+#ifdef URIPP_ENABLE_STATS
+        static_assert((URIPP_STATS_SAMPLE_RATE & (URIPP_STATS_SAMPLE_RATE - 1)) == 0, "URIPP_STATS_SAMPLE_RATE must be a power of two");
 
         /**
-        * @brief An enum for the different components in a relative URI
-        * 
-        */
-        enum class relative_uri_components {
-            path,
-            query,
-            fragment
+         * @brief Indices of the per-thread counters, in the order of the fields of ParseStats
+         * 
+         */
+        enum stat_index {
+            stat_parses,
+            stat_bytes,
+            stat_absolute,
+            stat_relative,
+            stat_authority,
+            stat_ip_literal_host,
+            stat_lazy,
+            stat_outcomes,
+            stat_length = stat_outcomes + 6,
+            stat_latency_samples = stat_length + ParseStats::length_buckets,
+            stat_latency,
+            stat_allocations = stat_latency + ParseStats::latency_buckets,
+            stat_allocated_bytes,
+            stat_count
         };
 
+        struct ThreadStats;
+
         /**
-         * @brief returns string representation of the corresponding relative URI component
+         * @brief The counters of every live thread, and the sums of the threads that have exited
          * 
-         * @param comp relative_uri_components representation
-         * @return std::string one of "path", "query", "fragment"
          */
-        static std::string ComponentToString(relative_uri_components comp){
-            std::string strings[] = {"path", "query", "fragment"};
-            return strings[int(comp)];
+        struct StatsRegistry {
+            std::mutex mutex;
+            std::vector<ThreadStats*> threads;
+            std::uint64_t retired[stat_count] = {};
+        };
+
+        inline StatsRegistry& stats_registry() {
+            static StatsRegistry registry;
+            return registry;
         }
 
         /**
-        * @brief An enum for the different components of the Authority URI component
-        * 
-        */
-        enum class authority_components {
-            username,
-            password,
-            host,
-            port
+         * @brief The counters of one thread; only that thread writes them, so a relaxed load and store make an increment
+         * 
+         */
+        struct ThreadStats {
+            ThreadStats() : tick(0) {
+                for (std::atomic<std::uint64_t>& counter : counters) counter.store(0, std::memory_order_relaxed);
+                StatsRegistry& registry = stats_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.threads.push_back(this);
+            }
+
+            ~ThreadStats() {
+                StatsRegistry& registry = stats_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                for (std::size_t i = 0; i < stat_count; ++i) registry.retired[i] += counters[i].load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < registry.threads.size(); ++i) {
+                    if (registry.threads[i] == this) {
+                        registry.threads[i] = registry.threads.back();
+                        registry.threads.pop_back();
+                        break;
+                    }
+                }
+            }
+
+            void add(std::size_t index, std::uint64_t value) {
+                counters[index].store(counters[index].load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+
+            std::atomic<std::uint64_t> counters[stat_count];
+            std::uint32_t tick;
         };
 
+        inline ThreadStats& thread_stats() {
+            static thread_local ThreadStats stats;
+            return stats;
+        }
+
         /**
-         * @brief returns string representation of the corresponding Authority component
+         * @brief Index of the doubling bucket of value, the first one ending at first_bound
          * 
-         * @param comp authority_components representation
-         * @return std::string one of "username", "password", "host", "port"
          */
-        static std::string ComponentToString(authority_components comp){
-            std::string strings[] = {"username", "password", "host", "port"};
-            return strings[int(comp)];
+        inline std::size_t log_bucket(std::uint64_t value, std::uint64_t first_bound, std::size_t buckets) {
+            std::size_t bucket = 0;
+            for (std::uint64_t bound = first_bound; bucket + 1 < buckets && value >= bound; bound <<= 1) ++bucket;
+            return bucket;
         }
 
         /**
-         * @brief Construct a new Uri object
+         * @brief Counts a scanned href by outcome, kind and length
+         * 
+         */
+        inline void count_parse(std::size_t n, const UriParts& parts, parse_error error) {
+            ThreadStats& stats = thread_stats();
+            stats.add(stat_parses, 1);
+            stats.add(stat_bytes, n);
+            stats.add(stat_outcomes + static_cast<std::size_t>(error), 1);
+            stats.add(stat_length + log_bucket(n, 16, ParseStats::length_buckets), 1);
+            if (error != parse_error::none) return;
+
+            stats.add((parts.flags & flag_absolute) ? stat_absolute : stat_relative, 1);
+            if (parts.has(part_authority)) stats.add(stat_authority, 1);
+            if (parts.flags & flag_ipv6_host) stats.add(stat_ip_literal_host, 1);
+            if (parts.flags & flag_authority_pending) stats.add(stat_lazy, 1);
+        }
+
+        inline void count_allocation(std::size_t bytes) {
+            ThreadStats& stats = thread_stats();
+            stats.add(stat_allocations, 1);
+            stats.add(stat_allocated_bytes, bytes);
+        }
+#endif
+    }
+
+    /**
+     * @brief Sum the parse counters of every thread
+     * 
+     * @return ParseStats the counters; all 0 unless the library is compiled with URIPP_ENABLE_STATS
+     */
+    inline ParseStats parse_stats() {
+        ParseStats stats = ParseStats();
+#ifdef URIPP_ENABLE_STATS
+        std::uint64_t sums[detail::stat_count];
+        {
+            detail::StatsRegistry& registry = detail::stats_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (std::size_t i = 0; i < detail::stat_count; ++i) sums[i] = registry.retired[i];
+            for (detail::ThreadStats* thread : registry.threads) {
+                for (std::size_t i = 0; i < detail::stat_count; ++i) sums[i] += thread->counters[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        stats.parses = sums[detail::stat_parses];
+        stats.bytes = sums[detail::stat_bytes];
+        stats.absolute = sums[detail::stat_absolute];
+        stats.relative = sums[detail::stat_relative];
+        stats.authority = sums[detail::stat_authority];
+        stats.ip_literal_host = sums[detail::stat_ip_literal_host];
+        stats.lazy = sums[detail::stat_lazy];
+        for (std::size_t i = 0; i < 6; ++i) stats.outcomes[i] = sums[detail::stat_outcomes + i];
+        for (std::size_t i = 0; i < ParseStats::length_buckets; ++i) stats.length[i] = sums[detail::stat_length + i];
+        stats.latency_samples = sums[detail::stat_latency_samples];
+        for (std::size_t i = 0; i < ParseStats::latency_buckets; ++i) stats.latency[i] = sums[detail::stat_latency + i];
+        stats.allocations = sums[detail::stat_allocations];
+        stats.allocated_bytes = sums[detail::stat_allocated_bytes];
+#endif
+        return stats;
+    }
+
+    /**
+     * @brief Set the parse counters of every thread back to 0
+     * 
+     * Counts made by other threads while the counters are reset may be lost.
+     */
+    inline void reset_parse_stats() {
+#ifdef URIPP_ENABLE_STATS
+        detail::StatsRegistry& registry = detail::stats_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (std::uint64_t& sum : registry.retired) sum = 0;
+        for (detail::ThreadStats* thread : registry.threads) {
+            for (std::atomic<std::uint64_t>& counter : thread->counters) counter.store(0, std::memory_order_relaxed);
+        }
+#endif
+    }
+
+    namespace detail {
+
+        constexpr bool is_alnum(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        }
+
+        constexpr bool is_digit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        constexpr char to_lower(char c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        URIPP_CONSTEXPR14 int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        }
+
+        /**
+         * @brief unreserved, '%', sub-delims and '@', i.e. a path segment character without ':'
+         */
+        constexpr bool is_segment_nc_char(char c) {
+            return is_alnum(c) || c == '-' || c == '.' || c == '_' || c == '~' || c == '%' ||
+                   c == '!' || c == '$' || c == '&' || c == '\'' || c == '(' || c == ')' ||
+                   c == '*' || c == '+' || c == ',' || c == ';' || c == '=' || c == '@';
+        }
+
+        constexpr bool is_pchar(char c) {
+            return c == ':' || is_segment_nc_char(c);
+        }
+
+        constexpr bool is_query_char(char c) {
+            return c == '/' || c == '?' || is_pchar(c);
+        }
+
+        /**
+         * @brief A set of bytes a scan stops at: up to four delimiters, optionally joined by every byte that is not a query character
+         * 
+         * Unused delimiter slots repeat one of the used delimiters.
+         */
+        struct ByteClass {
+            char delimiters[4];
+            bool invalid;
+        };
+
+        constexpr bool in_class(char c, const ByteClass& cls) {
+            return c == cls.delimiters[0] || c == cls.delimiters[1] || c == cls.delimiters[2] || c == cls.delimiters[3] ||
+                   (cls.invalid && !is_query_char(c));
+        }
+
+        inline unsigned count_trailing_zeros(std::uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        /**
+         * @brief Byte-at-a-time fallback of find_first
+         * 
+         */
+        URIPP_CONSTEXPR14 const char* find_first_scalar(const char* p, const char* end, ByteClass cls) {
+            while (p < end && !in_class(*p, cls)) ++p;
+            return p;
+        }
+
+#ifdef URIPP_SIMD_SSE2
+        /**
+         * @brief Bitmap of the bytes in a 16-byte block that belong to cls, bit i standing for byte i
+         * 
+         * A byte is invalid if it is a control character, space, DEL or non-ASCII, or one of " # < > [ \ ] ^ ` { | }.
+         */
+        inline std::uint32_t match_mask_sse2(const char* p, const ByteClass& cls) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(cls.delimiters[0])), _mm_cmpeq_epi8(v, _mm_set1_epi8(cls.delimiters[1]))),
+                                        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(cls.delimiters[2])), _mm_cmpeq_epi8(v, _mm_set1_epi8(cls.delimiters[3]))));
+
+            if (cls.invalid) {
+                // signed compares: bytes >= 0x80 are negative and fall below 0x21
+                __m128i outside = _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(0x21)), _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+                __m128i quote_hash = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x21)), _mm_cmplt_epi8(v, _mm_set1_epi8(0x24)));
+                __m128i brackets = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x5A)), _mm_cmplt_epi8(v, _mm_set1_epi8(0x5F)));
+                __m128i braces = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x7A)), _mm_cmplt_epi8(v, _mm_set1_epi8(0x7E)));
+                __m128i singles = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('<')), _mm_cmpeq_epi8(v, _mm_set1_epi8('>'))),
+                                               _mm_cmpeq_epi8(v, _mm_set1_epi8('`')));
+                hits = _mm_or_si128(hits, _mm_or_si128(_mm_or_si128(outside, quote_hash), _mm_or_si128(_mm_or_si128(brackets, braces), singles)));
+            }
+
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(hits));
+        }
+
+        /**
+         * @brief SSE2 version of find_first, 16 bytes at a time; the range must be at least 16 bytes long
+         * 
+         */
+        inline const char* find_first_sse2(const char* p, const char* end, ByteClass cls) {
+            const char* block = p;
+            for (; end - block >= 16; block += 16) {
+                std::uint32_t mask = match_mask_sse2(block, cls);
+                if (mask) return block + count_trailing_zeros(mask);
+            }
+            if (block == end) return end;
+
+            // the last, partial block is rescanned as an overlapping full block
+            std::uint32_t mask = match_mask_sse2(end - 16, cls) >> (16 - (end - block));
+            return mask ? block + count_trailing_zeros(mask) : end;
+        }
+#endif
+
+#ifdef URIPP_SIMD_AVX2
+        __attribute__((target("avx2"))) inline std::uint32_t match_mask_avx2(const char* p, const ByteClass& cls) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(cls.delimiters[0])), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(cls.delimiters[1]))),
+                                           _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(cls.delimiters[2])), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(cls.delimiters[3]))));
+
+            if (cls.invalid) {
+                __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(0x21), v), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)));
+                __m256i quote_hash = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(0x21)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x24), v));
+                __m256i brackets = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(0x5A)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x5F), v));
+                __m256i braces = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(0x7A)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7E), v));
+                __m256i singles = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('<')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('>'))),
+                                                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('`')));
+                hits = _mm256_or_si256(hits, _mm256_or_si256(_mm256_or_si256(outside, quote_hash), _mm256_or_si256(_mm256_or_si256(brackets, braces), singles)));
+            }
+
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(hits));
+        }
+
+        /**
+         * @brief AVX2 version of find_first, 32 bytes at a time, finishing with SSE2; the range must be at least 16 bytes long
+         * 
+         */
+        __attribute__((target("avx2"))) inline const char* find_first_avx2(const char* p, const char* end, ByteClass cls) {
+            const char* block = p;
+            for (; end - block >= 32; block += 32) {
+                std::uint32_t mask = match_mask_avx2(block, cls);
+                if (mask) return block + count_trailing_zeros(mask);
+            }
+            if (block == end) return end;
+            if (end - p < 32) return find_first_sse2(block, end, cls);
+
+            std::uint32_t mask = match_mask_avx2(end - 32, cls) >> (32 - (end - block));
+            return mask ? block + count_trailing_zeros(mask) : end;
+        }
+#endif
+
+        typedef const char* (*find_first_function)(const char*, const char*, ByteClass);
+
+        /**
+         * @brief Picks the widest find_first kernel the CPU supports
          * 
-         * @param href URI string
-         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI
          */
-        Uri(std::string href) {
-            this->href = href;
+        inline find_first_function select_find_first() {
+#ifdef URIPP_SIMD_AVX2
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) return find_first_avx2;
+#endif
+#ifdef URIPP_SIMD_SSE2
+            return find_first_sse2;
+#else
+            return find_first_scalar;
+#endif
+        }
+
+        /**
+         * @brief Finds the first byte of [p, end) that belongs to cls
+         * 
+         * Ranges shorter than 16 bytes are scanned byte by byte and ranges shorter than 64 bytes go straight to SSE2;
+         * longer ones go through the widest kernel the CPU supports, chosen once by CPU detection.
+         * 
+         * @return const char* the first matching byte, or end
+         */
+        inline const char* find_first(const char* p, const char* end, ByteClass cls) {
+            if (end - p < 16) return find_first_scalar(p, end, cls);
+#ifdef URIPP_SIMD_SSE2
+            if (end - p < 64) return find_first_sse2(p, end, cls);
+#endif
+
+            static const find_first_function kernel = select_find_first();
+            return kernel(p, end, cls);
+        }
+
+        /**
+         * @brief Selects the scan_to() of the runtime parser: find_first(), with its SIMD kernels
+         * 
+         */
+        struct RuntimeScan {};
+
+        /**
+         * @brief Selects the scan_to() of the compile-time parser: byte at a time, usable in constant expressions from C++14 on
+         * 
+         */
+        struct ConstantScan {};
 
-            std::smatch uri_groups;
-            is_absolute_uri = std::regex_match(href, uri_groups, uri_regex);
-            std::string schemeMatch = uri_groups[2].str();
+        /**
+         * @brief find_first over s[i, n), returning an index
+         * 
+         */
+        template <class Scan = RuntimeScan>
+        inline std::size_t scan_to(const char* s, std::size_t i, std::size_t n, ByteClass cls) {
+            return static_cast<std::size_t>(find_first(s + i, s + n, cls) - s);
+        }
 
-            if(is_absolute_uri && !schemeMatch.empty()) {
-                uri_components_map[absolute_uri_components::scheme] = schemeMatch;
+        template <>
+        URIPP_CONSTEXPR14 std::size_t scan_to<ConstantScan>(const char* s, std::size_t i, std::size_t n, ByteClass cls) {
+            return static_cast<std::size_t>(find_first_scalar(s + i, s + n, cls) - s);
+        }
 
-                std::string authorityMatch = uri_groups[4].str();
-                if (!authorityMatch.empty()) {
-                    uri_components_map[absolute_uri_components::authority] = uri_groups[4].str();
-                    has_authority = true; 
+        /**
+         * @brief Decodes an RFC 3986 IPv4address: four dec-octets without leading zeros
+         * 
+         * @param out receives the four bytes in network order
+         * @return true if [p, end) is exactly one IPv4address
+         */
+        URIPP_CONSTEXPR14 bool decode_ipv4(const char* p, const char* end, std::uint8_t* out) {
+            unsigned octet = 0;
+            unsigned digits = 0;
+            unsigned dots = 0;
+            bool valid = end - p >= 7 && end - p <= 15;
+
+            for (; valid && p < end; ++p) {
+                unsigned d = static_cast<unsigned char>(*p) - '0';
+                if (d <= 9) {
+                    // A leading zero is only valid as the whole octet
+                    valid = !(digits == 1 && octet == 0);
+                    octet = octet * 10 + d;
+                    ++digits;
+                    valid = valid && octet <= 255;
+                } else {
+                    valid = *p == '.' && digits != 0 && dots < 3;
+                    out[dots & 3] = static_cast<std::uint8_t>(octet);
+                    dots += valid;
+                    octet = digits = 0;
                 }
+            }
+            out[3] = static_cast<std::uint8_t>(octet);
+            return valid && dots == 3 && digits != 0;
+        }
+
+        /**
+         * @brief Decodes an RFC 3986 IPv6address, with "::" compression and an optional trailing IPv4address
+         * 
+         * @param out receives the sixteen bytes in network order
+         * @return true if [p, end) is exactly one IPv6address
+         */
+        URIPP_CONSTEXPR14 bool decode_ipv6(const char* p, const char* end, std::uint8_t* out) {
+            unsigned groups[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+            int count = 0;
+            int gap = -1;
+
+            if (end - p >= 2 && p[0] == ':' && p[1] == ':') {
+                gap = 0;
+                p += 2;
+            }
 
-                std::string pathMatch = uri_groups[5].str();
-                if (!pathMatch.empty()) {
-                    uri_components_map[absolute_uri_components::path] = pathMatch;
+            while (p < end) {
+                const char* group_begin = p;
+                unsigned value = 0;
+                int digits = 0;
+                int v = 0;
+                while (p < end && digits < 5 && (v = hex_value(*p)) >= 0) {
+                    value = (value << 4) | static_cast<unsigned>(v);
+                    ++digits;
+                    ++p;
                 }
 
-                std::string queryMatch = uri_groups[7].str();
-                if (!queryMatch.empty()) {
-                    uri_components_map[absolute_uri_components::query] = queryMatch;
-                    has_query = true;
+                if (p < end && *p == '.') {
+                    std::uint8_t v4[4] = {};
+                    if (count > 6 || !decode_ipv4(group_begin, end, v4)) return false;
+                    groups[count++] = (unsigned(v4[0]) << 8) | v4[1];
+                    groups[count++] = (unsigned(v4[2]) << 8) | v4[3];
+                    p = end;
+                    break;
+                }
+                if (digits == 0 || digits > 4 || count == 8) return false;
+                groups[count++] = value;
+
+                if (p == end) break;
+                if (*p != ':' || ++p == end) return false;
+                if (*p == ':') {
+                    if (gap >= 0) return false;
+                    gap = count;
+                    ++p;
                 }
+            }
+
+            if (gap < 0 ? count != 8 : count > 7) return false;
+
+            int zeros = 8 - count;
+            for (int i = 0, g = 0; i < 8; ++i) {
+                unsigned value = 0;
+                if (gap < 0 || i < gap) value = groups[g++];
+                else if (i >= gap + zeros) value = groups[g++];
+                out[2 * i] = static_cast<std::uint8_t>(value >> 8);
+                out[2 * i + 1] = static_cast<std::uint8_t>(value);
+            }
+            return true;
+        }
+
+        constexpr bool is_unreserved(char c) {
+            return is_alnum(c) || c == '-' || c == '.' || c == '_' || c == '~';
+        }
+
+        constexpr bool is_sub_delim(char c) {
+            return c == '!' || c == '$' || c == '&' || c == '\'' || c == '(' || c == ')' ||
+                   c == '*' || c == '+' || c == ',' || c == ';' || c == '=';
+        }
 
-                std::string fragmentMatch = uri_groups[9].str();
-                if (!fragmentMatch.empty()) {
-                    uri_components_map[absolute_uri_components::fragment] = fragmentMatch;
-                    has_fragment = true;
+        /**
+         * @brief Finds the first character of [p, end) outside 1*( unreserved / pct-encoded / sub-delims [ / ':' ] )
+         * 
+         * @return const char* end if the whole range matches
+         */
+        URIPP_CONSTEXPR14 const char* find_invalid_host_char(const char* p, const char* end, bool sub_delims, bool colon) {
+            for (; p < end; ++p) {
+                char c = *p;
+                if (is_unreserved(c) || (sub_delims && is_sub_delim(c)) || (colon && c == ':')) continue;
+                if (c == '%' && end - p >= 3 && hex_value(p[1]) >= 0 && hex_value(p[2]) >= 0) {
+                    p += 2;
+                    continue;
                 }
+                return p;
+            }
+            return end;
+        }
 
-                if(has_authority) {
-                    std::smatch authority_groups;
-                    bool isValidAuthority =  std::regex_match(uri_components_map[absolute_uri_components::authority], authority_groups, authority_regex);
+        /**
+         * @brief Validates the inside of an IP-literal: an IPv6address with an optional RFC 6874 "%25" zone ID, or an IPvFuture
+         * 
+         * @return const char* end if valid, otherwise the position of the first rejected character
+         */
+        URIPP_CONSTEXPR14 const char* check_ip_literal(const char* p, const char* end) {
+            if (p < end && (*p == 'v' || *p == 'V')) {
+                // IPvFuture = "v" 1*HEXDIG "." 1*( unreserved / sub-delims / ":" )
+                const char* q = p + 1;
+                while (q < end && hex_value(*q) >= 0) ++q;
+                if (q == p + 1 || q == end || *q != '.' || q + 1 == end) return q;
+                const char* bad = find_invalid_host_char(q + 1, end, true, true);
+                return bad < end || find_first_scalar(q + 1, end, ByteClass{{'%', '%', '%', '%'}, false}) < end ? q + 1 : end;
+            }
+
+            const char* zone = find_first_scalar(p, end, ByteClass{{'%', '%', '%', '%'}, false});
+            std::uint8_t address[16] = {};
+            if (!decode_ipv6(p, zone, address)) return p;
+            if (zone == end) return end;
+
+            // ZoneID = 1*( unreserved / pct-encoded ), introduced by an escaped '%'
+            if (end - zone < 4 || zone[1] != '2' || zone[2] != '5') return zone;
+            return find_invalid_host_char(zone + 3, end, false, false);
+        }
+
+        /**
+         * @brief Matches "host [ ':' port ]" in s[begin, end)
+         * 
+         * The host is an IP-literal in brackets, validated as an IPv6address with an optional zone ID or as an IPvFuture,
+         * or a reg-name of unreserved, pct-encoded and sub-delims characters. The port is one or more digits up to 65535.
+         * 
+         * @return parse_error none, or the reason the range was rejected with its position in error_offset
+         */
+        URIPP_CONSTEXPR14 parse_error scan_host_port(const char* s, std::size_t begin, std::size_t end, UriParts& parts, std::size_t& error_offset) {
+            std::size_t i = begin;
+
+            if (i < end && s[i] == '[') {
+                ++i;
+                while (i < end && s[i] != ']') ++i;
+                if (i == end || i == begin + 1) {
+                    error_offset = i;
+                    return parse_error::invalid_host;
+                }
+                const char* bad = check_ip_literal(s + begin + 1, s + i);
+                if (bad != s + i) {
+                    error_offset = static_cast<std::size_t>(bad - s);
+                    return parse_error::invalid_host;
+                }
+                ++i;
+            } else {
+                while (i < end && s[i] != ':' && s[i] != '[' && s[i] != ']') ++i;
+                if (i == begin) {
+                    error_offset = i;
+                    return i < end && s[i] != ':' ? parse_error::invalid_authority : parse_error::invalid_host;
+                }
+                const char* bad = find_invalid_host_char(s + begin, s + i, true, false);
+                if (bad != s + i) {
+                    error_offset = static_cast<std::size_t>(bad - s);
+                    return parse_error::invalid_host;
+                }
+            }
+            std::size_t host_end = i;
+
+            if (i < end) {
+                if (s[i] != ':') {
+                    error_offset = i;
+                    return parse_error::invalid_authority;
+                }
+                if (i + 1 == end) {
+                    error_offset = end;
+                    return parse_error::invalid_port;
+                }
+                std::uint32_t port = 0;
+                for (std::size_t j = i + 1; j < end; ++j) {
+                    port = port * 10 + static_cast<std::uint32_t>(s[j] - '0');
+                    if (!is_digit(s[j]) || port > 65535) {
+                        error_offset = j;
+                        return parse_error::invalid_port;
+                    }
+                }
+                parts.set(part_port, i + 1, end);
+            }
+
+            parts.set(part_host, begin, host_end);
+            if (s[begin] == '[') parts.flags = static_cast<std::uint16_t>(parts.flags | flag_ipv6_host);
+            return parse_error::none;
+        }
+
+        /**
+         * @brief Splits the authority in s[begin, end) into username, password, host and port
+         * 
+         * A userinfo runs up to the '@', which neither it nor the host may contain, and is made of unreserved,
+         * pct-encoded, sub-delims and ':' characters. The username runs up to the last ':' of the userinfo and the
+         * password follows it; empty ones are treated as absent.
+         */
+        template <class Scan = RuntimeScan>
+        URIPP_CONSTEXPR14 parse_error scan_authority(const char* s, std::size_t begin, std::size_t end, UriParts& parts, std::size_t& error_offset) {
+            std::size_t at = scan_to<Scan>(s, begin, end, ByteClass{{'@', '@', '@', '@'}, false});
+            if (at == end) return scan_host_port(s, begin, end, parts, error_offset);
+
+            const char* bad = find_invalid_host_char(s + begin, s + at, true, true);
+            if (bad != s + at) {
+                error_offset = static_cast<std::size_t>(bad - s);
+                return parse_error::invalid_authority;
+            }
+
+            parse_error error = scan_host_port(s, at + 1, end, parts, error_offset);
+            if (error != parse_error::none) return error;
+
+            std::size_t colon = at;
+            while (colon > begin && s[colon - 1] != ':') --colon;
+            if (colon == begin) {
+                if (at > begin) parts.set(part_username, begin, at);
+            } else {
+                if (colon - 1 > begin) parts.set(part_username, begin, colon - 1);
+                if (at > colon) parts.set(part_password, colon, at);
+            }
+            return parse_error::none;
+        }
+
+        /**
+         * @brief Matches a relative reference: "[ path ] [ '?' query ] [ '#' fragment ]"
+         * 
+         * The query and fragment spans keep their leading delimiter.
+         * 
+         * @return parse_error none, or invalid_character with the position of the first rejected character in error_offset
+         */
+        template <class Scan = RuntimeScan>
+        URIPP_CONSTEXPR14 parse_error scan_relative(const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset) {
+            std::size_t i = 0;
+
+            if (n >= 2 && s[0] == '/' && (s[1] == '/' || is_pchar(s[1]))) {
+                i = scan_to<Scan>(s, 2, n, ByteClass{{'?', '?', '?', '?'}, true});
+            } else if (n >= 1 && is_segment_nc_char(s[0])) {
+                i = scan_to<Scan>(s, 1, n, ByteClass{{':', '/', '?', '?'}, true});
+                if (i < n && s[i] == '/') {
+                    i = scan_to<Scan>(s, i, n, ByteClass{{'?', '?', '?', '?'}, true});
+                }
+            }
+            if (i > 0) parts.set(part_path, 0, i);
+
+            if (i < n && s[i] == '?') {
+                std::size_t query_begin = i++;
+                i = scan_to<Scan>(s, i, n, ByteClass{{'#', '#', '#', '#'}, true});
+                parts.set(part_query, query_begin, i);
+            }
+
+            if (i < n && s[i] == '#') {
+                std::size_t fragment_begin = i++;
+                i = scan_to<Scan>(s, i, n, ByteClass{{'#', '#', '#', '#'}, true});
+                parts.set(part_fragment, fragment_begin, i);
+            }
+
+            parts.flags = static_cast<std::uint16_t>(parts.flags | flag_relative);
+
+            if (i != n) {
+                // a lone "/" is not matched by any path alternative, so report the character that made it lone
+                error_offset = (i == 0 && s[0] == '/') ? 1 : i;
+                return parse_error::invalid_character;
+            }
+            return parse_error::none;
+        }
+
+        /**
+         * @brief The single-pass scan of scan_uri(), without the parse counters
+         * 
+         * An href with a non-empty scheme is split as "scheme ':' [ '//' authority ] path [ '?' query ] [ '#' fragment ]"
+         * and its authority is broken down further; anything else must be a relative reference.
+         * Empty authority, query and fragment components are treated as absent.
+         * 
+         * @param s href characters
+         * @param n number of characters
+         * @param parts receives the component spans
+         * @param error_offset receives the position at which the href was rejected
+         * @param split whether to break the authority down now; if false, it is left to split_authority() and flagged as pending
+         * @return parse_error none, or the reason the href was rejected
+         */
+        template <class Scan>
+        URIPP_CONSTEXPR14 parse_error scan_href(const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset, bool split) {
+            parts = UriParts();
+            error_offset = 0;
+            if (n > UINT32_MAX) {
+                error_offset = UINT32_MAX;
+                return parse_error::too_long;
+            }
+
+            std::size_t i = scan_to<Scan>(s, 0, n, ByteClass{{':', '/', '?', '#'}, false});
+
+            if (i == 0 || i == n || s[i] != ':') {
+                return scan_relative<Scan>(s, n, parts, error_offset);
+            }
+
+            parts.set(part_scheme, 0, i);
+            ++i;
+
+            if (i + 1 < n && s[i] == '/' && s[i + 1] == '/') {
+                std::size_t authority_begin = i + 2;
+                i = scan_to<Scan>(s, authority_begin, n, ByteClass{{'/', '?', '#', '#'}, false});
+                if (i > authority_begin) parts.set(part_authority, authority_begin, i);
+            }
+
+            std::size_t path_begin = i;
+            i = scan_to<Scan>(s, i, n, ByteClass{{'?', '#', '#', '#'}, false});
+            parts.set(part_path, path_begin, i);
+
+            if (i < n && s[i] == '?') {
+                std::size_t query_begin = ++i;
+                i = scan_to<Scan>(s, i, n, ByteClass{{'#', '#', '#', '#'}, false});
+                if (i > query_begin) parts.set(part_query, query_begin, i);
+            }
+
+            if (i < n) {
+                std::size_t fragment_begin = ++i;
+                i = scan_to<Scan>(s, fragment_begin, n, ByteClass{{'\n', '\r', '\n', '\r'}, false});
+                if (i < n) {
+                    error_offset = i;
+                    return parse_error::invalid_character;
+                }
+                if (i > fragment_begin) parts.set(part_fragment, fragment_begin, i);
+            }
+
+            parts.flags = static_cast<std::uint16_t>(parts.flags | flag_absolute);
+
+            if (parts.has(part_authority)) {
+                if (!split) {
+                    parts.flags = static_cast<std::uint16_t>(parts.flags | flag_authority_pending);
+                    return parse_error::none;
+                }
+                std::size_t authority_begin = parts.offset[part_authority];
+                return scan_authority<Scan>(s, authority_begin, authority_begin + parts.length[part_authority], parts, error_offset);
+            }
+
+            return parse_error::none;
+        }
+
+#ifdef URIPP_ENABLE_STATS
+        /**
+         * @brief Runs scan_href() and counts the href, timing one scan in URIPP_STATS_SAMPLE_RATE
+         * 
+         */
+        inline parse_error counted_scan(const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset, bool split) {
+            ThreadStats& stats = thread_stats();
+            parse_error error;
+            if ((++stats.tick & (URIPP_STATS_SAMPLE_RATE - 1)) != 0) {
+                error = scan_href<RuntimeScan>(s, n, parts, error_offset, split);
+            } else {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                error = scan_href<RuntimeScan>(s, n, parts, error_offset, split);
+                std::chrono::nanoseconds elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                stats.add(stat_latency_samples, 1);
+                stats.add(stat_latency + log_bucket(static_cast<std::uint64_t>(elapsed.count()), 32, ParseStats::latency_buckets), 1);
+            }
+            count_parse(n, parts, error);
+            return error;
+        }
+#endif
+
+        /**
+         * @brief Scans an href in a single pass and records the span of every component
+         * 
+         * See scan_href(). With URIPP_ENABLE_STATS, runtime scans are also counted in the parse counters.
+         * 
+         * @param s href characters
+         * @param n number of characters
+         * @param parts receives the component spans
+         * @param error_offset receives the position at which the href was rejected
+         * @param split whether to break the authority down now; if false, it is left to split_authority() and flagged as pending
+         * @return parse_error none, or the reason the href was rejected
+         */
+        template <class Scan = RuntimeScan>
+        URIPP_CONSTEXPR14 parse_error scan_uri(const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset, bool split = true) {
+#ifdef URIPP_ENABLE_STATS
+            if (std::is_same<Scan, RuntimeScan>::value) return counted_scan(s, n, parts, error_offset, split);
+#endif
+            return scan_href<Scan>(s, n, parts, error_offset, split);
+        }
+
+        /**
+         * @brief Breaks down an authority left pending by scan_uri()
+         * 
+         * @param s href characters
+         * @param parts component spans of the href
+         * @param split receives the username, password, host and port spans and their presence bits, and nothing else
+         * @param error_offset receives the position at which the authority was rejected
+         * @return parse_error none, or the reason the authority was rejected
+         */
+        inline parse_error split_authority(const char* s, const UriParts& parts, UriParts& split, std::size_t& error_offset) {
+            split = UriParts();
+            std::size_t authority_begin = parts.offset[part_authority];
+            return scan_authority(s, authority_begin, authority_begin + parts.length[part_authority], split, error_offset);
+        }
+
+        /**
+         * @brief Maps a scan error to the exception thrown by the throwing constructors
+         * 
+         */
+        inline void throw_parse_error(parse_error error) {
+            if (error == parse_error::invalid_authority || error == parse_error::invalid_host || error == parse_error::invalid_port) {
+                URIPP_THROW(std::invalid_argument("The authority component of href is not valid"));
+            }
+            URIPP_THROW(std::invalid_argument("The provided href is not a valid absolute or relative URI"));
+        }
+    }
+
+    /**
+     * @brief A non-owning, read-only view over a contiguous range of characters
+     * 
+     */
+    class StringView {
+        public:
+        /**
+         * @brief Construct an empty StringView
+         * 
+         */
+        constexpr StringView() : ptr(nullptr), len(0) {}
+
+        /**
+         * @brief Construct a new StringView over a character range
+         * 
+         * @param data first character
+         * @param size number of characters
+         */
+        constexpr StringView(const char* data, std::size_t size) : ptr(data), len(size) {}
+
+        /**
+         * @brief Construct a new StringView over a null-terminated string
+         * 
+         * @param str null-terminated string
+         */
+        URIPP_CONSTEXPR17 StringView(const char* str) : ptr(str), len(str ? std::char_traits<char>::length(str) : 0) {}
+
+        /**
+         * @brief Construct a new StringView over the characters of a std::string
+         * 
+         * @param str viewed string; must outlive the view
+         */
+        StringView(const std::string& str) : ptr(str.data()), len(str.size()) {}
+
+        constexpr const char* data() const { return ptr; }
+        constexpr std::size_t size() const { return len; }
+        constexpr bool empty() const { return len == 0; }
+        constexpr const char* begin() const { return ptr; }
+        constexpr const char* end() const { return ptr + len; }
+        constexpr char operator[](std::size_t index) const { return ptr[index]; }
+
+        /**
+         * @brief Get a view over a sub-range of this view
+         * 
+         * @param pos first character, clamped to size()
+         * @param count maximum number of characters
+         * @return StringView the sub-range
+         */
+        URIPP_CONSTEXPR14 StringView substr(std::size_t pos, std::size_t count = std::string::npos) const {
+            if (pos > len) pos = len;
+            if (count > len - pos) count = len - pos;
+            return StringView(ptr + pos, count);
+        }
+
+        /**
+         * @brief Copy the viewed characters into a std::string
+         * 
+         * @return std::string owning copy
+         */
+        std::string str() const {
+            return len ? std::string(ptr, len) : std::string();
+        }
+
+        explicit operator std::string() const {
+            return str();
+        }
+
+        friend URIPP_CONSTEXPR17 bool operator==(StringView a, StringView b) {
+            return a.len == b.len && (a.len == 0 || std::char_traits<char>::compare(a.ptr, b.ptr, a.len) == 0);
+        }
+
+        friend URIPP_CONSTEXPR17 bool operator!=(StringView a, StringView b) {
+            return !(a == b);
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, StringView view) {
+            return os.write(view.ptr, static_cast<std::streamsize>(view.len));
+        }
+
+        private:
+        const char* ptr;
+        std::size_t len;
+    };
+
+    /**
+     * @brief A source of memory for the href of a Uri, after std::pmr::memory_resource
+     * 
+     * A Uri constructed with a resource allocates its href from it, and so does every Uri moved from it; a copy of it
+     * allocates from default_resource(), so a copy never outlives the memory it was made from. The resource must
+     * outlive every Uri using it.
+     */
+    class UriMemoryResource {
+        public:
+        virtual ~UriMemoryResource() {}
+
+        /**
+         * @brief Allocate memory
+         * 
+         * @param bytes number of bytes
+         * @param alignment alignment of the memory, at most alignof(std::max_align_t)
+         * @return void* the memory
+         */
+        virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+        /**
+         * @brief Give back memory obtained from allocate()
+         * 
+         * @param p the memory
+         * @param bytes number of bytes passed to allocate()
+         * @param alignment alignment passed to allocate()
+         */
+        virtual void deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
+    };
+
+    namespace detail {
+        class HeapResource : public UriMemoryResource {
+            public:
+            void* allocate(std::size_t bytes, std::size_t) override {
+                return ::operator new(bytes);
+            }
+
+            void deallocate(void* p, std::size_t, std::size_t) override {
+                ::operator delete(p);
+            }
+        };
+    }
+
+    /**
+     * @brief Get the resource a Uri allocates from when it is given none, backed by operator new and operator delete
+     * 
+     * @return UriMemoryResource*
+     */
+    inline UriMemoryResource* default_resource() {
+        static detail::HeapResource resource;
+        return &resource;
+    }
+
+    namespace detail {
+        /**
+         * @brief A standard allocator over a UriMemoryResource, after std::pmr::polymorphic_allocator
+         * 
+         */
+        template <class T>
+        class ResourceAllocator {
+            public:
+            typedef T value_type;
+
+            // A moved-to container takes the resource of the one it takes over, so a move assignment never copies
+            typedef std::true_type propagate_on_container_move_assignment;
+
+            ResourceAllocator() : resource(default_resource()) {}
+
+            ResourceAllocator(UriMemoryResource* resource) : resource(resource) {}
+
+            template <class U>
+            ResourceAllocator(const ResourceAllocator<U>& other) : resource(other.getResource()) {}
+
+            T* allocate(std::size_t n) {
+#ifdef URIPP_ENABLE_STATS
+                count_allocation(n * sizeof(T));
+#endif
+                return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T* p, std::size_t n) {
+                resource->deallocate(p, n * sizeof(T), alignof(T));
+            }
+
+            ResourceAllocator select_on_container_copy_construction() const {
+                return ResourceAllocator();
+            }
+
+            UriMemoryResource* getResource() const {
+                return resource;
+            }
+
+            private:
+            UriMemoryResource* resource;
+        };
+
+        template <class T, class U>
+        bool operator==(const ResourceAllocator<T>& a, const ResourceAllocator<U>& b) {
+            return a.getResource() == b.getResource();
+        }
+
+        template <class T, class U>
+        bool operator!=(const ResourceAllocator<T>& a, const ResourceAllocator<U>& b) {
+            return a.getResource() != b.getResource();
+        }
+
+        typedef std::basic_string<char, std::char_traits<char>, ResourceAllocator<char>> href_string;
+    }
+
+    /**
+     * @brief The kinds of host RFC 3986 distinguishes
+     * 
+     */
+    enum class host_type {
+        none,
+        reg_name,
+        ipv4,
+        ipv6,
+        ipv_future
+    };
+
+    /**
+     * @brief A host decoded to its binary address
+     * 
+     */
+    struct IpAddress {
+        /**
+         * @brief host_type::ipv4 or host_type::ipv6; host_type::none if the host is not an IP address
+         */
+        host_type type;
+
+        /**
+         * @brief The address in network byte order; an IPv4 address fills the first four bytes
+         */
+        std::uint8_t bytes[16];
+
+        /**
+         * @brief The zone ID of an IPv6 address as it appears in the href, still percent-encoded; empty if none
+         */
+        StringView zone;
+    };
+
+    namespace detail {
+        /**
+         * @brief Classifies a host the parser has already validated
+         * 
+         * @param host host component, brackets included
+         */
+        URIPP_CONSTEXPR14 host_type classify_host(StringView host) {
+            if (host.empty()) return host_type::none;
+            if (host[0] == '[') return host[1] == 'v' || host[1] == 'V' ? host_type::ipv_future : host_type::ipv6;
+
+            std::uint8_t address[4] = {};
+            return decode_ipv4(host.begin(), host.end(), address) ? host_type::ipv4 : host_type::reg_name;
+        }
+
+        /**
+         * @brief Decodes a host the parser has already validated
+         * 
+         * @param host host component, brackets included
+         */
+        inline IpAddress decode_host(StringView host) {
+            IpAddress address = IpAddress();
+            if (host.empty()) return address;
+
+            if (host[0] != '[') {
+                if (decode_ipv4(host.begin(), host.end(), address.bytes)) address.type = host_type::ipv4;
+                return address;
+            }
+            if (host[1] == 'v' || host[1] == 'V') return address;
+
+            const char* end = host.end() - 1;
+            const char* zone = static_cast<const char*>(std::memchr(host.begin(), '%', host.size()));
+            if (decode_ipv6(host.begin() + 1, zone ? zone : end, address.bytes)) {
+                address.type = host_type::ipv6;
+                if (zone) address.zone = StringView(zone + 3, static_cast<std::size_t>(end - zone - 3));
+            }
+            return address;
+        }
+
+        URIPP_CONSTEXPR14 std::uint16_t port_number(StringView port) {
+            std::uint32_t value = 0;
+            for (std::size_t i = 0; i < port.size(); ++i) value = value * 10 + static_cast<std::uint32_t>(port[i] - '0');
+            return static_cast<std::uint16_t>(value);
+        }
+    }
+
+    class UriView;
+
+    namespace detail {
+        struct UriAccess;
+    }
+
+    /**
+     * @brief A lightweight, iterable view over a group of components present in a parsed URI
+     * 
+     * Iterating yields entries whose `first` is the component ID and whose `second` is a StringView of its characters,
+     * in the same order the component IDs are declared. The view refers to the URI it came from and must not outlive it.
+     * 
+     * @tparam Component one of Uri::absolute_uri_components, Uri::relative_uri_components or Uri::authority_components
+     */
+    template <class Component>
+    class ComponentsView {
+        public:
+        /**
+         * @brief A component ID and the characters of that component
+         * 
+         */
+        struct value_type {
+            Component first;
+            StringView second;
+        };
+
+        /**
+         * @brief Forward iterator over the present components
+         * 
+         */
+        class iterator {
+            public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef ComponentsView::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const value_type* pointer;
+            typedef const value_type& reference;
+
+            reference operator*() const { return entry; }
+            pointer operator->() const { return &entry; }
+
+            iterator& operator++() {
+                index = view.next(index + 1);
+                load();
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            friend bool operator==(const iterator& a, const iterator& b) { return a.index == b.index; }
+            friend bool operator!=(const iterator& a, const iterator& b) { return a.index != b.index; }
+
+            private:
+            friend class ComponentsView;
+
+            iterator(const ComponentsView& view, unsigned index) : view(view), index(index) {
+                load();
+            }
+
+            void load() {
+                if (index < view.count) entry = view.at(index);
+            }
+
+            ComponentsView view;
+            unsigned index;
+            value_type entry;
+        };
+
+        ComponentsView() : href(nullptr), parts(nullptr), first_part(0), count(0), flags(0) {}
+
+        ComponentsView(const char* href, const detail::UriParts* parts, unsigned first_part, unsigned count)
+            : href(href), parts(parts), first_part(first_part), count(count), flags(parts->flags) {}
+
+        ComponentsView(const char* href, const detail::UriParts* parts, unsigned first_part, unsigned count, std::uint16_t flags)
+            : href(href), parts(parts), first_part(first_part), count(count), flags(flags) {}
+
+        iterator begin() const { return iterator(*this, next(0)); }
+        iterator end() const { return iterator(*this, count); }
+
+        /**
+         * @brief Number of components present in the view
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            std::size_t n = 0;
+            for (unsigned i = next(0); i < count; i = next(i + 1)) ++n;
+            return n;
+        }
+
+        bool empty() const { return next(0) == count; }
+
+        /**
+         * @brief Indicates if a component is present
+         * 
+         * @param comp component ID
+         * @return true if present
+         */
+        bool contains(Component comp) const {
+            return count && has(part_of(static_cast<unsigned>(comp)));
+        }
+
+        /**
+         * @brief Get the characters of a component
+         * 
+         * @param comp component ID
+         * @return StringView the component if present; otherwise an empty view
+         */
+        StringView operator[](Component comp) const {
+            return contains(comp) ? at(static_cast<unsigned>(comp)).second : StringView();
+        }
+
+        private:
+        detail::part_index part_of(unsigned index) const {
+            return static_cast<detail::part_index>(first_part + index);
+        }
+
+        bool has(detail::part_index part) const {
+            return (flags & (1u << part)) != 0;
+        }
+
+        unsigned next(unsigned index) const {
+            while (index < count && !has(part_of(index))) ++index;
+            return index;
+        }
+
+        value_type at(unsigned index) const {
+            value_type entry;
+            entry.first = static_cast<Component>(index);
+            entry.second = StringView(href + parts->offset[part_of(index)], parts->length[part_of(index)]);
+            return entry;
+        }
+
+        const char* href;
+        const detail::UriParts* parts;
+        unsigned first_part;
+        unsigned count;
+        std::uint16_t flags;
+    };
+
+    /**
+     * @brief A lightweight, iterable view over the '/'-separated segments of a path
+     * 
+     * Segments are split on demand while iterating, so nothing is computed or stored until the view is walked.
+     * A single leading '/' is skipped; "/a//b/" yields "a", "", "b" and "", and an empty path yields nothing.
+     * The viewed characters must outlive the view.
+     */
+    class PathSegments {
+        public:
+        class iterator {
+            public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef StringView value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const StringView* pointer;
+            typedef const StringView& reference;
+
+            iterator() : segment_end(nullptr), end(nullptr) {}
+
+            reference operator*() const { return current; }
+            pointer operator->() const { return &current; }
+
+            iterator& operator++() {
+                if (segment_end == end) {
+                    current = StringView();
+                } else {
+                    load(segment_end + 1);
+                }
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator it = *this;
+                ++*this;
+                return it;
+            }
+
+            bool operator==(const iterator& other) const { return current.data() == other.current.data(); }
+            bool operator!=(const iterator& other) const { return !(*this == other); }
+
+            private:
+            friend class PathSegments;
+
+            iterator(const char* begin, const char* end) : segment_end(nullptr), end(end) {
+                load(begin);
+            }
+
+            void load(const char* begin) {
+                segment_end = static_cast<const char*>(std::memchr(begin, '/', static_cast<std::size_t>(end - begin)));
+                if (!segment_end) segment_end = end;
+                current = StringView(begin, static_cast<std::size_t>(segment_end - begin));
+            }
+
+            const char* segment_end;
+            const char* end;
+            StringView current;
+        };
+
+        typedef iterator const_iterator;
+
+        /**
+         * @brief Construct a new PathSegments object
+         * 
+         * @param path path component
+         */
+        explicit PathSegments(StringView path) : path(path) {}
+
+        iterator begin() const {
+            if (path.empty()) return iterator();
+            return iterator(path.data() + (path[0] == '/' ? 1 : 0), path.end());
+        }
+
+        iterator end() const {
+            return iterator();
+        }
+
+        bool empty() const {
+            return path.empty();
+        }
+
+        /**
+         * @brief Number of segments, counted by walking the path
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            std::size_t n = 0;
+            for (iterator it = begin(); it != end(); ++it) ++n;
+            return n;
+        }
+
+        /**
+         * @brief Get the viewed path
+         * 
+         * @return StringView
+         */
+        StringView getPath() const {
+            return path;
+        }
+
+        private:
+        StringView path;
+    };
+
+    /**
+     * @brief A class representing an absolute or relative Uri and its components
+     * 
+     */
+    class Uri {
+        public:
+        /**
+        * @brief An enum for the different components in an absolute URI
+        * 
+        */
+        enum class absolute_uri_components {
+            scheme,
+            authority,
+            path,
+            query,
+            fragment
+        };
+
+        /**
+         * @brief returns string representation of the corresponding absolute URI component
+         * 
+         * @param comp absolute_uri_components representation
+         * @return std::string one of "scheme", authority", "path", "query", "fragment"
+         */
+        static std::string ComponentToString(absolute_uri_components comp){
+            std::string strings[] = {"scheme", "authority", "path", "query", "fragment"};
+            return strings[int(comp)];
+        }
+
+        /**
+        * @brief An enum for the different components in a relative URI
+        * 
+        */
+        enum class relative_uri_components {
+            path,
+            query,
+            fragment
+        };
+
+        /**
+         * @brief returns string representation of the corresponding relative URI component
+         * 
+         * @param comp relative_uri_components representation
+         * @return std::string one of "path", "query", "fragment"
+         */
+        static std::string ComponentToString(relative_uri_components comp){
+            std::string strings[] = {"path", "query", "fragment"};
+            return strings[int(comp)];
+        }
+
+        /**
+        * @brief An enum for the different components of the Authority URI component
+        * 
+        */
+        enum class authority_components {
+            username,
+            password,
+            host,
+            port
+        };
+
+        /**
+         * @brief returns string representation of the corresponding Authority component
+         * 
+         * @param comp authority_components representation
+         * @return std::string one of "username", "password", "host", "port"
+         */
+        static std::string ComponentToString(authority_components comp){
+            std::string strings[] = {"username", "password", "host", "port"};
+            return strings[int(comp)];
+        }
+
+        /**
+         * @brief Construct a new Uri object
+         * 
+         * @param href URI string
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI
+         */
+        Uri(const std::string& href) : Uri(StringView(href)) {}
+
+        /**
+         * @brief Construct a new Uri object
+         * 
+         * @param href null-terminated URI string
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI
+         */
+        Uri(const char* href) : Uri(StringView(href)) {}
+
+        /**
+         * @brief Construct a new Uri object
+         * 
+         * @param href URI characters
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI
+         */
+        Uri(StringView href) : href(href.data(), href.size()) {
+            parse(parse_mode::eager);
+        }
+
+        /**
+         * @brief Construct a new Uri object, splitting the authority now or on first access
+         * 
+         * With parse_mode::lazy, only the scheme, authority, path, query and fragment are located here. Username,
+         * password, host and port are split out, once, by the first accessor that needs them.
+         * 
+         * @param href URI characters
+         * @param mode parse_mode::eager or parse_mode::lazy
+         * @throws std::invalid_argument if cannot parse URI, or Authority component of absolute URI in eager mode
+         */
+        Uri(StringView href, parse_mode mode) : href(href.data(), href.size()) {
+            parse(mode);
+        }
+
+        /**
+         * @brief Construct a new Uri object whose href is allocated from a memory resource, e.g. a UriArena
+         * 
+         * @param href URI characters
+         * @param resource resource to allocate the href from; must outlive the Uri and every Uri moved from it
+         * @param mode parse_mode::eager or parse_mode::lazy; default eager
+         * @throws std::invalid_argument if cannot parse URI, or Authority component of absolute URI in eager mode
+         */
+        Uri(StringView href, UriMemoryResource& resource, parse_mode mode = parse_mode::eager)
+            : href(href.data(), href.size(), detail::ResourceAllocator<char>(&resource)) {
+            parse(mode);
+        }
+
+        /**
+         * @brief Construct a copy of a Uri; safe while other threads read other
+         * 
+         * The copy allocates its href from default_resource(), like copies of a std::pmr string.
+         * 
+         * @param other Uri to copy
+         */
+        Uri(const Uri& other) : href(other.href) {
+            copyParts(other);
+        }
+
+        /**
+         * @brief Construct a Uri by taking over the href of other without copying it
+         * 
+         * other is left as an empty relative URI.
+         * 
+         * @param other Uri to move from
+         */
+        Uri(Uri&& other) noexcept : href(std::move(other.href)) {
+            copyParts(other);
+            other.reset();
+        }
+
+        Uri& operator=(const Uri& other) {
+            if (this != &other) {
+                href = other.href;
+                copyParts(other);
+            }
+            return *this;
+        }
+
+        Uri& operator=(Uri&& other) noexcept {
+            if (this != &other) {
+                href = std::move(other.href);
+                copyParts(other);
+                other.reset();
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Get the Href string
+         * 
+         * @return const std::string
+         */
+        const std::string getHref() const {
+            return std::string(href.data(), href.size());
+        }
+
+        /**
+         * @brief Get the resource the href is allocated from
+         * 
+         * @return UriMemoryResource* default_resource() unless the Uri was constructed with a resource
+         */
+        UriMemoryResource* getMemoryResource() const {
+            return href.get_allocator().getResource();
+        }
+
+        /**
+         * @brief Get the Scheme component of absolute URI
+         * 
+         * @return const std::string Scheme component
+         * @throws std::domain_error if a relative URI
+         */
+        const std::string getScheme() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+            return part(detail::part_scheme);
+        }
+
+        /**
+         * @brief Get the Authority component of absolute URI
+         * 
+         * @return const std::string Authority component
+         * @throws std::domain_error if a relative URI
+         */
+        const std::string getAuthority() const {
+            if(hasAuthority()) 
+                return part(detail::part_authority);
+            else 
+                URIPP_THROW(std::domain_error("Cannot get authority of a relative URI"));
+        }
+
+        /**
+         * @brief Get the Path object
+         * 
+         * @return const std::string 
+         */
+        const std::string getPath() const {
+            return parts.has(detail::part_path) ? part(detail::part_path) : "";
+        }
+
+        /**
+         * @brief Get the Query component of the absolute or relative URI
+         * 
+         * @return const std::string the Query component if available; otherwise an empty string
+         */
+        const std::string getQuery() const {
+            return parts.has(detail::part_query) ? part(detail::part_query) : "";
+        }
+
+        /**
+         * @brief Get the Fragment component of the absolute or relative URI 
+         * 
+         * @return const std::string the Fragment component if available; otherwise an empty string
+         */
+        const std::string getFragment() const {
+            return parts.has(detail::part_fragment) ? part(detail::part_fragment) : "";
+        }
+
+        /**
+         * @brief Get a view over all components of the absolute URI
+         * 
+         * @return ComponentsView<absolute_uri_components> an iterable mapping from component ID to its characters
+         * @throws std::domain_error if URI is relative
+         */
+        ComponentsView<absolute_uri_components> getURIComponents() const {
+            if(!isRelativeUri()) {
+                return ComponentsView<absolute_uri_components>(href.data(), &parts, detail::part_scheme, 5);
+            }
+            
+            URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+        }
+
+        /**
+         * @brief Get a view over all components of the relative URI
+         * 
+         * @return ComponentsView<relative_uri_components> an iterable mapping from component ID to its characters
+         * @throws std::domain_error if URI is absolute
+         */
+        ComponentsView<relative_uri_components> getRelativeURIComponents() const {
+            if(isRelativeUri()) {
+                return ComponentsView<relative_uri_components>(href.data(), &parts, detail::part_path, 3);
+            } else {
+                URIPP_THROW(std::domain_error("Cannot use with absolute URI"));
+            };
+        }
+
+        /**
+         * @brief Get the Username component of the Authority component
+         * 
+         * @return const std::string Username component if available; otherwise an empty string
+         * @throws std::domain_error if URI is relative
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        const std::string getUsername() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            return present(detail::part_username) ? part(detail::part_username) : "";
+        }
+
+        /**
+         * @brief Get the Password component of the Authority component
+         * 
+         * @return const std::string Password component if available; otherwise an empty string
+         * @throws std::domain_error if URI is relative
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        const std::string getPassword() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            return present(detail::part_password) ? part(detail::part_password) : "";
+        }
+
+        /**
+         * @brief Get the Host component of the Authority component
+         * 
+         * @return const std::string Host component if available; otherwise an empty string
+         * @throws std::domain_error if URI is relative
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        const std::string getHost() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            return present(detail::part_host) ? part(detail::part_host) : "";
+        }
+
+        /**
+         * @brief Get the Port component of the Authority component
+         * 
+         * @return const std::string Port component if available; otherwise an empty string
+         * @throws std::domain_error if URI is relative
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        const std::string getPort() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            return present(detail::part_port) ? part(detail::part_port) : "";
+        }
+
+        /**
+         * @brief Get the Port component of the Authority component as a number
+         * 
+         * @return std::uint16_t Port component if available; otherwise 0
+         * @throws std::domain_error if URI is relative
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        std::uint16_t getPortNumber() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            return present(detail::part_port) ? detail::port_number(partView(detail::part_port)) : 0;
+        }
+
+        /**
+         * @brief Get the kind of the Host component
+         * 
+         * @return host_type kind of Host if available; otherwise host_type::none
+         * @throws std::domain_error if URI is relative
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        host_type getHostType() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            return present(detail::part_host) ? detail::classify_host(partView(detail::part_host)) : host_type::none;
+        }
+
+        /**
+         * @brief Get the binary address of an IPv4 or IPv6 Host component
+         * 
+         * @return IpAddress decoded address, with the zone ID of an IPv6 address viewed in the href of this Uri
+         * @throws std::domain_error if URI is relative or the Host is not an IPv4 or IPv6 address
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        IpAddress getHostAddress() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            IpAddress address = present(detail::part_host) ? detail::decode_host(partView(detail::part_host)) : IpAddress();
+            if (address.type == host_type::none) URIPP_THROW(std::domain_error("The host is not an IP address"));
+            return address;
+        }
+
+        /**
+         * @brief Get a view over all sub-components of the Authority component
+         * 
+         * @return ComponentsView<authority_components> an iterable mapping from component ID to its characters; empty if there is no Authority
+         * @throws std::domain_error if relative URI
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        ComponentsView<authority_components> getAuthorityComponents() const {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+
+            return ComponentsView<authority_components>(href.data(), &parts, detail::part_username, 4, presence());
+        }
+
+        /**
+         * @brief Indicates if absolute URI has a Authority component
+         * 
+         * @return true if the absolute URI has Authority
+         * @return false if the absolute URI does not have Authority
+         */
+        bool hasAuthority() const {
+            return parts.has(detail::part_authority);
+        }
+
+        /**
+         * @brief Indicates if the relative or absolute URI has a Query component
+         * 
+         * @return true if the relative or absolute URI has Query 
+         * @return false if the relative or absolute URI does not have Query
+         */
+        bool hasQuery() const {
+            return parts.has(detail::part_query);
+        }
+
+
+        /**
+         * @brief Indicates if the relative or absolute URI has a Fragment component
+         * 
+         * @return true if the relative or absolute URI has Fragment 
+         * @return false if the relative or absolute URI does not have Fragment
+         */
+        bool hasFragment() const {
+            return parts.has(detail::part_fragment);
+        }
+        
+        /**
+         * @brief Indicates if the URI has a username in the Authority component
+         * 
+         * @return true if Authority component contains username
+         * @return false if Authority component does not contains username
+         */
+        bool hasUsername() const {
+            return present(detail::part_username);
+        }
+
+        /**
+         * @brief Indicates if the URI has a password in the Authority component
+         * 
+         * @return true if Authority component contains password
+         * @return false if Authority component does not contains password
+         */
+        bool hasPassword() const {
+            return present(detail::part_password);
+        }
+
+        /**
+         * @brief Indicates if the URI has a port in the Authority component 
+         * 
+         * @return true if Authority component contains port
+         * @return false if Authority component does not contains port
+         */
+        bool hasPort() const {
+            return present(detail::part_port);
+        }
+
+        /**
+         * @brief Get a view over the segments of the Path component
+         * 
+         * @return PathSegments segments split on demand while iterating; refers to the href of this Uri
+         */
+        PathSegments getPathSegments() const {
+            return PathSegments(StringView(href.data() + parts.offset[detail::part_path], parts.length[detail::part_path]));
+        }
+
+        /**
+         * @brief Replace the Host component of an absolute URI
+         * 
+         * Like every setter, the href is spliced in place, reusing its capacity, and only the offsets of the components
+         * after the change are moved; nothing else is parsed again. An absolute URI without an Authority component gains
+         * one. Setters invalidate views of this Uri and must not run while other threads read it. If a setter throws,
+         * the Uri is left unchanged.
+         * 
+         * @param host reg-name, IPv4 address or IP-literal in brackets
+         * @return Uri& this Uri
+         * @throws std::domain_error if URI is relative, or has no Authority component and a path that does not start with '/'
+         * @throws std::invalid_argument if host is not a valid Host component, or the Authority component is not valid; the latter only in lazy mode
+         */
+        Uri& setHost(StringView host) {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+            settleAuthority();
+
+            detail::UriParts checked = detail::UriParts();
+            std::size_t error_offset;
+            parse_error error = detail::scan_host_port(host.data(), 0, host.size(), checked, error_offset);
+            if (error == parse_error::none && checked.has(detail::part_port)) error = parse_error::invalid_host;
+            if (error != parse_error::none) detail::throw_parse_error(error);
+
+            if (parts.has(detail::part_host)) {
+                std::size_t begin = parts.offset[detail::part_host];
+                std::size_t end = begin + parts.length[detail::part_host];
+                splice(detail::part_host, begin, end, StringView(), host);
+                parts.length[detail::part_authority] = static_cast<std::uint32_t>(parts.length[detail::part_authority] + host.size() - (end - begin));
+                parts.set(detail::part_host, begin, begin + host.size());
+            } else {
+                // "scheme:" is followed by the "//" of an empty authority, or by a path that must not be taken for one
+                std::size_t begin = parts.length[detail::part_scheme] + 1;
+                bool slashes = parts.offset[detail::part_path] == begin + 2;
+                if (!slashes && parts.length[detail::part_path] > 0 && href[begin] != '/') {
+                    URIPP_THROW(std::domain_error("Cannot add an authority before a path that does not start with '/'"));
+                }
+                std::size_t at = splice(detail::part_host, slashes ? begin + 2 : begin, slashes ? begin + 2 : begin, slashes ? StringView() : StringView("//"), host);
+                parts.set(detail::part_authority, at, at + host.size());
+                parts.set(detail::part_host, at, at + host.size());
+            }
+
+            parts.flags = static_cast<std::uint16_t>(parts.flags & ~detail::flag_ipv6_host);
+            if (host[0] == '[') parts.flags = static_cast<std::uint16_t>(parts.flags | detail::flag_ipv6_host);
+            return *this;
+        }
+
+        /**
+         * @brief Replace, add or remove the Port component of an absolute URI
+         * 
+         * @param port one or more digits up to 65535; empty to remove the port
+         * @return Uri& this Uri
+         * @throws std::domain_error if URI is relative or has no Host component
+         * @throws std::invalid_argument if port is not a valid Port component, or the Authority component is not valid; the latter only in lazy mode
+         */
+        Uri& setPort(StringView port) {
+            if(isRelativeUri()) URIPP_THROW(std::domain_error("Cannot use with relative URI"));
+            settleAuthority();
+            if (!parts.has(detail::part_host)) URIPP_THROW(std::domain_error("Cannot set the port of a URI without a host"));
+
+            std::uint32_t number = 0;
+            for (char c : port) {
+                number = number * 10 + static_cast<std::uint32_t>(c - '0');
+                if (!detail::is_digit(c) || number > 65535) detail::throw_parse_error(parse_error::invalid_port);
+            }
+
+            std::size_t begin = parts.offset[detail::part_host] + parts.length[detail::part_host];
+            std::size_t end = parts.has(detail::part_port) ? parts.offset[detail::part_port] + parts.length[detail::part_port] : begin;
+            std::size_t at = splice(detail::part_port, begin, end, port.empty() ? StringView() : StringView(":"), port);
+            parts.length[detail::part_authority] = static_cast<std::uint32_t>(at + port.size() - parts.offset[detail::part_authority]);
+            if (port.empty()) clear(detail::part_port);
+            else parts.set(detail::part_port, at, at + port.size());
+            return *this;
+        }
+
+        /**
+         * @brief Replace or add the Port component of an absolute URI
+         * 
+         * @param port port number
+         * @return Uri& this Uri
+         * @throws std::domain_error if URI is relative or has no Host component
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        Uri& setPort(std::uint16_t port) {
+            char digits[5];
+            std::size_t size = 0;
+            do {
+                digits[4 - size++] = static_cast<char>('0' + port % 10);
+                port = static_cast<std::uint16_t>(port / 10);
+            } while (port);
+            return setPort(StringView(digits + 5 - size, size));
+        }
+
+        /**
+         * @brief Replace the Path component of the absolute or relative URI
+         * 
+         * @param path new Path component; after an Authority component it must be empty or start with '/'
+         * @return Uri& this Uri
+         * @throws std::invalid_argument if path is not a valid Path component of this URI
+         */
+        Uri& setPath(StringView path) {
+            if (!validPath(path)) URIPP_THROW(std::invalid_argument("The provided path is not a valid path of this URI"));
+
+            std::size_t begin = isRelativeUri() ? 0 : parts.offset[detail::part_path];
+            std::size_t end = parts.has(detail::part_path) ? parts.offset[detail::part_path] + parts.length[detail::part_path] : 0;
+            splice(detail::part_path, begin, end, StringView(), path);
+            // a relative URI records an empty path as absent, an absolute URI as present
+            if (isRelativeUri() && path.empty()) clear(detail::part_path);
+            else parts.set(detail::part_path, begin, begin + path.size());
+            return *this;
+        }
+
+        /**
+         * @brief Replace, add or remove the Query component of the absolute or relative URI
+         * 
+         * @param query new Query component, without its '?'; empty to remove the query
+         * @return Uri& this Uri
+         * @throws std::invalid_argument if query is not a valid Query component of this URI
+         */
+        Uri& setQuery(StringView query) {
+            detail::ByteClass cls = isRelativeUri() ? detail::ByteClass{{'#', '#', '#', '#'}, true} : detail::ByteClass{{'#', '#', '#', '#'}, false};
+            if (detail::find_first(query.begin(), query.end(), cls) != query.end()) {
+                URIPP_THROW(std::invalid_argument("The provided query is not a valid query of this URI"));
+            }
+            assignQuery(query);
+            return *this;
+        }
+
+        /**
+         * @brief Remove every key=value pair of the Query component whose key matches, with one separator next to it
+         * 
+         * The query is removed with its last pair. Keys are compared as they appear in the href, without decoding.
+         * 
+         * @param key key to remove
+         * @param separators one to four characters that separate pairs; default "&"
+         * @return std::size_t number of pairs removed
+         * @throws std::invalid_argument if separators is empty or longer than four characters
+         */
+        std::size_t removeQueryParam(StringView key, StringView separators = "&") {
+            if (separators.empty() || separators.size() > 4) {
+                URIPP_THROW(std::invalid_argument("A query takes one to four separator characters"));
+            }
+            if (!parts.has(detail::part_query)) return 0;
+
+            detail::ByteClass cls = detail::ByteClass();
+            for (std::size_t i = 0; i < 4; ++i) cls.delimiters[i] = separators[i < separators.size() ? i : 0];
+            cls.invalid = false;
+
+            // pairs are compacted in place, so a key viewing the href is copied first
+            if (key.data() >= href.data() && key.data() < href.data() + href.size()) {
+                std::string copy(key.data(), key.size());
+                return removeQueryParam(StringView(copy), separators);
+            }
+
+            char* s = &href[0];
+            std::size_t begin = parts.offset[detail::part_query] + (isRelativeUri() ? 1 : 0);
+            std::size_t end = parts.offset[detail::part_query] + parts.length[detail::part_query];
+            std::size_t write = begin;
+            std::size_t removed = 0;
+            bool first = true;
+            for (std::size_t read = begin;;) {
+                std::size_t pair_end = static_cast<std::size_t>(detail::find_first(s + read, s + end, cls) - s);
+                StringView pair(s + read, pair_end - read);
+                const char* equals = static_cast<const char*>(std::memchr(pair.data(), '=', pair.size()));
+                if (!pair.empty() && (equals ? pair.substr(0, static_cast<std::size_t>(equals - pair.data())) : pair) == key) {
+                    ++removed;
+                } else {
+                    // every pair kept after the first is joined by the separator that came before it
+                    if (!first) s[write++] = s[read - 1];
+                    std::memmove(s + write, s + read, pair.size());
+                    write += pair.size();
+                    first = false;
+                }
+                if (pair_end == end) break;
+                read = pair_end + 1;
+            }
+
+            if (!removed) return 0;
+            if (write == begin) {
+                assignQuery(StringView());
+            } else {
+                splice(detail::part_query, write, end, StringView(), StringView());
+                parts.length[detail::part_query] = static_cast<std::uint32_t>(write - parts.offset[detail::part_query]);
+            }
+            return removed;
+        }
+
+        /**
+         * @brief Replace, add or remove the Fragment component of the absolute or relative URI
+         * 
+         * @param fragment new Fragment component, without its '#'; empty to remove the fragment
+         * @return Uri& this Uri
+         * @throws std::invalid_argument if fragment is not a valid Fragment component of this URI
+         */
+        Uri& setFragment(StringView fragment) {
+            detail::ByteClass cls = isRelativeUri() ? detail::ByteClass{{'#', '#', '#', '#'}, true} : detail::ByteClass{{'\n', '\r', '\n', '\r'}, false};
+            if (detail::find_first(fragment.begin(), fragment.end(), cls) != fragment.end()) {
+                URIPP_THROW(std::invalid_argument("The provided fragment is not a valid fragment of this URI"));
+            }
+
+            std::size_t begin = queryEnd();
+            if (fragment.empty()) {
+                splice(detail::part_fragment, begin, href.size(), StringView(), StringView());
+                clear(detail::part_fragment);
+                return *this;
+            }
+            std::size_t at = splice(detail::part_fragment, begin, href.size(), StringView("#"), fragment);
+            parts.set(detail::part_fragment, isRelativeUri() ? begin : at, at + fragment.size());
+            return *this;
+        }
+
+        /**
+         * @brief Indicates if the URI is relative
+         * 
+         * @return true if relative URI
+         * @return false if absolute URI
+         */
+        bool isRelativeUri() const {
+            return (parts.flags & detail::flag_relative) != 0;
+        }
+
+        /**
+         * @brief Get a non-throwing, allocation-free view of this URI
+         * 
+         * The accessors of the view return an empty StringView where the getters of Uri would throw or return an empty string.
+         * The view refers to the href of this Uri and must not outlive it.
+         * 
+         * @return UriView view over this URI
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        UriView view() const;
+
+        /**
+         * @brief << Operator overload
+         * 
+         * @param os output stream
+         * @param uri Uri object
+         * @return std::ostream& output stream with added href
+         */
+        friend std::ostream& operator<<(std::ostream& os, const Uri& uri) { 
+            os << uri.href;
+            return os;
+        }
+
+        private:
+        friend class UriView;
+        friend struct detail::UriAccess;
+        template <class T> friend class ParseResult;
+
+        Uri() {
+
+        }
+
+        Uri(detail::href_string href, const detail::UriParts& parts) : href(std::move(href)), parts(parts) {
+            adoptPending();
+        }
+
+        void parse(parse_mode mode) {
+            std::size_t error_offset;
+            parse_error error = detail::scan_uri(href.data(), href.size(), parts, error_offset, mode == parse_mode::eager);
+            if (error != parse_error::none) detail::throw_parse_error(error);
+            adoptPending();
+        }
+
+        void reset() {
+            href.clear();
+            parts = detail::UriParts();
+            parts.flags = detail::flag_relative;
+            authority.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Moves the pending bit left by a lazy scan out of the component table and into the atomic authority state
+         * 
+         */
+        void adoptPending() {
+            if (!(parts.flags & detail::flag_authority_pending)) return;
+
+            parts.flags = static_cast<std::uint16_t>(parts.flags & ~detail::flag_authority_pending);
+            authority.store(detail::flag_authority_pending, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Waits out a split running on another thread and returns the authority state
+         * 
+         */
+        std::uint16_t settled() const {
+            std::uint16_t state = authority.load(std::memory_order_acquire);
+            while (state & detail::flag_authority_busy) {
+                std::this_thread::yield();
+                state = authority.load(std::memory_order_acquire);
+            }
+            return state;
+        }
+
+        /**
+         * @brief Splits a pending authority on exactly one thread; the others wait for its result
+         * 
+         * @return std::uint16_t presence bits of username, password, host and port
+         * @throws std::invalid_argument if the Authority component is not valid; it then stays pending
+         */
+        std::uint16_t splitAuthority() const {
+            for (;;) {
+                std::uint16_t state = settled();
+                if (!(state & detail::flag_authority_pending)) return state;
+                if (!authority.compare_exchange_weak(state, detail::flag_authority_busy, std::memory_order_acquire)) continue;
+
+                detail::UriParts split;
+                std::size_t error_offset;
+                parse_error error = detail::split_authority(href.data(), parts, split, error_offset);
+                if (error != parse_error::none) {
+                    authority.store(detail::flag_authority_pending, std::memory_order_release);
+                    detail::throw_parse_error(error);
+                }
+
+                for (int i = detail::part_username; i < detail::part_count; ++i) {
+                    parts.offset[i] = split.offset[i];
+                    parts.length[i] = split.length[i];
+                }
+                authority.store(split.flags, std::memory_order_release);
+                return split.flags;
+            }
+        }
+
+        /**
+         * @brief Get the presence bits of every component, splitting a pending authority first
+         * 
+         */
+        std::uint16_t presence() const {
+            std::uint16_t state = authority.load(std::memory_order_acquire);
+            if (state & (detail::flag_authority_pending | detail::flag_authority_busy)) state = splitAuthority();
+            return static_cast<std::uint16_t>(parts.flags | state);
+        }
+
+        bool present(detail::part_index index) const {
+            return (presence() & (1u << index)) != 0;
+        }
+
+        /**
+         * @brief Get the component table with the authority split
+         * 
+         */
+        detail::UriParts snapshot() const {
+            std::uint16_t flags = presence();
+            detail::UriParts split = parts;
+            split.flags = flags;
+            return split;
+        }
+
+        /**
+         * @brief Copies the component table of other, leaving out authority entries that are not split yet
+         * 
+         */
+        void copyParts(const Uri& other) {
+            std::uint16_t state = other.settled();
+            int copied = (state & detail::flag_authority_pending) ? detail::part_username : detail::part_count;
+            for (int i = 0; i < copied; ++i) {
+                parts.offset[i] = other.parts.offset[i];
+                parts.length[i] = other.parts.length[i];
+            }
+            parts.flags = other.parts.flags;
+            authority.store(state, std::memory_order_relaxed);
+        }
+
+        std::string part(detail::part_index index) const {
+            return std::string(href.data() + parts.offset[index], parts.length[index]);
+        }
+
+        StringView partView(detail::part_index index) const {
+            return StringView(href.data() + parts.offset[index], parts.length[index]);
+        }
+
+        /**
+         * @brief Splits a pending authority and folds its presence bits into the component table, as an eager parse leaves them
+         * 
+         */
+        void settleAuthority() {
+            parts.flags = presence();
+            authority.store(0, std::memory_order_relaxed);
+        }
+
+        void clear(detail::part_index index) {
+            parts.flags = static_cast<std::uint16_t>(parts.flags & ~(1u << index));
+        }
+
+        /**
+         * @brief Replaces href[begin, end), which holds component, with lead followed by value, and moves the components after it
+         * 
+         * The caller records component itself and adjusts the authority around it.
+         * 
+         * @return std::size_t offset at which value was written
+         * @throws std::invalid_argument if the href would outgrow the offset table
+         */
+        std::size_t splice(detail::part_index component, std::size_t begin, std::size_t end, StringView lead, StringView value) {
+            // position of every component in the href; the authority spans username to port and is never moved
+            static const int order[detail::part_count] = {0, -1, 5, 6, 7, 1, 2, 3, 4};
+
+            if (value.data() >= href.data() && value.data() < href.data() + href.size()) {
+                std::string copy(value.data(), value.size());
+                return splice(component, begin, end, lead, StringView(copy));
+            }
+
+            std::size_t size = lead.size() + value.size();
+            if (href.size() - (end - begin) + size > UINT32_MAX) detail::throw_parse_error(parse_error::too_long);
+
+            href.replace(begin, end - begin, size, '\0');
+            if (!lead.empty()) std::memcpy(&href[begin], lead.data(), lead.size());
+            if (!value.empty()) std::memcpy(&href[begin + lead.size()], value.data(), value.size());
+
+            std::uint32_t grown = static_cast<std::uint32_t>(size - (end - begin));
+            for (int i = 0; i < detail::part_count; ++i) {
+                if (order[i] > order[component] && parts.has(detail::part_index(i))) parts.offset[i] += grown;
+            }
+            return begin + lead.size();
+        }
+
+        /**
+         * @brief Checks that path can replace the Path component without changing how the href splits
+         * 
+         */
+        bool validPath(StringView path) const {
+            if (isRelativeUri()) {
+                detail::UriParts checked = detail::UriParts();
+                std::size_t error_offset;
+                return detail::scan_relative(path.data(), path.size(), checked, error_offset) == parse_error::none &&
+                       !checked.has(detail::part_query) && !checked.has(detail::part_fragment);
+            }
+
+            if (detail::find_first(path.begin(), path.end(), detail::ByteClass{{'?', '#', '#', '#'}, false}) != path.end()) return false;
+            // after "//", with or without an authority, a path starts with '/'; otherwise it must not start with "//"
+            if (hasAuthority() || parts.offset[detail::part_path] == parts.length[detail::part_scheme] + 3) return path.empty() || path[0] == '/';
+            return path.size() < 2 || path[0] != '/' || path[1] != '/';
+        }
+
+        /**
+         * @brief Get the end of the query, or of an empty "?" left without a query, where the fragment starts
+         * 
+         */
+        std::size_t queryEnd() const {
+            if (parts.has(detail::part_query)) return parts.offset[detail::part_query] + parts.length[detail::part_query];
+            std::size_t end = parts.has(detail::part_path) ? parts.offset[detail::part_path] + parts.length[detail::part_path] : 0;
+            return end < href.size() && href[end] == '?' ? end + 1 : end;
+        }
+
+        void assignQuery(StringView query) {
+            std::size_t begin = parts.has(detail::part_path) ? parts.offset[detail::part_path] + parts.length[detail::part_path] : 0;
+            std::size_t end = queryEnd();
+            if (query.empty()) {
+                splice(detail::part_query, begin, end, StringView(), StringView());
+                clear(detail::part_query);
+                return;
+            }
+            std::size_t at = splice(detail::part_query, begin, end, StringView("?"), query);
+            // the query of a relative URI keeps its '?'
+            parts.set(detail::part_query, isRelativeUri() ? begin : at, at + query.size());
+        }
+
+        detail::href_string href;
+        // Written after construction only in the username, password, host and port entries, by the thread that claims a lazy split
+        mutable detail::UriParts parts = detail::UriParts();
+        // 0 for an eager parse; flag_authority_pending or flag_authority_busy until a lazy split, then the presence bits it found
+        mutable std::atomic<std::uint16_t> authority{0};
+    };
+
+    /**
+     * @brief A non-owning view of an absolute or relative URI parsed in place over a borrowed buffer
+     * 
+     * The view records only the offset and length of every component, so parsing and every accessor are allocation-free.
+     * The viewed characters must outlive the view; use toUri() to obtain an owning copy. Unlike Uri, the accessors
+     * never throw: a component that is absent, or does not apply to the kind of URI, is returned as an empty view.
+     */
+    class UriView {
+        public:
+        /**
+         * @brief Construct a new UriView over a character range
+         * 
+         * @param data first character of the href
+         * @param size number of characters
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI
+         */
+        UriView(const char* data, std::size_t size) : href(data, size) {
+            std::size_t error_offset;
+            parse_error error = detail::scan_uri(data, size, parts, error_offset);
+            if (error != parse_error::none) detail::throw_parse_error(error);
+        }
+
+        /**
+         * @brief Construct a new UriView over the characters of a view
+         * 
+         * @param href URI characters
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI
+         */
+        explicit UriView(StringView href) : UriView(href.data(), href.size()) {}
+
+        /**
+         * @brief Get the viewed href
+         * 
+         * @return StringView
+         */
+        StringView getHref() const {
+            return href;
+        }
+
+        /**
+         * @brief Get the Scheme component of an absolute URI
+         * 
+         * @return StringView Scheme component; empty for a relative URI
+         */
+        StringView getScheme() const {
+            return part(detail::part_scheme);
+        }
+
+        /**
+         * @brief Get the Authority component of an absolute URI
+         * 
+         * @return StringView Authority component if available; otherwise an empty view
+         */
+        StringView getAuthority() const {
+            return part(detail::part_authority);
+        }
+
+        /**
+         * @brief Get the Path component of the absolute or relative URI
+         * 
+         * @return StringView Path component if available; otherwise an empty view
+         */
+        StringView getPath() const {
+            return part(detail::part_path);
+        }
+
+        /**
+         * @brief Get the Query component of the absolute or relative URI
+         * 
+         * @return StringView Query component if available; otherwise an empty view
+         */
+        StringView getQuery() const {
+            return part(detail::part_query);
+        }
+
+        /**
+         * @brief Get the Fragment component of the absolute or relative URI
+         * 
+         * @return StringView Fragment component if available; otherwise an empty view
+         */
+        StringView getFragment() const {
+            return part(detail::part_fragment);
+        }
+
+        /**
+         * @brief Get the Username component of the Authority component
+         * 
+         * @return StringView Username component if available; otherwise an empty view
+         */
+        StringView getUsername() const {
+            return part(detail::part_username);
+        }
+
+        /**
+         * @brief Get the Password component of the Authority component
+         * 
+         * @return StringView Password component if available; otherwise an empty view
+         */
+        StringView getPassword() const {
+            return part(detail::part_password);
+        }
+
+        /**
+         * @brief Get the Host component of the Authority component
+         * 
+         * @return StringView Host component if available; otherwise an empty view
+         */
+        StringView getHost() const {
+            return part(detail::part_host);
+        }
+
+        /**
+         * @brief Get the Port component of the Authority component
+         * 
+         * @return StringView Port component if available; otherwise an empty view
+         */
+        StringView getPort() const {
+            return part(detail::part_port);
+        }
+
+        /**
+         * @brief Get the Port component of the Authority component as a number
+         * 
+         * @return std::uint16_t Port component if available; otherwise 0
+         */
+        std::uint16_t getPortNumber() const {
+            return detail::port_number(part(detail::part_port));
+        }
+
+        /**
+         * @brief Get the kind of the Host component
+         * 
+         * @return host_type kind of Host if available; otherwise host_type::none
+         */
+        host_type getHostType() const {
+            return detail::classify_host(part(detail::part_host));
+        }
+
+        /**
+         * @brief Get the binary address of an IPv4 or IPv6 Host component
+         * 
+         * @return IpAddress decoded address; its type is host_type::none if the Host is absent or not an IP address
+         */
+        IpAddress getHostAddress() const {
+            return detail::decode_host(part(detail::part_host));
+        }
+
+        bool hasAuthority() const { return parts.has(detail::part_authority); }
+        bool hasQuery() const { return parts.has(detail::part_query); }
+        bool hasFragment() const { return parts.has(detail::part_fragment); }
+        bool hasUsername() const { return parts.has(detail::part_username); }
+        bool hasPassword() const { return parts.has(detail::part_password); }
+        bool hasPort() const { return parts.has(detail::part_port); }
+        bool isRelativeUri() const { return (parts.flags & detail::flag_relative) != 0; }
+
+        /**
+         * @brief Get a view over the segments of the Path component
+         * 
+         * @return PathSegments segments split on demand while iterating
+         */
+        PathSegments getPathSegments() const {
+            return PathSegments(getPath());
+        }
+
+        /**
+         * @brief Copy the viewed href into an owning Uri without parsing it again
+         * 
+         * @return Uri owning copy of the URI
+         */
+        Uri toUri() const {
+            return Uri(detail::href_string(href.data(), href.size()), parts);
+        }
+
+        /**
+         * @brief Copy the viewed href into a Uri that allocates it from a memory resource
+         * 
+         * @param resource resource to allocate the href from, e.g. a UriArena; must outlive the Uri
+         * @return Uri owning copy
+         */
+        Uri toUri(UriMemoryResource& resource) const {
+            return Uri(detail::href_string(href.data(), href.size(), detail::ResourceAllocator<char>(&resource)), parts);
+        }
+
+        /**
+         * @brief << Operator overload
+         * 
+         * @param os output stream
+         * @param uri UriView object
+         * @return std::ostream& output stream with added href
+         */
+        friend std::ostream& operator<<(std::ostream& os, const UriView& uri) {
+            return os << uri.href;
+        }
+
+        private:
+        friend class Uri;
+        friend struct detail::UriAccess;
+        template <class T> friend class ParseResult;
+
+        UriView() : parts(detail::UriParts()) {}
+
+        UriView(StringView href, const detail::UriParts& parts) : href(href), parts(parts) {}
+
+        StringView part(detail::part_index index) const {
+            if (!parts.has(index)) return StringView();
+            return StringView(href.data() + parts.offset[index], parts.length[index]);
+        }
+
+        StringView href;
+        detail::UriParts parts;
+    };
+
+    inline UriView Uri::view() const {
+        return UriView(StringView(href.data(), href.size()), snapshot());
+    }
+
+    namespace detail {
+        /**
+         * @brief Gives the library internals access to the component table of Uri and UriView
+         * 
+         */
+        struct UriAccess {
+            static Uri make_uri(href_string href, const UriParts& parts) {
+                return Uri(std::move(href), parts);
+            }
+
+            static UriView make_view(StringView href, const UriParts& parts) {
+                return UriView(href, parts);
+            }
+
+            static UriParts parts(const Uri& uri) {
+                return uri.snapshot();
+            }
+
+            static const UriParts& parts(const UriView& uri) {
+                return uri.parts;
+            }
+        };
+    }
+
+    /**
+     * @brief The outcome of a non-throwing parse: either the parsed URI, or the reason it was rejected and where
+     * 
+     * @tparam T Uri, UriView, or the UriHandle of a UriStore
+     */
+    template <class T>
+    class ParseResult {
+        public:
+        /**
+         * @brief Construct a successful ParseResult
+         * 
+         * @param uri parsed URI
+         */
+        explicit ParseResult(T uri) : uri(std::move(uri)), error(parse_error::none), error_offset(0) {}
+
+        /**
+         * @brief Construct a failed ParseResult
+         * 
+         * @param error reason the href was rejected
+         * @param error_offset byte offset in the href at which it was rejected
+         */
+        ParseResult(parse_error error, std::size_t error_offset) : error(error), error_offset(error_offset) {}
+
+        /**
+         * @brief Indicates if the href was parsed
+         * 
+         * @return true if getUri() holds the parsed URI
+         * @return false if the href was rejected
+         */
+        bool ok() const {
+            return error == parse_error::none;
+        }
+
+        explicit operator bool() const {
+            return ok();
+        }
+
+        /**
+         * @brief Get the reason the href was rejected
+         * 
+         * @return parse_error parse_error::none if the href was parsed
+         */
+        parse_error getError() const {
+            return error;
+        }
+
+        /**
+         * @brief Get the byte offset in the href at which it was rejected
+         * 
+         * @return std::size_t offset of the first offending character, or the length of the href if it ended too early; 0 if parsed
+         */
+        std::size_t getErrorOffset() const {
+            return error_offset;
+        }
+
+        /**
+         * @brief Get the parsed URI
+         * 
+         * @return T& the parsed URI; an empty URI if the href was rejected
+         */
+        T& getUri() {
+            return uri;
+        }
+
+        const T& getUri() const {
+            return uri;
+        }
+
+        private:
+        T uri;
+        parse_error error;
+        std::size_t error_offset;
+    };
+
+    /**
+     * @brief Parse an href without throwing
+     * 
+     * @param href URI string
+     * @return ParseResult<Uri> the parsed Uri, or the reason and offset at which href was rejected
+     */
+    inline ParseResult<Uri> try_parse(StringView href) {
+        detail::UriParts parts;
+        std::size_t error_offset;
+        parse_error error = detail::scan_uri(href.data(), href.size(), parts, error_offset);
+
+        if (error != parse_error::none) return ParseResult<Uri>(error, error_offset);
+        return ParseResult<Uri>(detail::UriAccess::make_uri(detail::href_string(href.data(), href.size()), parts));
+    }
+
+    /**
+     * @brief Parse an href without throwing into a Uri that allocates its href from a memory resource
+     * 
+     * @param href URI string
+     * @param resource resource to allocate the href from, e.g. a UriArena; must outlive the Uri
+     * @return ParseResult<Uri> the parsed Uri, or the reason and offset at which href was rejected
+     */
+    inline ParseResult<Uri> try_parse(StringView href, UriMemoryResource& resource) {
+        detail::UriParts parts;
+        std::size_t error_offset;
+        parse_error error = detail::scan_uri(href.data(), href.size(), parts, error_offset);
+
+        if (error != parse_error::none) return ParseResult<Uri>(error, error_offset);
+        detail::href_string owned(href.data(), href.size(), detail::ResourceAllocator<char>(&resource));
+        return ParseResult<Uri>(detail::UriAccess::make_uri(std::move(owned), parts));
+    }
+
+    /**
+     * @brief Parse a borrowed character range into a UriView without throwing or allocating
+     * 
+     * @param data first character of the href
+     * @param size number of characters
+     * @return ParseResult<UriView> the parsed UriView, or the reason and offset at which the href was rejected
+     */
+    inline ParseResult<UriView> try_parse_view(const char* data, std::size_t size) {
+        detail::UriParts parts;
+        std::size_t error_offset;
+        parse_error error = detail::scan_uri(data, size, parts, error_offset);
+
+        if (error != parse_error::none) return ParseResult<UriView>(error, error_offset);
+        return ParseResult<UriView>(detail::UriAccess::make_view(StringView(data, size), parts));
+    }
+
+    /**
+     * @brief Parse a borrowed href into a UriView without throwing or allocating
+     * 
+     * @param href URI characters
+     * @return ParseResult<UriView> the parsed UriView, or the reason and offset at which href was rejected
+     */
+    inline ParseResult<UriView> try_parse_view(StringView href) {
+        return try_parse_view(href.data(), href.size());
+    }
+
+    /**
+     * @brief Get the port a scheme uses when its URIs leave the port out
+     * 
+     * @param scheme Scheme component, in any case
+     * @return std::uint16_t 80 for http and ws, 443 for https and wss, 21 for ftp; otherwise 0
+     */
+    inline std::uint16_t default_port(StringView scheme) {
+        char lowered[8];
+        if (scheme.size() > sizeof(lowered)) return 0;
+        for (std::size_t i = 0; i < scheme.size(); ++i) lowered[i] = detail::to_lower(scheme[i]);
+        StringView s(lowered, scheme.size());
+
+        if (s == "http" || s == "ws") return 80;
+        if (s == "https" || s == "wss") return 443;
+        if (s == "ftp") return 21;
+        return 0;
+    }
+
+    /**
+     * @brief The components percent_encode can encode for, each with its own set of characters left as is
+     * 
+     * Every set keeps the unreserved characters and sub-delims; userinfo also keeps ':', path keeps ':', '@' and '/',
+     * and query and fragment keep ':', '@', '/' and '?'. query_parameter is the query set minus '&', '=' and '+',
+     * for keys and values of key=value pairs. userinfo_field is the userinfo set minus ':', for a username or a
+     * password on its own, since the ':' between them is the only one a userinfo may keep. '%' is always encoded.
+     */
+    enum class encode_set {
+        path,
+        query,
+        fragment,
+        userinfo,
+        query_parameter,
+        userinfo_field
+    };
+
+    namespace detail {
+        /**
+         * @brief The bytes percent_encode must escape for a component, as a find_first class
+         * 
+         */
+        inline ByteClass encode_class(encode_set set) {
+            switch (set) {
+                case encode_set::path: return ByteClass{{'%', '?', '?', '?'}, true};
+                case encode_set::userinfo:
+                case encode_set::userinfo_field: return ByteClass{{'%', '/', '?', '@'}, true};
+                case encode_set::query_parameter: return ByteClass{{'%', '&', '=', '+'}, true};
+                default: return ByteClass{{'%', '%', '%', '%'}, true};
+            }
+        }
+
+        /**
+         * @brief Whether a set also escapes ':', which does not fit in the four delimiters of its class
+         * 
+         */
+        inline bool encodes_colon(encode_set set) {
+            return set == encode_set::userinfo_field;
+        }
+
+        /**
+         * @brief find_first for cls, stopping at a ':' as well when colon is set
+         * 
+         */
+        inline const char* find_escape(const char* p, const char* end, ByteClass cls, bool colon) {
+            const char* found = find_first(p, end, cls);
+            if (!colon) return found;
+            const void* at = std::memchr(p, ':', static_cast<std::size_t>(found - p));
+            return at ? static_cast<const char*>(at) : found;
+        }
+
+        inline std::size_t encoded_size(StringView in, ByteClass cls, bool colon = false) {
+            std::size_t size = in.size();
+
+            for (const char* p = find_escape(in.begin(), in.end(), cls, colon); p != in.end(); p = find_escape(p + 1, in.end(), cls, colon)) {
+                size += 2;
+            }
+            return size;
+        }
+
+        inline char hex_digit(unsigned value) {
+            return "0123456789ABCDEF"[value & 0xF];
+        }
+
+        /**
+         * @brief Percent-encodes the bytes of in that belong to cls, and ':' when colon is set, into out, copying the runs
+         * in between as is
+         * 
+         * @return std::size_t number of bytes written
+         */
+        inline std::size_t encode_into(StringView in, ByteClass cls, char* out, bool colon = false) {
+            const char* p = in.begin();
+            char* o = out;
+
+            while (p < in.end()) {
+                const char* run_end = find_escape(p, in.end(), cls, colon);
+                std::memcpy(o, p, static_cast<std::size_t>(run_end - p));
+                o += run_end - p;
+                p = run_end;
+                if (p == in.end()) break;
+
+                unsigned char c = static_cast<unsigned char>(*p++);
+                *o++ = '%';
+                *o++ = hex_digit(c >> 4);
+                *o++ = hex_digit(c);
+            }
+
+            return static_cast<std::size_t>(o - out);
+        }
+
+        /**
+         * @brief Decodes [in, in + size) into out, which may alias in; malformed escapes are copied as is
+         * 
+         * Runs without '%' (or '+' when plus_as_space) are found with find_first and copied in one go.
+         * 
+         * @return std::size_t number of bytes written
+         */
+        inline std::size_t decode_into(const char* in, std::size_t size, char* out, bool plus_as_space) {
+            const char* p = in;
+            const char* end = in + size;
+            char* o = out;
+            ByteClass escapes = plus_as_space ? ByteClass{{'%', '+', '%', '+'}, false} : ByteClass{{'%', '%', '%', '%'}, false};
+
+            while (p < end) {
+                const char* run_end = find_first(p, end, escapes);
+                if (o != p) std::memmove(o, p, static_cast<std::size_t>(run_end - p));
+                o += run_end - p;
+                p = run_end;
+                if (p == end) break;
+
+                if (*p == '+') {
+                    *o++ = ' ';
+                    ++p;
+                    continue;
+                }
+
+                int high = end - p >= 3 ? hex_value(p[1]) : -1;
+                int low = high >= 0 ? hex_value(p[2]) : -1;
+                if (low >= 0) {
+                    *o++ = static_cast<char>((high << 4) | low);
+                    p += 3;
+                } else {
+                    *o++ = *p++;
+                }
+            }
+
+            return static_cast<std::size_t>(o - out);
+        }
+    }
+
+    /**
+     * @brief Get the number of bytes percent_encode writes for the given input
+     * 
+     * @param in raw characters
+     * @param set component the characters are encoded for
+     * @return std::size_t size of the encoded output
+     */
+    inline std::size_t percent_encoded_size(StringView in, encode_set set) {
+        return detail::encoded_size(in, detail::encode_class(set), detail::encodes_colon(set));
+    }
+
+    /**
+     * @brief Percent-encode characters into a caller-provided buffer
+     * 
+     * @param in raw characters
+     * @param set component the characters are encoded for
+     * @param out output buffer of at least percent_encoded_size(in, set) bytes
+     * @return std::size_t number of bytes written
+     */
+    inline std::size_t percent_encode(StringView in, encode_set set, char* out) {
+        return detail::encode_into(in, detail::encode_class(set), out, detail::encodes_colon(set));
+    }
+
+    /**
+     * @brief Percent-encode characters and append them to a string
+     * 
+     * @param in raw characters
+     * @param set component the characters are encoded for
+     * @param out string the encoded characters are appended to
+     */
+    inline void percent_encode(StringView in, encode_set set, std::string& out) {
+        std::size_t old_size = out.size();
+        out.resize(old_size + percent_encoded_size(in, set));
+        percent_encode(in, set, &out[0] + old_size);
+    }
+
+    /**
+     * @brief Percent-encode characters
+     * 
+     * @param in raw characters
+     * @param set component the characters are encoded for
+     * @return std::string encoded characters
+     */
+    inline std::string percent_encode(StringView in, encode_set set) {
+        std::string out;
+        percent_encode(in, set, out);
+        return out;
+    }
 
-                    if(!isValidAuthority) {
-                        throw std::invalid_argument("The authority component of href is not valid");
-                    }
+    /**
+     * @brief Percent-decode characters into a caller-provided buffer
+     * 
+     * Escapes that are not followed by two hex digits are copied as is.
+     * 
+     * @param in encoded characters
+     * @param out output buffer of at least in.size() bytes; may be in.data() itself
+     * @param plus_as_space also decode '+' to a space, as in form-encoded queries; default false
+     * @return std::size_t number of bytes written
+     */
+    inline std::size_t percent_decode(StringView in, char* out, bool plus_as_space = false) {
+        return detail::decode_into(in.data(), in.size(), out, plus_as_space);
+    }
 
-                    std::string userMatch = authority_groups[2].str();
-                    if (!userMatch.empty()) {
-                        authority_components_map[authority_components::username] = userMatch;
-                        has_username = true;
-                    }
-                    
-                    std::string passMatch = authority_groups[4].str();
-                    if (!passMatch.empty()) {
-                        authority_components_map[authority_components::password] = passMatch;
-                        has_password = true;
-                    }
+    /**
+     * @brief Percent-decode a buffer in place
+     * 
+     * @param data encoded characters, overwritten with the decoded ones
+     * @param size number of characters
+     * @param plus_as_space also decode '+' to a space, as in form-encoded queries; default false
+     * @return std::size_t decoded size
+     */
+    inline std::size_t percent_decode_inplace(char* data, std::size_t size, bool plus_as_space = false) {
+        return detail::decode_into(data, size, data, plus_as_space);
+    }
 
-                    std::string hostMatch = authority_groups[5].str();
-                    authority_components_map[authority_components::host] = hostMatch;
-                    if(authority_components_map[authority_components::host][0] == '[') isIPv6Host = true;
+    /**
+     * @brief Percent-decode a string in place
+     * 
+     * @param str encoded characters, replaced by the decoded ones
+     * @param plus_as_space also decode '+' to a space, as in form-encoded queries; default false
+     */
+    inline void percent_decode_inplace(std::string& str, bool plus_as_space = false) {
+        if (str.empty()) return;
+        str.resize(detail::decode_into(&str[0], str.size(), &str[0], plus_as_space));
+    }
 
-                    std::string portMatch = authority_groups[7].str();
-                    if (!portMatch.empty()) {
-                        authority_components_map[authority_components::port] = portMatch;
-                        has_port = true;
-                    }
-                }
-            } else {
-                is_absolute_uri = false;
-                is_relative_uri = std::regex_match(href, uri_groups, relative_uri_regex);
+    /**
+     * @brief Percent-decode characters
+     * 
+     * @param in encoded characters
+     * @param plus_as_space also decode '+' to a space, as in form-encoded queries; default false
+     * @return std::string decoded characters
+     */
+    inline std::string percent_decode(StringView in, bool plus_as_space = false) {
+        std::string out(in.str());
+        percent_decode_inplace(out, plus_as_space);
+        return out;
+    }
 
-                if(!is_relative_uri) {
-                    throw std::invalid_argument("The provided href is not a valid absolute or relative URI");
-                }   
+    namespace detail {
+        /**
+         * @brief Reads one decoded byte from an encoded range and advances p past it
+         * 
+         * Malformed escapes are passed through as is, as decode_into does.
+         */
+        inline char decode_next(const char*& p, const char* end, bool plus_as_space) {
+            char c = *p++;
+            if (c == '+' && plus_as_space) return ' ';
+            if (c != '%' || end - p < 2) return c;
 
-                std::string pathMatch = uri_groups[1].str();
-                if (!pathMatch.empty()) {
-                    relative_uri_components_map[relative_uri_components::path] = pathMatch;
-                }
+            int high = hex_value(p[0]);
+            int low = high >= 0 ? hex_value(p[1]) : -1;
+            if (low < 0) return c;
 
-                std::string queryMatch = uri_groups[2].str();
-                if (!queryMatch.empty()) {
-                    relative_uri_components_map[relative_uri_components::query] = queryMatch;
-                    has_query = true;
-                }
+            p += 2;
+            return static_cast<char>((high << 4) | low);
+        }
 
-                std::string fragmentMatch = uri_groups[3].str();
-                if (!fragmentMatch.empty()) {
-                    relative_uri_components_map[relative_uri_components::fragment] = fragmentMatch;
-                    has_fragment = true;
-                }
+        /**
+         * @brief Compares a form-encoded range with raw or form-encoded characters without decoding into a buffer
+         * 
+         */
+        inline bool decoded_equals(StringView encoded, StringView other, bool other_encoded) {
+            if (!other_encoded && other.size() > encoded.size()) return false;
+
+            const char* p = encoded.begin();
+            const char* q = other.begin();
+            while (p < encoded.end()) {
+                if (q == other.end()) return false;
+                char c = other_encoded ? decode_next(q, other.end(), true) : *q++;
+                if (decode_next(p, encoded.end(), true) != c) return false;
             }
+            return q == other.end();
         }
 
-        Uri(const Uri& other) {
-            Uri(other.href);
+        inline std::uint32_t hash_byte(std::uint32_t hash, char c) {
+            return (hash ^ static_cast<unsigned char>(c)) * 16777619u;
         }
 
         /**
-         * @brief Get the Href string
+         * @brief FNV-1a hash of a key, decoding it first when decode is set
          * 
-         * @return const std::string
          */
-        const std::string getHref() {
-            return href;
+        inline std::uint32_t hash_key(StringView key, bool decode) {
+            std::uint32_t hash = 2166136261u;
+            const char* p = key.begin();
+            while (p < key.end()) hash = hash_byte(hash, decode ? decode_next(p, key.end(), true) : *p++);
+            return hash;
         }
+    }
+
+    /**
+     * @brief A single key[=value] pair of a query, viewed in place
+     * 
+     */
+    class QueryParameter {
+        public:
+        QueryParameter() : has_value(false) {}
+
+        QueryParameter(StringView key, StringView value, bool has_value) : key(key), value(value), has_value(has_value) {}
 
         /**
-         * @brief Get the Scheme component of absolute URI
+         * @brief Get the key, as written in the query
          * 
-         * @return const std::string Scheme component
-         * @throws std::domain_error if a relative URI
+         * @return StringView
          */
-        const std::string getScheme() {
-            if(is_relative_uri) throw std::domain_error("Cannot use with relative URI");
-            return uri_components_map[absolute_uri_components::scheme];
-
+        StringView getKey() const {
+            return key;
         }
 
         /**
-         * @brief Get the Authority component of absolute URI
+         * @brief Get the value, as written in the query
          * 
-         * @return const std::string Authority component
-         * @throws std::domain_error if a relative URI
+         * @return StringView value if the pair has a '='; otherwise an empty view
          */
-        const std::string getAuthority() {
-            if(has_authority) 
-                return uri_components_map[absolute_uri_components::authority];
-            else 
-                throw std::domain_error("Cannot get authority of a relative URI");
+        StringView getValue() const {
+            return value;
         }
 
         /**
-         * @brief Get the Path object
+         * @brief Indicates if the pair has a '=', distinguishing "key=" from "key"
          * 
-         * @return const std::string 
+         * @return true if a value is present
          */
-        const std::string getPath() {
-            if (is_absolute_uri) {
-                return uri_components_map[absolute_uri_components::path];
-            } else if (is_relative_uri) {
-                return relative_uri_components_map[relative_uri_components::path];
-            }
-
-            return "";
+        bool hasValue() const {
+            return has_value;
         }
 
         /**
-         * @brief Get the Query component of the absolute or relative URI
+         * @brief Percent-decode the key into a caller-provided buffer
          * 
-         * @return const std::string the Query component if available; otherwise an empty string
+         * @param out output buffer of at least getKey().size() characters
+         * @param plus_as_space also decode '+' to a space; default true
+         * @return std::size_t decoded size
          */
-        const std::string getQuery() {
-            if (is_absolute_uri && has_query) {
-                return uri_components_map[absolute_uri_components::query];
-            } else if (is_relative_uri && has_query) {
-                return relative_uri_components_map[relative_uri_components::query];
-            } else {
-                return "";
-            }
+        std::size_t decodeKey(char* out, bool plus_as_space = true) const {
+            return percent_decode(key, out, plus_as_space);
         }
 
         /**
-         * @brief Get the Fragment component of the absolute or relative URI 
+         * @brief Percent-decode the value into a caller-provided buffer
          * 
-         * @return const std::string the Fragment component if available; otherwise an empty string
+         * @param out output buffer of at least getValue().size() characters
+         * @param plus_as_space also decode '+' to a space; default true
+         * @return std::size_t decoded size
          */
-        const std::string getFragment() {
-            if (is_absolute_uri && has_fragment) {
-                return uri_components_map[absolute_uri_components::fragment];
-            } else if (is_relative_uri && has_fragment) {
-                return relative_uri_components_map[relative_uri_components::fragment];
-            } else {
-                return "";
-            }
+        std::size_t decodeValue(char* out, bool plus_as_space = true) const {
+            return percent_decode(value, out, plus_as_space);
         }
 
         /**
-         * @brief Get a map containing all components of the absolute URI
+         * @brief Percent-decode the key
          * 
-         * @return std::map<absolute_uri_components, std::string>* a mapping from component ID to its string
-         * @throws std::domain_error if URI is relative
+         * @param plus_as_space also decode '+' to a space; default true
+         * @return std::string decoded key
          */
-        std::map<absolute_uri_components, std::string>* getURIComponents() {
-            if(is_absolute_uri) {
-                return &uri_components_map;
-            }
-            
-            throw std::domain_error("Cannot use with relative URI");
+        std::string decodeKey(bool plus_as_space = true) const {
+            return percent_decode(key, plus_as_space);
         }
 
         /**
-         * @brief  Get a map containing all components of the relative URI
+         * @brief Percent-decode the value
          * 
-         * @return std::map<relative_uri_components, std::string>*  a mapping from component ID to its string
-         * @throws std::domain_error if URI is absolute
+         * @param plus_as_space also decode '+' to a space; default true
+         * @return std::string decoded value
          */
-        std::map<relative_uri_components, std::string>* getRelativeURIComponents() {
-            if(is_relative_uri) {
-                return &relative_uri_components_map;
-            } else {
-                throw std::domain_error("Cannot use with absolute URI");
-            };
+        std::string decodeValue(bool plus_as_space = true) const {
+            return percent_decode(value, plus_as_space);
         }
 
+        private:
+        StringView key;
+        StringView value;
+        bool has_value;
+    };
+
+    /**
+     * @brief A lazy, non-owning view over the key[=value] pairs of a query
+     * 
+     * Pairs are split on demand while iterating, so no storage is allocated. Empty pairs are skipped. The viewed
+     * characters must outlive the view.
+     */
+    class QueryView {
+        public:
+        class iterator {
+            public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef QueryParameter value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const QueryParameter* pointer;
+            typedef const QueryParameter& reference;
+
+            iterator() : next(nullptr), end(nullptr), separators() {}
+
+            reference operator*() const { return current; }
+            pointer operator->() const { return &current; }
+
+            iterator& operator++() {
+                advance();
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator it = *this;
+                advance();
+                return it;
+            }
+
+            bool operator==(const iterator& other) const { return current.getKey().data() == other.current.getKey().data(); }
+            bool operator!=(const iterator& other) const { return !(*this == other); }
+
+            private:
+            friend class QueryView;
+
+            iterator(const char* begin, const char* end, detail::ByteClass separators) : next(begin), end(end), separators(separators) {
+                advance();
+            }
+
+            void advance() {
+                while (next < end) {
+                    const char* pair_end = detail::find_first(next, end, separators);
+                    const char* pair_begin = next;
+                    next = pair_end == end ? end : pair_end + 1;
+                    if (pair_end == pair_begin) continue;
+
+                    std::size_t size = static_cast<std::size_t>(pair_end - pair_begin);
+                    const char* equals = static_cast<const char*>(std::memchr(pair_begin, '=', size));
+                    if (equals) {
+                        current = QueryParameter(StringView(pair_begin, static_cast<std::size_t>(equals - pair_begin)),
+                                                 StringView(equals + 1, static_cast<std::size_t>(pair_end - equals - 1)), true);
+                    } else {
+                        current = QueryParameter(StringView(pair_begin, size), StringView(), false);
+                    }
+                    return;
+                }
+                current = QueryParameter();
+            }
+
+            const char* next;
+            const char* end;
+            detail::ByteClass separators;
+            QueryParameter current;
+        };
+
+        typedef iterator const_iterator;
+
         /**
-         * @brief Get the Username component of the Authority component
+         * @brief Construct a new QueryView object
          * 
-         * @return const std::string Username component if available; otherwise an empty string
-         * @throws std::domain_error if URI is relative
+         * @param query query component without its leading '?'; a '?' it starts with is part of the first key
+         * @param separators one to four characters that separate pairs, e.g. "&;" or the query_delimiter of the builder; default "&"
+         * @param decode match keys in get(), contains() and find() after percent-decoding them, '+' included; default false
+         * @throws std::invalid_argument if separators is empty or longer than four characters
          */
-        const std::string getUsername() {
-            if(is_relative_uri) throw std::domain_error("Cannot use with relative URI");
-
-            if(has_username) 
-                return authority_components_map[authority_components::username];
-            else 
-                return "";
+        explicit QueryView(StringView query, StringView separators = "&", bool decode = false) : query(query), decode(decode) {
+            init(separators);
         }
 
         /**
-         * @brief Get the Password component of the Authority component
+         * @brief Construct a new QueryView object over the query of a parsed URI
          * 
-         * @return const std::string Password component if available; otherwise an empty string
-         * @throws std::domain_error if URI is relative
+         * The leading '?' that the query of a relative URI keeps is skipped, so "/p??x=1" and "http://h/p??x=1" both have
+         * the key "?x".
+         * 
+         * @param uri parsed URI; its href must outlive the view
+         * @param separators one to four characters that separate pairs, e.g. "&;" or the query_delimiter of the builder; default "&"
+         * @param decode match keys in get(), contains() and find() after percent-decoding them, '+' included; default false
+         * @throws std::invalid_argument if separators is empty or longer than four characters
          */
-        const std::string getPassword() {
-            if(is_relative_uri) throw std::domain_error("Cannot use with relative URI");
+        explicit QueryView(const UriView& uri, StringView separators = "&", bool decode = false) : query(uri.getQuery()), decode(decode) {
+            if (uri.isRelativeUri() && !query.empty() && query[0] == '?') query = query.substr(1);
+            init(separators);
+        }
 
-            if(has_password) 
-                return authority_components_map[authority_components::password];
-            else 
-                return "";
+        iterator begin() const {
+            return iterator(query.begin(), query.end(), separators);
+        }
+
+        iterator end() const {
+            return iterator();
         }
 
         /**
-         * @brief Get the Host component of the Authority component
+         * @brief Indicates if the query has no pairs
          * 
-         * @return const std::string Host component if available; otherwise an empty string
-         * @throws std::domain_error if URI is relative
+         * @return true if empty
          */
-        const std::string getHost() {
-            if(is_relative_uri) throw std::domain_error("Cannot use with relative URI");
-
-            if(has_authority) 
-                return authority_components_map[authority_components::host];
-            else 
-                return "";
+        bool empty() const {
+            return begin() == end();
         }
 
         /**
-         * @brief Get the Port component of the Authority component
+         * @brief Get the viewed query
          * 
-         * @return const std::string Port component if available; otherwise an empty string
-         * @throws std::domain_error if URI is relative
+         * @return StringView
          */
-        const std::string getPort() {
-            if(is_relative_uri) throw std::domain_error("Cannot use with relative URI");
-
-            if(has_port) 
-                return authority_components_map[authority_components::port];
-            else 
-                return "";
+        StringView getQuery() const {
+            return query;
         }
 
         /**
-         * @brief  Get a map containing all components of the relative URI
+         * @brief Indicates if keys are matched after percent-decoding
          * 
-         * @return std::map<relative_uri_components, std::string>*  a mapping from component ID to its string if available; otherwise a nullptr
-         * @throws std::domain_error if relative URI
+         * @return true if decoding
          */
-        std::map<authority_components, std::string>* getAuthorityComponents() {
-            if(is_relative_uri) throw std::domain_error("Cannot use with relative URI");
+        bool isDecoding() const {
+            return decode;
+        }
 
-            if(is_absolute_uri && has_authority) {
-                return &authority_components_map;
+        /**
+         * @brief Find the first pair with a key
+         * 
+         * @param key raw key to look for
+         * @return iterator the first matching pair; otherwise end()
+         */
+        iterator find(StringView key) const {
+            for (iterator it = begin(); it != end(); ++it) {
+                if (matches(it->getKey(), key)) return it;
             }
-            else {
-                return nullptr;
-            }    
+            return end();
         }
 
         /**
-         * @brief Indicates if absolute URI has a Authority component
+         * @brief Indicates if a key is present
          * 
-         * @return true if the absolute URI has Authority
-         * @return false if the absolute URI does not have Authority
+         * @param key raw key to look for
+         * @return true if present
          */
-        bool hasAuthority() {
-            return has_authority;
+        bool contains(StringView key) const {
+            return find(key) != end();
         }
 
         /**
-         * @brief Indicates if the relative or absolute URI has a Query component
+         * @brief Get the value of the first pair with a key
          * 
-         * @return true if the relative or absolute URI has Query 
-         * @return false if the relative or absolute URI does not have Query
+         * @param key raw key to look for
+         * @return StringView value as written in the query if present; otherwise an empty view
          */
-        bool hasQuery() {
-            return has_query;
+        StringView get(StringView key) const {
+            iterator it = find(key);
+            return it == end() ? StringView() : it->getValue();
         }
 
-
         /**
-         * @brief Indicates if the relative or absolute URI has a Fragment component
+         * @brief Compares a key as written in the query with a raw key, decoding the former if the view decodes
          * 
-         * @return true if the relative or absolute URI has Fragment 
-         * @return false if the relative or absolute URI does not have Fragment
+         * @param encoded key as written in the query
+         * @param key raw key
+         * @return true if equal
          */
-        bool hasFragment() {
-            return has_fragment;
+        bool matches(StringView encoded, StringView key) const {
+            return decode ? detail::decoded_equals(encoded, key, false) : encoded == key;
         }
-        
+
+        private:
+        void init(StringView separators) {
+            if (separators.empty() || separators.size() > 4) {
+                URIPP_THROW(std::invalid_argument("A query view takes one to four separator characters"));
+            }
+            for (std::size_t i = 0; i < 4; ++i) {
+                this->separators.delimiters[i] = separators[i < separators.size() ? i : 0];
+            }
+            this->separators.invalid = false;
+        }
+
+        StringView query;
+        detail::ByteClass separators;
+        bool decode;
+    };
+
+    /**
+     * @brief A flat hash index over the pairs of a QueryView, for repeated lookups
+     * 
+     * Building the index walks the query once and allocates two arrays; lookups then hash the key and probe an
+     * open-addressing table instead of rescanning the query. When a key repeats, the first pair wins, as in QueryView.
+     * The index borrows the characters of the query, which must outlive it.
+     */
+    class QueryIndex {
+        public:
         /**
-         * @brief Indicates if the URI has a username in the Authority component
+         * @brief Construct a new QueryIndex object
          * 
-         * @return true if Authority component contains username
-         * @return false if Authority component does not contains username
+         * @param query pairs to index; keys are hashed and matched the way query matches them
          */
-        bool hasUsername() {
-            return has_username;
+        explicit QueryIndex(const QueryView& query) : query(query) {
+            for (QueryView::iterator it = query.begin(); it != query.end(); ++it) entries.push_back(Entry{*it, 0});
+
+            std::size_t capacity = 8;
+            while (capacity < entries.size() * 2) capacity <<= 1;
+            slots.assign(capacity, 0);
+            mask = static_cast<std::uint32_t>(capacity - 1);
+
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                entries[i].hash = detail::hash_key(entries[i].parameter.getKey(), query.isDecoding());
+
+                std::uint32_t slot = entries[i].hash & mask;
+                for (;; slot = (slot + 1) & mask) {
+                    if (slots[slot] == 0) {
+                        slots[slot] = static_cast<std::uint32_t>(i + 1);
+                        break;
+                    }
+                    const Entry& other = entries[slots[slot] - 1];
+                    if (other.hash == entries[i].hash && sameKey(other.parameter.getKey(), entries[i].parameter.getKey())) break;
+                }
+            }
         }
 
         /**
-         * @brief Indicates if the URI has a password in the Authority component
+         * @brief Get the number of indexed pairs, repeated keys included
          * 
-         * @return true if Authority component contains password
-         * @return false if Authority component does not contains password
+         * @return std::size_t
          */
-        bool hasPassword() {
-            return has_password;
+        std::size_t size() const {
+            return entries.size();
         }
 
         /**
-         * @brief Indicates if the URI has a port in the Authority component 
+         * @brief Find the first pair with a key
          * 
-         * @return true if Authority component contains port
-         * @return false if Authority component does not contains port
+         * @param key raw key to look for
+         * @return const QueryParameter* the first matching pair if present; otherwise nullptr
          */
-        bool hasPort() {
-            return has_port;
+        const QueryParameter* find(StringView key) const {
+            std::uint32_t hash = detail::hash_key(key, false);
+
+            for (std::uint32_t slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+                const Entry& entry = entries[slots[slot] - 1];
+                if (entry.hash == hash && query.matches(entry.parameter.getKey(), key)) return &entry.parameter;
+            }
+            return nullptr;
         }
 
         /**
-         * @brief Indicates if the URI is relative
+         * @brief Indicates if a key is present
          * 
-         * @return true if relative URI
-         * @return false if absolute URI
+         * @param key raw key to look for
+         * @return true if present
          */
-        bool isRelativeUri() {
-            return is_relative_uri;
+        bool contains(StringView key) const {
+            return find(key) != nullptr;
         }
 
         /**
-         * @brief << Operator overload
+         * @brief Get the value of the first pair with a key
          * 
-         * @param os output stream
-         * @param uri Uri object
-         * @return std::ostream& output stream with added href
+         * @param key raw key to look for
+         * @return StringView value as written in the query if present; otherwise an empty view
          */
-        friend std::ostream& operator<<(std::ostream& os, const Uri& uri) { 
-            os << uri.href;
-            return os;
+        StringView get(StringView key) const {
+            const QueryParameter* parameter = find(key);
+            return parameter ? parameter->getValue() : StringView();
         }
 
         private:
-        Uri() {
+        struct Entry {
+            QueryParameter parameter;
+            std::uint32_t hash;
+        };
 
+        bool sameKey(StringView a, StringView b) const {
+            return query.isDecoding() ? detail::decoded_equals(a, b, true) : a == b;
         }
 
-        std::string href = "";
-
-        std::regex uri_regex = std::regex("^(([^:/?#]+):)?(\\/\\/([^/?#]*))?([^?#]*)(\\?([^#]*))?(#(.*))?", std::regex_constants::ECMAScript);
-
-        std::regex authority_regex = std::regex("^(([^@]+)(:([^@]+))@)?(\\[[^\\]]+\\]|[^:\\[\\]]+)(:(\\d+))?$", std::regex_constants::ECMAScript);
-
-        std::regex relative_uri_regex = std::regex("^((?:\\/\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*)(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*))*)|(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]+(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*))*))|(?:[A-Za-z0-9\\-._~%!$&'()*+,;=@]+(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*))*))?(\\?[A-Za-z0-9\\-._~%!$&'()*+,;=:@\\/\\?]*)?(\\#[A-Za-z0-9\\-._~%!$&'()*+,;=:@\\/\\?]*)?$");
-
-        std::map<absolute_uri_components, std::string> uri_components_map = {{absolute_uri_components::scheme, ""}, {absolute_uri_components::path, ""}};
-        std::map<authority_components, std::string> authority_components_map;
-        std::map<relative_uri_components, std::string> relative_uri_components_map;
-
-        bool is_absolute_uri = false;
-        bool is_relative_uri = false;
-
-        bool has_authority = false;
-        bool has_query = false;
-        bool has_fragment = false;
-
-        bool isIPv6Host = false;
-        bool has_username = false;
-        bool has_password = false;
-        bool has_port = false;
+        QueryView query;
+        std::vector<Entry> entries;
+        std::vector<std::uint32_t> slots;
+        std::uint32_t mask;
     };
 
     /**
@@ -539,6 +3589,19 @@ namespace uripp {
         bool is_hierarchical = true;
         char non_hierarchical_delimiter = ':';
         char query_delimiter = ',';
+
+        /**
+         * @brief key=value pairs written after query, each pair separated from the previous one and from a non-empty
+         * query by query_delimiter
+         * 
+         */
+        std::vector<std::pair<std::string, std::string>> query_parameters;
+
+        /**
+         * @brief Percent-encode username, password, path, query and fragment while building; default false
+         * 
+         */
+        bool encode_components = false;
     };
 
     /**
@@ -566,11 +3629,14 @@ namespace uripp {
                 } else {
                     // Construct Authority out of components
                     std::string authority = "";
-                    authority += config.username;
-                    authority += authority.empty() ? ":"+config.password : ""; // add password only if username is available
-                    authority += authority.empty() ? "@" : "";
+                    append(authority, config.username, encode_set::userinfo_field, config.encode_components);
+                    if (!authority.empty() && !config.password.empty()) { // add password only if username is available
+                        authority += ":";
+                        append(authority, config.password, encode_set::userinfo_field, config.encode_components);
+                    }
+                    authority += authority.empty() ? "" : "@";
                     authority += config.host;
-                    authority += ":"+config.port;
+                    if (!config.port.empty()) authority += ":"+config.port;
                     href += authority;
                 }
             }
@@ -580,9 +3646,16 @@ namespace uripp {
                 href += config.is_hierarchical && !starts_with_delimiter && href[href.size()-1] != '/' ?  "/" : "";
             }
 
-            href += config.path;
-            href += "?"+config.query;
-            href += "#"+config.fragment;
+            append(href, config.path, encode_set::path, config.encode_components);
+            if (!config.query.empty() || !config.query_parameters.empty()) {
+                href += "?";
+                append(href, config.query, encode_set::query, config.encode_components);
+                appendParameters(href, config);
+            }
+            if (!config.fragment.empty()) {
+                href += "#";
+                append(href, config.fragment, encode_set::fragment, config.encode_components);
+            }
 
             std::cout << "Building URI for href: " << href << std::endl; 
 
@@ -602,5 +3675,266 @@ namespace uripp {
             UriBuilderConfig config = UriBuilderConfig(configMap, is_hierarchical, non_hierarchical_delimiter, query_delimiter);
             return build(config);
         }
+
+        /**
+         * @brief Get the exact number of characters make() and buildInto() write for a configuration
+         * 
+         * @param config configuration of Uri
+         * @return std::size_t size of the href
+         */
+        static std::size_t builtSize(const UriBuilderConfig& config) {
+            return emit<false>(config, nullptr, nullptr);
+        }
+
+        /**
+         * @brief builds a Uri object by value, without logging and without parsing the href it writes
+         * 
+         * The href is written into a string allocated once at its exact size, and the component table is recorded while
+         * writing. The authority is composed as "[username[:password]@]host[:port]" when config.authority is empty,
+         * as build() does, empty query and fragment components are left out, and a '/' is inserted before a non-empty
+         * path that does not start with one.
+         * 
+         * @param config configuration of Uri
+         * @return Uri the built Uri
+         * @throws std::invalid_argument if the components do not form a valid absolute or relative URI
+         */
+        static Uri make(const UriBuilderConfig& config) {
+            detail::href_string href(builtSize(config), '\0');
+            detail::UriParts parts;
+
+            std::size_t error_offset;
+            parse_error error = write(config, href.empty() ? nullptr : &href[0], parts, error_offset);
+            if (error != parse_error::none) detail::throw_parse_error(error);
+
+            return detail::UriAccess::make_uri(std::move(href), parts);
+        }
+
+        /**
+         * @brief builds a URI into a caller-provided buffer, as make() does, and returns a view over it
+         * 
+         * @param config configuration of Uri
+         * @param buffer output buffer of at least builtSize(config) characters; must outlive the view
+         * @return ParseResult<UriView> the built UriView, or the reason the components do not form a valid URI
+         */
+        static ParseResult<UriView> buildInto(const UriBuilderConfig& config, char* buffer) {
+            detail::UriParts parts;
+            std::size_t error_offset;
+            std::size_t size = builtSize(config);
+
+            parse_error error = write(config, buffer, parts, error_offset);
+            if (error != parse_error::none) return ParseResult<UriView>(error, error_offset);
+            return ParseResult<UriView>(detail::UriAccess::make_view(StringView(buffer, size), parts));
+        }
+
+        private:
+        static void append(std::string& href, const std::string& value, encode_set set, bool encode) {
+            if (encode) percent_encode(value, set, href);
+            else href += value;
+        }
+
+        static void appendParameters(std::string& href, const UriBuilderConfig& config) {
+            detail::ByteClass cls = parameterClass(config);
+            bool first = config.query.empty();
+
+            for (const std::pair<std::string, std::string>& parameter : config.query_parameters) {
+                if (!first) href += config.query_delimiter;
+                first = false;
+
+                std::size_t size = href.size();
+                href.resize(size + parameterSize(parameter, cls, config.encode_components));
+                writeParameter(&href[size], parameter, cls, config.encode_components);
+            }
+        }
+
+        static detail::ByteClass parameterClass(const UriBuilderConfig& config) {
+            return detail::ByteClass{{'%', config.query_delimiter, '=', '+'}, true};
+        }
+
+        static std::size_t parameterSize(const std::pair<std::string, std::string>& parameter, detail::ByteClass cls, bool encode) {
+            if (!encode) return parameter.first.size() + 1 + parameter.second.size();
+            return detail::encoded_size(parameter.first, cls) + 1 + detail::encoded_size(parameter.second, cls);
+        }
+
+        static char* writeParameter(char* out, const std::pair<std::string, std::string>& parameter, detail::ByteClass cls, bool encode) {
+            if (!encode) {
+                out = writeRaw(out, parameter.first.data(), parameter.first.size());
+                *out++ = '=';
+                return writeRaw(out, parameter.second.data(), parameter.second.size());
+            }
+            out += detail::encode_into(parameter.first, cls, out);
+            *out++ = '=';
+            return out + detail::encode_into(parameter.second, cls, out);
+        }
+
+        static std::size_t fieldSize(const std::string& value, encode_set set, bool encode) {
+            return encode ? percent_encoded_size(value, set) : value.size();
+        }
+
+        static char* writeField(char* out, const std::string& value, encode_set set, bool encode) {
+            if (encode) return out + percent_encode(value, set, out);
+            std::memcpy(out, value.data(), value.size());
+            return out + value.size();
+        }
+
+        static char* writeRaw(char* out, const char* value, std::size_t size) {
+            std::memcpy(out, value, size);
+            return out + size;
+        }
+
+        static bool clean(const std::string& value, detail::ByteClass delimiters) {
+            return detail::find_first(value.data(), value.data() + value.size(), delimiters) == value.data() + value.size();
+        }
+
+        static bool cleanParameters(const UriBuilderConfig& config) {
+            for (const std::pair<std::string, std::string>& parameter : config.query_parameters) {
+                if (!clean(parameter.first, detail::ByteClass{{'#', '#', '#', '#'}, false}) ||
+                    !clean(parameter.second, detail::ByteClass{{'#', '#', '#', '#'}, false})) return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Lays out the href of make() and buildInto(), writing it to out when Write is true
+         * 
+         * When writing, parts receives the spans of the top-level components as they are written.
+         * 
+         * @return std::size_t number of characters of the href
+         */
+        template <bool Write>
+        static std::size_t emit(const UriBuilderConfig& config, char* out, detail::UriParts* parts) {
+            bool encode = config.encode_components;
+            std::size_t size = 0;
+            char* o = out;
+
+            if (!config.scheme.empty()) {
+                if (Write) {
+                    o = writeRaw(o, config.scheme.data(), config.scheme.size());
+                    parts->set(detail::part_scheme, 0, config.scheme.size());
+                    *o++ = ':';
+                }
+                size += config.scheme.size() + 1;
+
+                if (config.is_hierarchical) {
+                    if (Write) o = writeRaw(o, "//", 2);
+                    size += 2;
+                    std::size_t authority_begin = size;
+
+                    if (!config.authority.empty()) {
+                        if (Write) o = writeRaw(o, config.authority.data(), config.authority.size());
+                        size += config.authority.size();
+                    } else {
+                        if (!config.username.empty()) {
+                            if (Write) o = writeField(o, config.username, encode_set::userinfo_field, encode);
+                            size += fieldSize(config.username, encode_set::userinfo_field, encode);
+
+                            if (!config.password.empty()) {
+                                if (Write) {
+                                    *o++ = ':';
+                                    o = writeField(o, config.password, encode_set::userinfo_field, encode);
+                                }
+                                size += 1 + fieldSize(config.password, encode_set::userinfo_field, encode);
+                            }
+
+                            if (Write) *o++ = '@';
+                            size += 1;
+                        }
+
+                        if (Write) o = writeRaw(o, config.host.data(), config.host.size());
+                        size += config.host.size();
+
+                        if (!config.port.empty()) {
+                            if (Write) {
+                                *o++ = ':';
+                                o = writeRaw(o, config.port.data(), config.port.size());
+                            }
+                            size += 1 + config.port.size();
+                        }
+                    }
+
+                    if (Write && size > authority_begin) parts->set(detail::part_authority, authority_begin, size);
+                }
+            }
+
+            std::size_t path_begin = size;
+            if (!config.scheme.empty() && config.is_hierarchical && !config.path.empty() && config.path[0] != '/') {
+                if (Write) *o++ = '/';
+                size += 1;
+            }
+            if (Write) o = writeField(o, config.path, encode_set::path, encode);
+            size += fieldSize(config.path, encode_set::path, encode);
+            if (Write) parts->set(detail::part_path, path_begin, size);
+
+            if (!config.query.empty() || !config.query_parameters.empty()) {
+                if (Write) *o++ = '?';
+                size += 1;
+                std::size_t query_begin = size;
+
+                if (Write) o = writeField(o, config.query, encode_set::query, encode);
+                size += fieldSize(config.query, encode_set::query, encode);
+
+                detail::ByteClass cls = parameterClass(config);
+                for (const std::pair<std::string, std::string>& parameter : config.query_parameters) {
+                    if (size > query_begin) {
+                        if (Write) *o++ = config.query_delimiter;
+                        size += 1;
+                    }
+                    if (Write) o = writeParameter(o, parameter, cls, encode);
+                    size += parameterSize(parameter, cls, encode);
+                }
+
+                if (Write) parts->set(detail::part_query, query_begin, size);
+            }
+
+            if (!config.fragment.empty()) {
+                if (Write) {
+                    *o++ = '#';
+                    o = writeField(o, config.fragment, encode_set::fragment, encode);
+                    parts->set(detail::part_fragment, size + 1, static_cast<std::size_t>(o - out));
+                }
+                size += 1 + fieldSize(config.fragment, encode_set::fragment, encode);
+            }
+
+            return size;
+        }
+
+        /**
+         * @brief Writes the href of make() and buildInto() to out and fills in its component table
+         * 
+         * The spans recorded while writing are used as is when the components cannot shift a delimiter, which is always
+         * the case for an absolute URI built from delimiter-free components. Otherwise, as for a relative URI, the
+         * written href is scanned.
+         */
+        static parse_error write(const UriBuilderConfig& config, char* out, detail::UriParts& parts, std::size_t& error_offset) {
+            parts = detail::UriParts();
+            error_offset = 0;
+            std::size_t size = emit<true>(config, out, &parts);
+            if (size > UINT32_MAX) {
+                error_offset = UINT32_MAX;
+                return parse_error::too_long;
+            }
+
+            bool encode = config.encode_components;
+            bool trusted = !config.scheme.empty() &&
+                           clean(config.scheme, detail::ByteClass{{':', '/', '?', '#'}, false}) &&
+                           (config.is_hierarchical || config.path.compare(0, 2, "//") != 0) &&
+                           clean(config.authority, detail::ByteClass{{'/', '?', '#', '#'}, false}) &&
+                           clean(config.host, detail::ByteClass{{'/', '?', '#', '#'}, false}) &&
+                           clean(config.port, detail::ByteClass{{'/', '?', '#', '#'}, false}) &&
+                           (config.query_parameters.empty() || config.query_delimiter != '#') &&
+                           (encode || (clean(config.username, detail::ByteClass{{'/', '?', '#', '#'}, false}) &&
+                                       clean(config.password, detail::ByteClass{{'/', '?', '#', '#'}, false}) &&
+                                       clean(config.path, detail::ByteClass{{'?', '#', '#', '#'}, false}) &&
+                                       clean(config.query, detail::ByteClass{{'#', '#', '#', '#'}, false}) &&
+                                       cleanParameters(config) &&
+                                       clean(config.fragment, detail::ByteClass{{'\n', '\r', '\n', '\r'}, false})));
+
+            if (!trusted) return detail::scan_uri(out, size, parts, error_offset);
+
+            parts.flags = static_cast<std::uint16_t>(parts.flags | detail::flag_absolute);
+            if (!parts.has(detail::part_authority)) return parse_error::none;
+
+            std::size_t authority_begin = parts.offset[detail::part_authority];
+            return detail::scan_authority(out, authority_begin, authority_begin + parts.length[detail::part_authority], parts, error_offset);
+        }
     };
 }
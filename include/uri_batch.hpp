@@ -0,0 +1,379 @@
+#pragma once
+#include "uri.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uripp {
+    /**
+     * @brief A fixed pool of worker threads that split a range of work items into chunks
+     * 
+     * Chunks are claimed from a shared atomic cursor, so a worker that finishes early keeps taking chunks
+     * until the range is exhausted. The calling thread takes part in the work, so a pool of size 1 runs everything inline.
+     */
+    class WorkerPool {
+        public:
+        /**
+         * @brief Construct a new WorkerPool
+         * 
+         * @param threads total number of threads taking part in the work, including the caller; 0 uses std::thread::hardware_concurrency()
+         */
+        explicit WorkerPool(unsigned threads = 0) {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+            for (unsigned i = 1; i < threads; ++i) {
+                workers.emplace_back([this] { workerLoop(); });
+            }
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread& worker : workers) worker.join();
+        }
+
+        /**
+         * @brief Get the number of threads taking part in the work, including the caller
+         * 
+         * @return unsigned
+         */
+        unsigned size() const {
+            return static_cast<unsigned>(workers.size()) + 1;
+        }
+
+        /**
+         * @brief Run fn over [0, count) in chunks of at most grain items and wait for all chunks to finish
+         * 
+         * @param count number of work items
+         * @param grain maximum number of items per chunk
+         * @param fn called as fn(begin, end) for every chunk; must not throw
+         */
+        void parallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& fn) {
+            if (count == 0) return;
+            if (grain == 0) grain = 1;
+
+            if (workers.empty() || count <= grain) {
+                fn(0, count);
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            job = &fn;
+            job_count = count;
+            job_grain = grain;
+            cursor.store(0, std::memory_order_relaxed);
+            active = static_cast<unsigned>(workers.size());
+            ++generation;
+            lock.unlock();
+            wake.notify_all();
+
+            runChunks(fn, count, grain);
+
+            lock.lock();
+            done.wait(lock, [this] { return active == 0; });
+            job = nullptr;
+        }
+
+        private:
+        void runChunks(const std::function<void(std::size_t, std::size_t)>& fn, std::size_t count, std::size_t grain) {
+            for (;;) {
+                std::size_t begin = cursor.fetch_add(grain, std::memory_order_relaxed);
+                if (begin >= count) return;
+                fn(begin, std::min(count, begin + grain));
+            }
+        }
+
+        void workerLoop() {
+            unsigned long long seen = 0;
+
+            for (;;) {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+                if (stopping) return;
+
+                seen = generation;
+                const std::function<void(std::size_t, std::size_t)>* fn = job;
+                std::size_t count = job_count;
+                std::size_t grain = job_grain;
+                lock.unlock();
+
+                runChunks(*fn, count, grain);
+
+                lock.lock();
+                if (--active == 0) done.notify_one();
+            }
+        }
+
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+
+        const std::function<void(std::size_t, std::size_t)>* job = nullptr;
+        std::size_t job_count = 0;
+        std::size_t job_grain = 0;
+        std::atomic<std::size_t> cursor{0};
+        unsigned active = 0;
+        unsigned long long generation = 0;
+        bool stopping = false;
+    };
+
+    /**
+     * @brief The columnar result of parse_batch: one row per input, one offset and one length column per component
+     * 
+     * Offsets are relative to the start of each input. The inputs are borrowed, not copied, and must outlive the result.
+     */
+    class BatchResult {
+        public:
+        /**
+         * @brief Get the number of rows
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return inputs.size();
+        }
+
+        /**
+         * @brief Indicates if a row was parsed
+         * 
+         * @param row row index
+         * @return true if the input was a valid absolute or relative URI
+         */
+        bool ok(std::size_t row) const {
+            return error_column[row] == parse_error::none;
+        }
+
+        /**
+         * @brief Get the reason a row was rejected
+         * 
+         * @param row row index
+         * @return parse_error parse_error::none if the row was parsed
+         */
+        parse_error getError(std::size_t row) const {
+            return error_column[row];
+        }
+
+        /**
+         * @brief Get the byte offset in the input at which a row was rejected
+         * 
+         * @param row row index
+         * @return std::size_t
+         */
+        std::size_t getErrorOffset(std::size_t row) const {
+            return error_offset_column[row];
+        }
+
+        /**
+         * @brief Get the input of a row
+         * 
+         * @param row row index
+         * @return StringView
+         */
+        StringView getHref(std::size_t row) const {
+            return inputs[row];
+        }
+
+        /**
+         * @brief Indicates if a component is present in a row
+         * 
+         * @param row row index
+         * @param comp component ID
+         * @return true if present
+         */
+        bool has(std::size_t row, uri_components comp) const {
+            return (presence_column[row] & (1u << int(comp))) != 0;
+        }
+
+        /**
+         * @brief Get a component of a row
+         * 
+         * @param row row index
+         * @param comp component ID
+         * @return StringView the component if present; otherwise an empty view
+         */
+        StringView get(std::size_t row, uri_components comp) const {
+            if (!has(row, comp)) return StringView();
+            return StringView(inputs[row].data() + offset_columns[int(comp)][row], length_columns[int(comp)][row]);
+        }
+
+        /**
+         * @brief Indicates if a parsed row is a relative URI
+         * 
+         * @param row row index
+         * @return true if relative URI
+         */
+        bool isRelativeUri(std::size_t row) const {
+            return (presence_column[row] & detail::flag_relative) != 0;
+        }
+
+        /**
+         * @brief Gather a parsed row into a UriView
+         * 
+         * @param row row index; the row must have been parsed
+         * @return UriView view over the input of the row
+         */
+        UriView view(std::size_t row) const {
+            detail::UriParts parts;
+            for (int i = 0; i < detail::part_count; ++i) {
+                parts.offset[i] = offset_columns[i][row];
+                parts.length[i] = length_columns[i][row];
+            }
+            parts.flags = presence_column[row];
+            return detail::UriAccess::make_view(inputs[row], parts);
+        }
+
+        /**
+         * @brief Get the offset column of a component
+         * 
+         * @param comp component ID
+         * @return const std::uint32_t* size() offsets, meaningful only where has() is true
+         */
+        const std::uint32_t* offsets(uri_components comp) const {
+            return offset_columns[int(comp)].data();
+        }
+
+        /**
+         * @brief Get the length column of a component
+         * 
+         * @param comp component ID
+         * @return const std::uint32_t* size() lengths, meaningful only where has() is true
+         */
+        const std::uint32_t* lengths(uri_components comp) const {
+            return length_columns[int(comp)].data();
+        }
+
+        /**
+         * @brief Get the presence column
+         * 
+         * @return const std::uint16_t* size() masks in which bit int(comp) is set if comp is present
+         */
+        const std::uint16_t* presence() const {
+            return presence_column.data();
+        }
+
+        /**
+         * @brief Get the validity column
+         * 
+         * @return const parse_error* size() errors, parse_error::none for parsed rows
+         */
+        const parse_error* errors() const {
+            return error_column.data();
+        }
+
+        private:
+        friend BatchResult parse_batch(const StringView* inputs, std::size_t count, WorkerPool& pool, std::size_t chunk_size);
+        friend BatchResult parse_batch(StringView buffer, WorkerPool& pool, std::size_t chunk_size);
+
+        void resize(std::size_t rows) {
+            for (int i = 0; i < detail::part_count; ++i) {
+                offset_columns[i].resize(rows);
+                length_columns[i].resize(rows);
+            }
+            presence_column.resize(rows);
+            error_column.resize(rows);
+            error_offset_column.resize(rows);
+        }
+
+        void parseRows(std::size_t begin, std::size_t end) {
+            detail::UriParts parts;
+            std::size_t error_offset;
+
+            for (std::size_t row = begin; row < end; ++row) {
+                parse_error error = detail::scan_uri(inputs[row].data(), inputs[row].size(), parts, error_offset);
+
+                for (int i = 0; i < detail::part_count; ++i) {
+                    offset_columns[i][row] = parts.offset[i];
+                    length_columns[i][row] = parts.length[i];
+                }
+                presence_column[row] = error == parse_error::none ? parts.flags : 0;
+                error_column[row] = error;
+                error_offset_column[row] = static_cast<std::uint32_t>(error_offset);
+            }
+        }
+
+        void parseAll(WorkerPool& pool, std::size_t chunk_size) {
+            resize(inputs.size());
+            pool.parallelFor(inputs.size(), chunk_size, [this](std::size_t begin, std::size_t end) { parseRows(begin, end); });
+        }
+
+        std::vector<StringView> inputs;
+        std::vector<std::uint32_t> offset_columns[detail::part_count];
+        std::vector<std::uint32_t> length_columns[detail::part_count];
+        std::vector<std::uint16_t> presence_column;
+        std::vector<parse_error> error_column;
+        std::vector<std::uint32_t> error_offset_column;
+    };
+
+    /**
+     * @brief Parse a span of borrowed hrefs across a worker pool into a columnar result
+     * 
+     * @param inputs first href
+     * @param count number of hrefs
+     * @param pool worker pool to parse on
+     * @param chunk_size number of hrefs claimed by a worker at a time; default 1024
+     * @return BatchResult one row per href, in input order
+     */
+    inline BatchResult parse_batch(const StringView* inputs, std::size_t count, WorkerPool& pool, std::size_t chunk_size = 1024) {
+        BatchResult result;
+        result.inputs.assign(inputs, inputs + count);
+        result.parseAll(pool, chunk_size);
+        return result;
+    }
+
+    /**
+     * @brief Parse a newline-delimited buffer across a worker pool into a columnar result
+     * 
+     * Lines may end in "\n" or "\r\n"; a final line without a terminator is parsed, a trailing empty line is not.
+     * 
+     * @param buffer newline-delimited hrefs
+     * @param pool worker pool to parse on
+     * @param chunk_size number of lines claimed by a worker at a time; default 1024
+     * @return BatchResult one row per line, in buffer order
+     */
+    inline BatchResult parse_batch(StringView buffer, WorkerPool& pool, std::size_t chunk_size = 1024) {
+        BatchResult result;
+        const char* p = buffer.begin();
+        const char* end = buffer.end();
+
+        while (p < end) {
+            const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+            const char* next = eol ? eol + 1 : end;
+            if (!eol) eol = end;
+            if (eol > p && eol[-1] == '\r') --eol;
+
+            result.inputs.push_back(StringView(p, static_cast<std::size_t>(eol - p)));
+            p = next;
+        }
+
+        result.parseAll(pool, chunk_size);
+        return result;
+    }
+
+    /**
+     * @brief Parse a vector of hrefs across a worker pool into a columnar result
+     * 
+     * @param inputs hrefs; must outlive the result
+     * @param pool worker pool to parse on
+     * @param chunk_size number of hrefs claimed by a worker at a time; default 1024
+     * @return BatchResult one row per href, in input order
+     */
+    inline BatchResult parse_batch(const std::vector<std::string>& inputs, WorkerPool& pool, std::size_t chunk_size = 1024) {
+        std::vector<StringView> views(inputs.begin(), inputs.end());
+        return parse_batch(views.data(), views.size(), pool, chunk_size);
+    }
+}
@@ -0,0 +1,354 @@
+#pragma once
+#include "uri.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace uripp {
+    /**
+     * @brief What a HostMatcher rule matches
+     * 
+     */
+    enum class host_rule {
+        /**
+         * @brief The host itself only
+         */
+        exact,
+
+        /**
+         * @brief The host and every subdomain of it; IP literals are only matched exactly
+         */
+        with_subdomains
+    };
+
+    namespace detail {
+        inline void prefetch(const void* p) {
+#if defined(__GNUC__)
+            __builtin_prefetch(p);
+#elif defined(URIPP_SIMD_SSE2)
+            _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+            (void)p;
+#endif
+        }
+
+        /**
+         * @brief One step of the right-to-left FNV-1a hash HostMatcher gives every label-aligned suffix of a host
+         * 
+         */
+        inline std::uint32_t suffix_hash_step(std::uint32_t hash, char c) {
+            return (hash ^ static_cast<unsigned char>(to_lower(c))) * 16777619u;
+        }
+    }
+
+    /**
+     * @brief A set of host rules, e.g. a block or allow list, compiled for matching hosts by their label-aligned suffixes
+     * 
+     * Every rule is stored once, lowercased, in a table keyed by a hash computed from the right of the host. Matching
+     * walks a host from its last character to its first, extending that hash one character at a time, and probes the
+     * table only where a label starts, so a host with n labels costs n probes however many rules there are. The longest
+     * matching rule wins, and for the whole host an exact rule wins over a with_subdomains one. Names are compared
+     * case-insensitively and without one trailing '.'. IPv4 and bracketed IPv6 literals are only matched as a whole.
+     */
+    class HostMatcher {
+        public:
+        /**
+         * @brief The result of a match that found no rule
+         */
+        static const std::uint32_t no_match = UINT32_MAX;
+
+        HostMatcher() : slots(64, Slot{0, no_match}) {}
+
+        /**
+         * @brief Add a rule
+         * 
+         * A rule for a host and kind that is already present replaces it. A host written with a leading '.', as block
+         * lists write a domain and its subdomains, is added without it as a with_subdomains rule, and a rule for an IP
+         * literal is always added as exact.
+         * 
+         * @param host host name, IPv4 address or bracketed IPv6 address, e.g. "example.com" or "[2001:db8::1]"
+         * @param rule host_rule::exact, or host_rule::with_subdomains; default with_subdomains
+         * @return std::uint32_t rule ID returned by match()
+         * @throws std::invalid_argument if host is empty or starts with an empty label
+         */
+        std::uint32_t add(StringView host, host_rule rule = host_rule::with_subdomains) {
+            host = trim(host);
+            if (!host.empty() && host[0] == '.') {
+                host = host.substr(1);
+                rule = host_rule::with_subdomains;
+            }
+            if (host.empty() || host[0] == '.') URIPP_THROW(std::invalid_argument("A host rule must not be empty"));
+            if (isLiteral(host)) rule = host_rule::exact;
+
+            std::uint32_t hash = 2166136261u;
+            for (std::size_t i = host.size(); i-- > 0;) hash = detail::suffix_hash_step(hash, host[i]);
+
+            std::uint32_t entry = find(hash, host.data(), host.size());
+            if (entry == no_match) {
+                if ((entries.size() + 1) * 2 > slots.size()) grow();
+
+                Entry e;
+                e.text_offset = static_cast<std::uint32_t>(text.size());
+                e.text_size = static_cast<std::uint32_t>(host.size());
+                e.exact = e.with_subdomains = no_match;
+                for (std::size_t i = 0; i < host.size(); ++i) text.push_back(detail::to_lower(host[i]));
+
+                entry = static_cast<std::uint32_t>(entries.size());
+                entries.push_back(e);
+                place(Slot{hash, entry});
+            }
+
+            std::uint32_t id = static_cast<std::uint32_t>(rules.size());
+            rules.push_back(entry);
+            (rule == host_rule::exact ? entries[entry].exact : entries[entry].with_subdomains) = id;
+            return id;
+        }
+
+        /**
+         * @brief Get the number of rules added
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return rules.size();
+        }
+
+        /**
+         * @brief Get the host of a rule, lowercased and without a trailing '.'
+         * 
+         * @param rule rule ID
+         * @return StringView
+         */
+        StringView getHost(std::uint32_t rule) const {
+            const Entry& e = entries[rules[rule]];
+            return StringView(text.data() + e.text_offset, e.text_size);
+        }
+
+        /**
+         * @brief Match a host
+         * 
+         * @param host host, as returned by getHost() of Uri or UriView
+         * @return std::uint32_t ID of the most specific matching rule, or no_match
+         */
+        std::uint32_t match(StringView host) const {
+            host = trim(host);
+            if (host.empty()) return no_match;
+            return walk(host, isLiteral(host));
+        }
+
+        /**
+         * @brief Match the host of a parsed URI
+         * 
+         * @param uri parsed URI
+         * @return std::uint32_t ID of the most specific matching rule, or no_match if none matched or there is no host
+         */
+        std::uint32_t match(const UriView& uri) const {
+            StringView host = trim(uri.getHost());
+            if (host.empty()) return no_match;
+            return walk(host, uri.getHostType() != host_type::reg_name);
+        }
+
+        /**
+         * @brief Match the host of a parsed URI
+         * 
+         * @param uri parsed URI
+         * @return std::uint32_t ID of the most specific matching rule, or no_match if none matched or there is no host
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        std::uint32_t match(const Uri& uri) const {
+            return match(uri.view());
+        }
+
+        /**
+         * @brief Match many hosts at once, overlapping the table lookups of a group of hosts to hide memory latency
+         * 
+         * @param hosts first host
+         * @param count number of hosts
+         * @param out receives count rule IDs, no_match where nothing matched
+         */
+        void matchBatch(const StringView* hosts, std::size_t count, std::uint32_t* out) const {
+            Probe probes[batch_size * batch_labels];
+            std::size_t probe_count[batch_size];
+            bool literal[batch_size];
+
+            for (std::size_t begin = 0; begin < count; begin += batch_size) {
+                std::size_t group = count - begin < batch_size ? count - begin : batch_size;
+
+                for (std::size_t i = 0; i < group; ++i) {
+                    StringView host = trim(hosts[begin + i]);
+                    literal[i] = !host.empty() && isLiteral(host);
+                    probe_count[i] = collect(host, literal[i], probes + i * batch_labels);
+                }
+
+                for (std::size_t i = 0; i < group; ++i) {
+                    if (probe_count[i] == no_probes) {
+                        StringView host = trim(hosts[begin + i]);
+                        out[begin + i] = host.empty() ? no_match : walk(host, literal[i]);
+                        continue;
+                    }
+
+                    std::uint32_t result = no_match;
+                    for (std::size_t j = 0; j < probe_count[i]; ++j) {
+                        const Probe& probe = probes[i * batch_labels + j];
+                        std::uint32_t entry = find(probe.hash, probe.suffix, probe.size);
+                        if (entry == no_match) continue;
+
+                        const Entry& e = entries[entry];
+                        if (probe.whole && e.exact != no_match) result = e.exact;
+                        else if (e.with_subdomains != no_match) result = e.with_subdomains;
+                    }
+                    out[begin + i] = result;
+                }
+            }
+        }
+
+        /**
+         * @brief Match the hosts of many parsed URIs at once
+         * 
+         * @param uris first URI
+         * @param count number of URIs
+         * @param out receives count rule IDs, no_match where nothing matched or there is no host
+         */
+        void matchBatch(const UriView* uris, std::size_t count, std::uint32_t* out) const {
+            StringView hosts[batch_size];
+            for (std::size_t begin = 0; begin < count; begin += batch_size) {
+                std::size_t group = count - begin < batch_size ? count - begin : batch_size;
+                for (std::size_t i = 0; i < group; ++i) hosts[i] = uris[begin + i].getHost();
+                matchBatch(hosts, group, out + begin);
+            }
+        }
+
+        /**
+         * @brief Get the heap memory held by the matcher
+         * 
+         * @return std::size_t bytes of rule text, entries, rule IDs and hash table
+         */
+        std::size_t getMemoryUsage() const {
+            return text.capacity() + entries.capacity() * sizeof(Entry) + rules.capacity() * sizeof(std::uint32_t) +
+                   slots.capacity() * sizeof(Slot);
+        }
+
+        private:
+        static const std::size_t batch_size = 16;
+        static const std::size_t batch_labels = 8;
+        static const std::size_t no_probes = static_cast<std::size_t>(-1);
+
+        /**
+         * @brief A distinct rule host, with the rule of each kind added for it
+         * 
+         */
+        struct Entry {
+            std::uint32_t text_offset;
+            std::uint32_t text_size;
+            std::uint32_t exact;
+            std::uint32_t with_subdomains;
+        };
+
+        struct Slot {
+            std::uint32_t hash;
+            std::uint32_t entry;
+        };
+
+        struct Probe {
+            const char* suffix;
+            std::size_t size;
+            std::uint32_t hash;
+            bool whole;
+        };
+
+        static StringView trim(StringView host) {
+            if (!host.empty() && host[host.size() - 1] == '.') host = host.substr(0, host.size() - 1);
+            return host;
+        }
+
+        static bool isLiteral(StringView host) {
+            std::uint8_t address[4];
+            return host[0] == '[' || detail::decode_ipv4(host.begin(), host.end(), address);
+        }
+
+        bool sameText(const Entry& e, const char* suffix, std::size_t size) const {
+            if (e.text_size != size) return false;
+            const char* stored = text.data() + e.text_offset;
+            for (std::size_t i = 0; i < size; ++i) {
+                if (stored[i] != detail::to_lower(suffix[i])) return false;
+            }
+            return true;
+        }
+
+        std::uint32_t find(std::uint32_t hash, const char* suffix, std::size_t size) const {
+            std::size_t mask = slots.size() - 1;
+            for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+                const Slot& slot = slots[i];
+                if (slot.entry == no_match) return no_match;
+                if (slot.hash == hash && sameText(entries[slot.entry], suffix, size)) return slot.entry;
+            }
+        }
+
+        void place(const Slot& slot) {
+            std::size_t mask = slots.size() - 1;
+            std::size_t i = slot.hash & mask;
+            while (slots[i].entry != no_match) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+
+        void grow() {
+            std::vector<Slot> old;
+            old.swap(slots);
+            slots.assign(old.size() * 2, Slot{0, no_match});
+            for (const Slot& slot : old) {
+                if (slot.entry != no_match) place(slot);
+            }
+        }
+
+        std::uint32_t walk(StringView host, bool literal) const {
+            std::uint32_t result = no_match;
+            std::uint32_t hash = 2166136261u;
+
+            for (std::size_t i = host.size(); i-- > 0;) {
+                hash = detail::suffix_hash_step(hash, host[i]);
+                bool whole = i == 0;
+                if (!whole && (literal || host[i - 1] != '.')) continue;
+
+                std::uint32_t entry = find(hash, host.data() + i, host.size() - i);
+                if (entry == no_match) continue;
+
+                const Entry& e = entries[entry];
+                if (whole && e.exact != no_match) result = e.exact;
+                else if (e.with_subdomains != no_match) result = e.with_subdomains;
+            }
+            return result;
+        }
+
+        /**
+         * @brief Computes the probes of a host and prefetches their first slots
+         * 
+         * @return std::size_t number of probes, or no_probes if the host has more than batch_labels labels
+         */
+        std::size_t collect(StringView host, bool literal, Probe* probes) const {
+            if (host.empty()) return 0;
+
+            std::size_t n = 0;
+            std::uint32_t hash = 2166136261u;
+            std::size_t mask = slots.size() - 1;
+
+            for (std::size_t i = host.size(); i-- > 0;) {
+                hash = detail::suffix_hash_step(hash, host[i]);
+                bool whole = i == 0;
+                if (!whole && (literal || host[i - 1] != '.')) continue;
+                if (n == batch_labels) return no_probes;
+
+                probes[n] = Probe{host.data() + i, host.size() - i, hash, whole};
+                detail::prefetch(&slots[hash & mask]);
+                ++n;
+            }
+            return n;
+        }
+
+        std::string text;
+        std::vector<Entry> entries;
+        std::vector<std::uint32_t> rules;
+        std::vector<Slot> slots;
+    };
+}
@@ -0,0 +1,557 @@
+#pragma once
+#include "uri.hpp"
+#include "uri_batch.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uripp {
+    namespace detail {
+        /**
+         * @brief Separates the reversed host from the href in an index key; below every host character
+         * 
+         */
+        const char index_separator = '\x01';
+
+        /**
+         * @brief Finds where the host of an href would start, and where its authority ends, without validating them
+         * 
+         * @return true if the href has a "scheme://" authority
+         */
+        inline bool index_authority(StringView href, std::size_t& host_begin, std::size_t& authority_end) {
+            const char* s = href.data();
+            std::size_t n = href.size();
+
+            std::size_t i = scan_to(s, 0, n, ByteClass{{':', '/', '?', '#'}, false});
+            if (i == 0 || i == n || s[i] != ':' || n - i < 3 || s[i + 1] != '/' || s[i + 2] != '/') return false;
+
+            host_begin = i + 3;
+            authority_end = scan_to(s, host_begin, n, ByteClass{{'/', '?', '#', '#'}, false});
+            std::size_t at = scan_to(s, host_begin, authority_end, ByteClass{{'@', '@', '@', '@'}, false});
+            if (at < authority_end) host_begin = at + 1;
+            return true;
+        }
+
+        /**
+         * @brief Finds the host of an href, or of an href prefix that holds the whole host, without validating it
+         * 
+         * @return StringView the host, viewing href; empty for a relative URI or an absolute URI without an authority
+         */
+        inline StringView index_host(StringView href) {
+            std::size_t begin, end;
+            if (!index_authority(href, begin, end)) return StringView();
+
+            std::size_t host_end = begin;
+            if (host_end < end && href[host_end] == '[') {
+                while (host_end < end && href[host_end] != ']') ++host_end;
+                if (host_end < end) ++host_end;
+            } else {
+                while (host_end < end && href[host_end] != ':') ++host_end;
+            }
+            return StringView(href.data() + begin, host_end - begin);
+        }
+
+        /**
+         * @brief Writes a host with its labels in reverse order, "docs.example.com" as "com.example.docs"; an IP-literal as is
+         * 
+         * Reversing twice gives the host back.
+         * 
+         * @return char* end of the written host
+         */
+        inline char* write_reversed_host(StringView host, char* out) {
+            if (!host.empty() && host[0] == '[') {
+                std::memcpy(out, host.data(), host.size());
+                return out + host.size();
+            }
+
+            const char* end = host.end();
+            while (end > host.begin()) {
+                const char* label = end;
+                while (label > host.begin() && label[-1] != '.') --label;
+                std::memcpy(out, label, static_cast<std::size_t>(end - label));
+                out += end - label;
+                if (label == host.begin()) break;
+                *out++ = '.';
+                end = label - 1;
+            }
+            return out;
+        }
+
+        /**
+         * @brief Get the maximum size of the index key of an href
+         * 
+         */
+        inline std::size_t index_key_size(StringView href) {
+            return href.size() + 2;
+        }
+
+        /**
+         * @brief Writes the index key of an href: its reversed host and the separator, then the href with the separator in place of the host
+         * 
+         * "https://u@docs.example.com/a" becomes "com.example.docs" "\x01" "https://u@" "\x01" "/a", so the URIs of a domain
+         * and of its subdomains sort together and front coding stores the host once per block. The separator left in
+         * place of the host keeps a prefix without userinfo from matching an href with userinfo.
+         * 
+         * @param out output buffer of at least index_key_size() characters
+         * @return std::size_t number of characters written
+         */
+        inline std::size_t write_index_key(StringView href, char* out) {
+            StringView host = index_host(href);
+            char* p = write_reversed_host(host, out);
+            *p++ = index_separator;
+            if (host.empty()) {
+                if (!href.empty()) std::memcpy(p, href.data(), href.size());
+                return static_cast<std::size_t>(p - out) + href.size();
+            }
+
+            std::size_t host_begin = static_cast<std::size_t>(host.data() - href.data());
+            std::memcpy(p, href.data(), host_begin);
+            p += host_begin;
+            *p++ = index_separator;
+            std::size_t rest = href.size() - host_begin - host.size();
+            if (rest) std::memcpy(p, host.end(), rest);
+            return static_cast<std::size_t>(p - out) + rest;
+        }
+
+        /**
+         * @brief Writes the href an index key was made from
+         * 
+         * @param out output buffer of at least key.size() characters
+         * @return std::size_t number of characters written
+         */
+        inline std::size_t read_index_key(StringView key, char* out) {
+            std::size_t separator = static_cast<std::size_t>(std::find(key.begin(), key.end(), index_separator) - key.begin());
+            StringView host = key.substr(0, separator);
+            StringView rest = key.substr(separator + 1);
+            if (host.empty()) {
+                if (!rest.empty()) std::memcpy(out, rest.data(), rest.size());
+                return rest.size();
+            }
+
+            // the path of an absolute URI may hold the separator too, but only after the one in place of the host
+            std::size_t host_begin = static_cast<std::size_t>(std::find(rest.begin(), rest.end(), index_separator) - rest.begin());
+            std::memcpy(out, rest.data(), host_begin);
+            char* p = write_reversed_host(host, out + host_begin);
+            if (rest.size() > host_begin + 1) std::memcpy(p, rest.data() + host_begin + 1, rest.size() - host_begin - 1);
+            return key.size() - 2;
+        }
+
+        /**
+         * @brief Scratch characters for a query, on the stack until they outgrow it
+         * 
+         * 2 KiB holds the keys of hrefs up to the length browsers and servers commonly accept.
+         */
+        class ScratchBuffer {
+            public:
+            ScratchBuffer() : data(stack), capacity(sizeof(stack)) {}
+
+            ScratchBuffer(const ScratchBuffer&) = delete;
+            ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+            /**
+             * @brief Get the buffer, grown to at least size characters if needed
+             * 
+             * @param kept number of leading characters a move to the heap keeps
+             */
+            char* reserve(std::size_t size, std::size_t kept = 0) {
+                if (size > capacity) {
+                    std::string grown(std::max(size, 2 * capacity), '\0');
+                    if (kept) std::memcpy(&grown[0], data, kept);
+                    heap.swap(grown);
+                    data = &heap[0];
+                    capacity = heap.size();
+                }
+                return data;
+            }
+
+            private:
+            char stack[2048];
+            std::string heap;
+            char* data;
+            std::size_t capacity;
+        };
+
+        inline bool view_less(StringView a, StringView b) {
+            std::size_t n = a.size() < b.size() ? a.size() : b.size();
+            int order = n ? std::memcmp(a.data(), b.data(), n) : 0;
+            return order < 0 || (order == 0 && a.size() < b.size());
+        }
+
+        inline bool starts_with(StringView s, StringView prefix) {
+            return s.size() >= prefix.size() && (prefix.empty() || std::memcmp(s.data(), prefix.data(), prefix.size()) == 0);
+        }
+
+        inline std::size_t varint_size(std::uint64_t value) {
+            std::size_t size = 1;
+            while (value >= 0x80) {
+                value >>= 7;
+                ++size;
+            }
+            return size;
+        }
+
+        inline char* write_varint(char* out, std::uint64_t value) {
+            while (value >= 0x80) {
+                *out++ = static_cast<char>((value & 0x7f) | 0x80);
+                value >>= 7;
+            }
+            *out++ = static_cast<char>(value);
+            return out;
+        }
+
+        inline const char* read_varint(const char* p, std::uint64_t& value) {
+            value = 0;
+            for (int shift = 0;; shift += 7) {
+                std::uint8_t byte = static_cast<std::uint8_t>(*p++);
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return p;
+            }
+        }
+    }
+
+    /**
+     * @brief Memory statistics of a UriIndex
+     * 
+     */
+    struct UriIndexStats {
+        /**
+         * @brief Number of distinct URIs held
+         */
+        std::size_t uris;
+
+        /**
+         * @brief Number of inputs that were not valid URIs, and of inputs that repeated another
+         */
+        std::size_t rejected;
+        std::size_t duplicates;
+
+        /**
+         * @brief Total size of the hrefs held
+         */
+        std::size_t href_bytes;
+
+        /**
+         * @brief Bytes of front-coded blocks
+         */
+        std::size_t encoded_bytes;
+
+        /**
+         * @brief Number of blocks, and bytes of the block directory
+         */
+        std::size_t blocks;
+        std::size_t directory_bytes;
+    };
+
+    /**
+     * @brief An immutable, compressed set of URIs sorted by reversed host, then href, with prefix and host range queries
+     * 
+     * Every URI is keyed by its host with the labels reversed, so a domain and its subdomains are contiguous, followed
+     * by the rest of its href. Keys are front-coded in blocks: the first key of a block is stored whole and every other one as the
+     * length it shares with the key before it plus the rest, all lengths as varints. A directory of block offsets is
+     * binary searched on the first keys. Results are decoded into a buffer of the query and handed out as UriViews,
+     * scanned again on the way out since no component table is stored.
+     * 
+     * Hosts and hrefs are compared as written, without normalization.
+     */
+    class UriIndex {
+        public:
+        /**
+         * @brief The default number of keys per block
+         */
+        static const std::size_t default_block_size = 16;
+
+        /**
+         * @brief Construct an empty UriIndex
+         * 
+         */
+        UriIndex() : block_size(default_block_size), count(0), rejected(0), duplicates(0), href_bytes(0) {}
+
+        /**
+         * @brief Build a UriIndex from a batch of hrefs across a worker pool
+         * 
+         * Hrefs are parsed, keyed, sorted and encoded in parallel. Invalid hrefs and repeats are left out and counted.
+         * 
+         * @param hrefs hrefs to index; only read while building
+         * @param size number of hrefs
+         * @param pool worker pool to build on
+         * @param block_size keys per block: larger blocks compress better and scan longer per lookup; default 16
+         */
+        UriIndex(const StringView* hrefs, std::size_t size, WorkerPool& pool, std::size_t block_size = default_block_size)
+            : block_size(block_size ? block_size : 1), count(0), rejected(0), duplicates(0), href_bytes(0) {
+            build(hrefs, size, pool);
+        }
+
+        /**
+         * @brief Build a UriIndex from a batch of hrefs across a worker pool
+         * 
+         * @param hrefs hrefs to index; only read while building
+         * @param pool worker pool to build on
+         * @param block_size keys per block; default 16
+         */
+        UriIndex(const std::vector<std::string>& hrefs, WorkerPool& pool, std::size_t block_size = default_block_size)
+            : block_size(block_size ? block_size : 1), count(0), rejected(0), duplicates(0), href_bytes(0) {
+            std::vector<StringView> views(hrefs.begin(), hrefs.end());
+            build(views.data(), views.size(), pool);
+        }
+
+        /**
+         * @brief Get the number of distinct URIs held
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return count;
+        }
+
+        /**
+         * @brief Indicates if the index holds an href
+         * 
+         * @param href URI characters, compared as written
+         * @return true if held
+         */
+        bool contains(StringView href) const {
+            detail::ScratchBuffer target, buffer;
+            char* out = target.reserve(detail::index_key_size(href));
+            StringView key(out, detail::write_index_key(href, out));
+            bool found = false;
+            scan(key, buffer, [&](StringView current) {
+                found = current == key;
+                return false;
+            });
+            return found;
+        }
+
+        /**
+         * @brief Visit, in index order, every URI whose href starts with a prefix, e.g. "https://example.com/docs/"
+         * 
+         * @tparam Fn callable as fn(const UriView& uri); the view is valid during the call only
+         * @param prefix href prefix; if it has an authority, the whole host must be in it
+         * @param fn called once per URI
+         * @return std::size_t number of URIs visited
+         */
+        template <class Fn>
+        std::size_t findPrefix(StringView prefix, Fn fn) const {
+            detail::ScratchBuffer key;
+            char* out = key.reserve(detail::index_key_size(prefix));
+            return visit(StringView(out, detail::write_index_key(prefix, out)), fn);
+        }
+
+        /**
+         * @brief Visit, in index order, every URI with a given host, and optionally with a subdomain of it
+         * 
+         * @tparam Fn callable as fn(const UriView& uri); the view is valid during the call only
+         * @param host host, compared as written; empty for the URIs without a host
+         * @param subdomains also visit the URIs whose host ends in "." host
+         * @param fn called once per URI
+         * @return std::size_t number of URIs visited
+         */
+        template <class Fn>
+        std::size_t findHost(StringView host, bool subdomains, Fn fn) const {
+            detail::ScratchBuffer key;
+            char* out = key.reserve(host.size() + 1);
+            *detail::write_reversed_host(host, out) = detail::index_separator;
+            std::size_t visited = visit(StringView(out, host.size() + 1), fn);
+            if (!subdomains || host.empty()) return visited;
+
+            out[host.size()] = '.';
+            return visited + visit(StringView(out, host.size() + 1), fn);
+        }
+
+        /**
+         * @brief Get the memory statistics of the index
+         * 
+         * @return UriIndexStats
+         */
+        UriIndexStats getStats() const {
+            UriIndexStats stats;
+            stats.uris = count;
+            stats.rejected = rejected;
+            stats.duplicates = duplicates;
+            stats.href_bytes = href_bytes;
+            stats.encoded_bytes = data.size();
+            stats.blocks = blocks.size();
+            stats.directory_bytes = blocks.capacity() * sizeof(std::uint64_t);
+            return stats;
+        }
+
+        private:
+        void build(const StringView* hrefs, std::size_t size, WorkerPool& pool) {
+            std::size_t grain = std::max<std::size_t>(1024, (size + pool.size() - 1) / pool.size());
+            std::size_t chunks = (size + grain - 1) / grain;
+
+            // keys are written into one buffer per chunk of inputs, sized for every input; a rejected one keeps an empty key
+            std::vector<std::unique_ptr<char[]>> text(chunks);
+            std::vector<StringView> keys(size);
+            pool.parallelFor(size, grain, [&](std::size_t begin, std::size_t end) {
+                std::size_t bytes = 0;
+                for (std::size_t i = begin; i < end; ++i) bytes += detail::index_key_size(hrefs[i]);
+                char* p = new char[bytes ? bytes : 1];
+                text[begin / grain].reset(p);
+                for (std::size_t i = begin; i < end; ++i) {
+                    if (!try_parse_view(hrefs[i])) continue;
+                    std::size_t key_size = detail::write_index_key(hrefs[i], p);
+                    keys[i] = StringView(p, key_size);
+                    p += key_size;
+                }
+            });
+
+            std::size_t valid = 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                if (!keys[i].empty()) keys[valid++] = keys[i];
+            }
+            rejected = size - valid;
+            keys.resize(valid);
+
+            sortKeys(keys, pool);
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            duplicates = valid - keys.size();
+            count = keys.size();
+            for (StringView key : keys) href_bytes += key.size() - (key[0] == detail::index_separator ? 1 : 2);
+
+            encode(keys, pool);
+        }
+
+        /**
+         * @brief Sorts runs of keys in parallel, then merges neighbouring runs in parallel rounds
+         * 
+         */
+        static void sortKeys(std::vector<StringView>& keys, WorkerPool& pool) {
+            std::size_t run = std::max<std::size_t>(4096, (keys.size() + pool.size() - 1) / pool.size());
+            std::size_t runs = (keys.size() + run - 1) / run;
+
+            pool.parallelFor(runs, 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t r = begin; r < end; ++r) {
+                    std::sort(keys.begin() + r * run, keys.begin() + std::min(keys.size(), (r + 1) * run), detail::view_less);
+                }
+            });
+
+            for (std::size_t width = run; width < keys.size(); width *= 2) {
+                std::size_t pairs = (keys.size() + 2 * width - 1) / (2 * width);
+                pool.parallelFor(pairs, 1, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t p = begin; p < end; ++p) {
+                        std::size_t middle = std::min(keys.size(), p * 2 * width + width);
+                        std::size_t last = std::min(keys.size(), (p + 1) * 2 * width);
+                        std::inplace_merge(keys.begin() + p * 2 * width, keys.begin() + middle, keys.begin() + last, detail::view_less);
+                    }
+                });
+            }
+        }
+
+        static std::size_t shared(StringView a, StringView b) {
+            std::size_t n = std::min(a.size(), b.size());
+            std::size_t i = 0;
+            while (i < n && a[i] == b[i]) ++i;
+            return i;
+        }
+
+        /**
+         * @brief Front-codes the sorted keys into blocks: sizes first, then every block written at its offset, in parallel
+         * 
+         */
+        void encode(const std::vector<StringView>& keys, WorkerPool& pool) {
+            std::size_t block_count = (keys.size() + block_size - 1) / block_size;
+            blocks.assign(block_count + 1, 0);
+
+            auto entry = [&](std::size_t i, std::size_t& prefix) {
+                prefix = i % block_size ? shared(keys[i - 1], keys[i]) : 0;
+                std::size_t rest = keys[i].size() - prefix;
+                return detail::varint_size(prefix) + detail::varint_size(rest) + rest;
+            };
+
+            pool.parallelFor(block_count, 256, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t b = begin; b < end; ++b) {
+                    std::size_t bytes = 0;
+                    std::size_t prefix;
+                    for (std::size_t i = b * block_size; i < std::min(keys.size(), (b + 1) * block_size); ++i) bytes += entry(i, prefix);
+                    blocks[b + 1] = bytes;
+                }
+            });
+            for (std::size_t b = 0; b < block_count; ++b) blocks[b + 1] += blocks[b];
+
+            data.assign(static_cast<std::size_t>(blocks[block_count]), '\0');
+            pool.parallelFor(block_count, 256, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t b = begin; b < end; ++b) {
+                    char* p = &data[static_cast<std::size_t>(blocks[b])];
+                    std::size_t prefix;
+                    for (std::size_t i = b * block_size; i < std::min(keys.size(), (b + 1) * block_size); ++i) {
+                        entry(i, prefix);
+                        p = detail::write_varint(p, prefix);
+                        p = detail::write_varint(p, keys[i].size() - prefix);
+                        std::memcpy(p, keys[i].data() + prefix, keys[i].size() - prefix);
+                        p += keys[i].size() - prefix;
+                    }
+                }
+            });
+
+            // the last offset only bounded the sizes
+            blocks.pop_back();
+            blocks.shrink_to_fit();
+        }
+
+        StringView firstKey(std::size_t block) const {
+            std::uint64_t prefix, rest;
+            const char* p = detail::read_varint(data.data() + blocks[block], prefix);
+            p = detail::read_varint(p, rest);
+            return StringView(p, static_cast<std::size_t>(rest));
+        }
+
+        /**
+         * @brief Decodes the keys from the first one not below target, in order, while fn(key) returns true
+         * 
+         * @param key buffer every key is decoded into
+         */
+        template <class Fn>
+        void scan(StringView target, detail::ScratchBuffer& key, Fn fn) const {
+            if (blocks.empty()) return;
+
+            // the last block whose first key is below target holds the first key not below it, or ends just before it
+            std::size_t low = 0, high = blocks.size();
+            while (high - low > 1) {
+                std::size_t middle = low + (high - low) / 2;
+                if (detail::view_less(firstKey(middle), target)) low = middle;
+                else high = middle;
+            }
+
+            const char* p = data.data() + blocks[low];
+            const char* end = data.data() + data.size();
+            while (p < end) {
+                std::uint64_t prefix, rest;
+                p = detail::read_varint(p, prefix);
+                p = detail::read_varint(p, rest);
+                char* out = key.reserve(static_cast<std::size_t>(prefix + rest), static_cast<std::size_t>(prefix));
+                std::memcpy(out + prefix, p, static_cast<std::size_t>(rest));
+                p += rest;
+
+                StringView current(out, static_cast<std::size_t>(prefix + rest));
+                if (detail::view_less(current, target)) continue;
+                if (!fn(current)) return;
+            }
+        }
+
+        template <class Fn>
+        std::size_t visit(StringView prefix, Fn& fn) const {
+            detail::ScratchBuffer buffer, href;
+            std::size_t visited = 0;
+            scan(prefix, buffer, [&](StringView key) {
+                if (!detail::starts_with(key, prefix)) return false;
+                char* out = href.reserve(key.size());
+                fn(try_parse_view(StringView(out, detail::read_index_key(key, out))).getUri());
+                ++visited;
+                return true;
+            });
+            return visited;
+        }
+
+        std::size_t block_size;
+        std::size_t count;
+        std::size_t rejected;
+        std::size_t duplicates;
+        std::size_t href_bytes;
+        std::vector<char> data;
+        std::vector<std::uint64_t> blocks;
+    };
+}
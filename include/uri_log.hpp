@@ -0,0 +1,390 @@
+#pragma once
+#include "uri.hpp"
+#include "uri_batch.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace uripp {
+    /**
+     * @brief A read-only memory mapping of a whole file
+     * 
+     */
+    class MappedFile {
+        public:
+        /**
+         * @brief Map a file into memory
+         * 
+         * @param path path of the file
+         * @throws std::runtime_error if the file cannot be opened or mapped
+         */
+        explicit MappedFile(const std::string& path) : address(nullptr), length(0) {
+#if defined(_WIN32)
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) URIPP_THROW(std::runtime_error("Cannot open " + path));
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size)) {
+                CloseHandle(file);
+                URIPP_THROW(std::runtime_error("Cannot read the size of " + path));
+            }
+            length = static_cast<std::size_t>(size.QuadPart);
+
+            if (length) {
+                HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping) {
+                    address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mapping);
+                }
+            }
+            CloseHandle(file);
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) URIPP_THROW(std::runtime_error("Cannot open " + path));
+
+            struct stat info;
+            if (::fstat(fd, &info) != 0) {
+                ::close(fd);
+                URIPP_THROW(std::runtime_error("Cannot read the size of " + path));
+            }
+            length = static_cast<std::size_t>(info.st_size);
+
+            if (length) {
+                address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address == MAP_FAILED) address = nullptr;
+#if defined(POSIX_MADV_SEQUENTIAL)
+                if (address) ::posix_madvise(address, length, POSIX_MADV_SEQUENTIAL);
+#endif
+            }
+            ::close(fd);
+#endif
+            if (length && !address) URIPP_THROW(std::runtime_error("Cannot map " + path));
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            if (!address) return;
+#if defined(_WIN32)
+            UnmapViewOfFile(address);
+#else
+            ::munmap(address, length);
+#endif
+        }
+
+        /**
+         * @brief Get the mapped characters
+         * 
+         * @return StringView view valid until the MappedFile is destroyed
+         */
+        StringView view() const {
+            return StringView(static_cast<const char*>(address), length);
+        }
+
+        /**
+         * @brief Get the size of the file
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return length;
+        }
+
+        private:
+        void* address;
+        std::size_t length;
+    };
+
+    /**
+     * @brief Which part of a log line holds the URI to parse
+     * 
+     */
+    class LogField {
+        public:
+        /**
+         * @brief The request-target of the first quoted request line, as in the Common and Combined Log Formats
+         * 
+         * In `1.2.3.4 - - [10/Oct/2000:13:55:36 -0700] "GET /a?b HTTP/1.0" 200 2326` the field is `/a?b`.
+         * 
+         * @return LogField
+         */
+        static LogField requestTarget() {
+            return LogField(true, 0, ' ');
+        }
+
+        /**
+         * @brief A column of a delimited line, e.g. of a space or tab separated log
+         * 
+         * Every delimiter separates two columns, so consecutive delimiters enclose empty columns.
+         * 
+         * @param index zero-based column index
+         * @param delimiter column delimiter; default ' '
+         * @return LogField
+         */
+        static LogField column(std::size_t index, char delimiter = ' ') {
+            return LogField(false, index, delimiter);
+        }
+
+        /**
+         * @brief Find the field in a line
+         * 
+         * @param line line without its terminator
+         * @return StringView the field; empty if the line does not have it
+         */
+        StringView extract(StringView line) const {
+            const char* p = line.begin();
+            const char* end = line.end();
+
+            if (request_target) {
+                const char* quote = static_cast<const char*>(std::memchr(p, '"', line.size()));
+                if (!quote) return StringView();
+                // a request line that could not be read is logged as "-", which has no method and no target
+                const char* request_end = find(quote + 1, end, '"');
+                const char* method_end = find(quote + 1, request_end, ' ');
+                if (method_end == request_end) return StringView();
+                const char* target = method_end + 1;
+                return StringView(target, static_cast<std::size_t>(find(target, request_end, ' ') - target));
+            }
+
+            for (std::size_t i = 0; i < index; ++i) {
+                p = find(p, end, delimiter);
+                if (p == end) return StringView();
+                ++p;
+            }
+            return StringView(p, static_cast<std::size_t>(find(p, end, delimiter) - p));
+        }
+
+        private:
+        LogField(bool request_target, std::size_t index, char delimiter)
+            : request_target(request_target), index(index), delimiter(delimiter) {}
+
+        static const char* find(const char* p, const char* end, char c) {
+            const char* found = static_cast<const char*>(std::memchr(p, c, static_cast<std::size_t>(end - p)));
+            return found ? found : end;
+        }
+
+        bool request_target;
+        std::size_t index;
+        char delimiter;
+    };
+
+    /**
+     * @brief Split a log into chunks of whole lines, to be scanned independently
+     * 
+     * @param data log characters
+     * @param chunk_size approximate size of a chunk; every chunk but the last is extended to the end of its line
+     * @return std::vector<StringView> chunks covering data in order
+     */
+    inline std::vector<StringView> split_log(StringView data, std::size_t chunk_size = 4 << 20) {
+        std::vector<StringView> chunks;
+        if (chunk_size == 0) chunk_size = 1;
+
+        const char* p = data.begin();
+        const char* end = data.end();
+        while (p < end) {
+            const char* cut = static_cast<std::size_t>(end - p) > chunk_size ? p + chunk_size : end;
+            if (cut < end) {
+                const char* eol = static_cast<const char*>(std::memchr(cut, '\n', static_cast<std::size_t>(end - cut)));
+                cut = eol ? eol + 1 : end;
+            }
+            chunks.push_back(StringView(p, static_cast<std::size_t>(cut - p)));
+            p = cut;
+        }
+        return chunks;
+    }
+
+    /**
+     * @brief Scan chunks of a log across a worker pool, parsing the URI field of every line in place
+     * 
+     * Lines may end in "\n" or "\r\n". Nothing is copied: the line, the field and the parsed UriView all view the chunk.
+     * Every chunk is scanned by one thread, in order, so state indexed by chunk needs no locking.
+     * 
+     * @tparam Fn callable as fn(std::size_t chunk, StringView line, StringView field, const ParseResult<UriView>& uri);
+     * must not throw. field is empty for a line without the field.
+     * @param chunks chunks from split_log()
+     * @param field field to extract from every line
+     * @param pool worker pool to scan on
+     * @param fn called once per line
+     */
+    template <class Fn>
+    void scan_log(const std::vector<StringView>& chunks, const LogField& field, WorkerPool& pool, Fn fn) {
+        pool.parallelFor(chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t chunk = begin; chunk < end; ++chunk) {
+                const char* p = chunks[chunk].begin();
+                const char* stop = chunks[chunk].end();
+
+                while (p < stop) {
+                    const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(stop - p)));
+                    const char* next = eol ? eol + 1 : stop;
+                    if (!eol) eol = stop;
+                    if (eol > p && eol[-1] == '\r') --eol;
+
+                    StringView line(p, static_cast<std::size_t>(eol - p));
+                    StringView value = field.extract(line);
+                    fn(chunk, line, value, try_parse_view(value));
+                    p = next;
+                }
+            }
+        });
+    }
+
+    namespace detail {
+        struct StringViewHash {
+            std::size_t operator()(StringView key) const {
+                return hash_key(key, false);
+            }
+        };
+    }
+
+    /**
+     * @brief Per-host and per-path hit counters over a scanned log, keyed by views into the log
+     * 
+     * Each chunk counts into its own tables, which merge() folds together, so counting takes no lock.
+     * The counted characters must outlive the counters.
+     */
+    class LogCounters {
+        public:
+        typedef std::vector<std::pair<StringView, std::uint64_t>> Ranking;
+
+        /**
+         * @brief Construct a new LogCounters object
+         * 
+         * @param chunks number of chunks that will count
+         */
+        explicit LogCounters(std::size_t chunks) : tables(chunks) {}
+
+        /**
+         * @brief Count a line
+         * 
+         * @param chunk chunk the line belongs to
+         * @param field URI field of the line; empty if the line has none, which only counts the line
+         * @param uri parsed field
+         * @param host host to count when the URI has none, e.g. a virtual host column; default none
+         */
+        void count(std::size_t chunk, StringView field, const ParseResult<UriView>& uri, StringView host = StringView()) {
+            Table& table = tables[chunk];
+            ++table.lines;
+            if (field.empty()) return;
+            if (!uri.ok()) {
+                ++table.rejected;
+                return;
+            }
+
+            const UriView& view = uri.getUri();
+            StringView uri_host = view.getHost();
+            ++table.parsed;
+            ++table.hosts[uri_host.empty() ? host : uri_host];
+            ++table.paths[view.getPath()];
+        }
+
+        /**
+         * @brief Fold the tables of every chunk together
+         * 
+         */
+        void merge() {
+            Table total;
+            for (Table& table : tables) {
+                total.lines += table.lines;
+                total.parsed += table.parsed;
+                total.rejected += table.rejected;
+                for (const auto& entry : table.hosts) total.hosts[entry.first] += entry.second;
+                for (const auto& entry : table.paths) total.paths[entry.first] += entry.second;
+            }
+            tables.assign(1, Table());
+            std::swap(tables[0], total);
+        }
+
+        /**
+         * @brief Get the number of lines counted; call after merge()
+         * 
+         * @return std::uint64_t
+         */
+        std::uint64_t getLines() const {
+            return tables.empty() ? 0 : tables[0].lines;
+        }
+
+        /**
+         * @brief Get the number of lines whose field was parsed; call after merge()
+         * 
+         * @return std::uint64_t
+         */
+        std::uint64_t getParsed() const {
+            return tables.empty() ? 0 : tables[0].parsed;
+        }
+
+        /**
+         * @brief Get the number of lines whose field was not a valid URI; call after merge()
+         * 
+         * @return std::uint64_t
+         */
+        std::uint64_t getRejected() const {
+            return tables.empty() ? 0 : tables[0].rejected;
+        }
+
+        /**
+         * @brief Get the most frequent hosts; call after merge()
+         * 
+         * @param limit maximum number of hosts
+         * @return Ranking hosts and counts, most frequent first; lines without a host count under an empty view
+         */
+        Ranking topHosts(std::size_t limit) const {
+            return tables.empty() ? Ranking() : top(tables[0].hosts, limit);
+        }
+
+        /**
+         * @brief Get the most frequent paths; call after merge()
+         * 
+         * @param limit maximum number of paths
+         * @return Ranking paths and counts, most frequent first
+         */
+        Ranking topPaths(std::size_t limit) const {
+            return tables.empty() ? Ranking() : top(tables[0].paths, limit);
+        }
+
+        private:
+        typedef std::unordered_map<StringView, std::uint64_t, detail::StringViewHash> Map;
+
+        struct Table {
+            Table() : lines(0), parsed(0), rejected(0) {}
+
+            std::uint64_t lines;
+            std::uint64_t parsed;
+            std::uint64_t rejected;
+            Map hosts;
+            Map paths;
+        };
+
+        static Ranking top(const Map& map, std::size_t limit) {
+            Ranking ranking(map.begin(), map.end());
+            limit = std::min(limit, ranking.size());
+            std::partial_sort(ranking.begin(), ranking.begin() + limit, ranking.end(),
+                              [](const std::pair<StringView, std::uint64_t>& a, const std::pair<StringView, std::uint64_t>& b) {
+                                  if (a.second != b.second) return a.second > b.second;
+                                  return std::lexicographical_compare(a.first.begin(), a.first.end(), b.first.begin(), b.first.end());
+                              });
+            ranking.resize(limit);
+            return ranking;
+        }
+
+        std::vector<Table> tables;
+    };
+}
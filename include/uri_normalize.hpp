@@ -0,0 +1,464 @@
+#pragma once
+#include "uri.hpp"
+#include "uri_resolve.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace uripp {
+    /**
+     * @brief A 128-bit canonical hash of a URI, see canonical_hash()
+     * 
+     */
+    struct UriHash {
+        std::uint64_t low;
+        std::uint64_t high;
+
+        bool operator==(const UriHash& other) const { return low == other.low && high == other.high; }
+        bool operator!=(const UriHash& other) const { return !(*this == other); }
+    };
+
+    namespace detail {
+        inline std::uint64_t rotl64(std::uint64_t x, int r) {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        inline std::uint64_t load_le64(const char* p) {
+            std::uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            v = __builtin_bswap64(v);
+#endif
+            return v;
+        }
+
+        inline std::uint64_t fmix64(std::uint64_t k) {
+            k ^= k >> 33;
+            k *= 0xff51afd7ed558ccdULL;
+            k ^= k >> 33;
+            k *= 0xc4ceb9fe1a85ec53ULL;
+            k ^= k >> 33;
+            return k;
+        }
+
+        /**
+         * @brief A streaming MurmurHash3 x64_128 over the bytes written to it
+         * 
+         * Bytes are gathered in a 64-byte window and consumed in 16-byte blocks, so the many short writes of a normalizer
+         * cost a copy each, and the result does not depend on how the input is split into write() calls. It equals the
+         * one-shot MurmurHash3_x64_128 of the concatenated input on any byte order.
+         */
+        class HashSink {
+            public:
+            explicit HashSink(std::uint64_t seed = 0) : h1(seed), h2(seed), total(0), buffered(0) {}
+
+            void put(char c) {
+                if (buffered == sizeof(buffer)) flush();
+                buffer[buffered++] = c;
+            }
+
+            void write(const char* data, std::size_t size) {
+                if (size <= sizeof(buffer) - buffered) {
+                    std::memcpy(buffer + buffered, data, size);
+                    buffered += size;
+                    return;
+                }
+
+                std::size_t take = sizeof(buffer) - buffered;
+                std::memcpy(buffer + buffered, data, take);
+                buffered += take;
+                data += take;
+                size -= take;
+                flush();
+
+                for (; size > sizeof(buffer); data += 16, size -= 16) {
+                    block(data);
+                    total += 16;
+                }
+                std::memcpy(buffer, data, size);
+                buffered = size;
+            }
+
+            UriHash digest() const {
+                std::uint64_t a = h1;
+                std::uint64_t b = h2;
+                std::uint64_t k1 = 0;
+                std::uint64_t k2 = 0;
+
+                std::size_t blocks = buffered / 16;
+                HashSink rest(*this);
+                for (std::size_t i = 0; i < blocks; ++i) rest.block(buffer + 16 * i);
+                a = rest.h1;
+                b = rest.h2;
+
+                std::size_t left = buffered - 16 * blocks;
+                std::uint64_t length = total + buffered;
+                const unsigned char* tail = reinterpret_cast<const unsigned char*>(buffer + 16 * blocks);
+
+                for (std::size_t i = left; i > 8; --i) k2 |= static_cast<std::uint64_t>(tail[i - 1]) << (8 * (i - 9));
+                for (std::size_t i = left < 8 ? left : 8; i > 0; --i) k1 |= static_cast<std::uint64_t>(tail[i - 1]) << (8 * (i - 1));
+
+                if (left > 8) {
+                    k2 *= c2;
+                    k2 = rotl64(k2, 33);
+                    k2 *= c1;
+                    b ^= k2;
+                }
+                if (left > 0) {
+                    k1 *= c1;
+                    k1 = rotl64(k1, 31);
+                    k1 *= c2;
+                    a ^= k1;
+                }
+
+                a ^= length;
+                b ^= length;
+                a += b;
+                b += a;
+                a = fmix64(a);
+                b = fmix64(b);
+                a += b;
+                b += a;
+
+                return UriHash{a, b};
+            }
+
+            private:
+            static const std::uint64_t c1 = 0x87c37b91114253d5ULL;
+            static const std::uint64_t c2 = 0x4cf5ad432745937fULL;
+
+            // Consumes the full window; digest() consumes what is left of a partial one
+            void flush() {
+                for (std::size_t i = 0; i < sizeof(buffer); i += 16) block(buffer + i);
+                total += sizeof(buffer);
+                buffered = 0;
+            }
+
+            void block(const char* data) {
+                std::uint64_t k1 = load_le64(data);
+                std::uint64_t k2 = load_le64(data + 8);
+
+                k1 *= c1;
+                k1 = rotl64(k1, 31);
+                k1 *= c2;
+                h1 ^= k1;
+                h1 = rotl64(h1, 27);
+                h1 += h2;
+                h1 = h1 * 5 + 0x52dce729;
+
+                k2 *= c2;
+                k2 = rotl64(k2, 33);
+                k2 *= c1;
+                h2 ^= k2;
+                h2 = rotl64(h2, 31);
+                h2 += h1;
+                h2 = h2 * 5 + 0x38495ab5;
+            }
+
+            std::uint64_t h1;
+            std::uint64_t h2;
+            std::uint64_t total;
+            std::size_t buffered;
+            char buffer[64];
+        };
+
+        /**
+         * @brief Appends to a caller-provided buffer
+         * 
+         */
+        struct BufferSink {
+            char* out;
+
+            void put(char c) {
+                *out++ = c;
+            }
+
+            void write(const char* data, std::size_t size) {
+                std::memcpy(out, data, size);
+                out += size;
+            }
+        };
+
+        template <class Sink>
+        void write_lower(StringView in, Sink& sink) {
+            char chunk[64];
+            for (std::size_t i = 0; i < in.size(); i += sizeof(chunk)) {
+                std::size_t size = in.size() - i < sizeof(chunk) ? in.size() - i : sizeof(chunk);
+                for (std::size_t j = 0; j < size; ++j) chunk[j] = to_lower(in[i + j]);
+                sink.write(chunk, size);
+            }
+        }
+
+        /**
+         * @brief Writes a component with percent-encoding normalized (RFC 3986 section 6.2.2.1 and 6.2.2.2)
+         * 
+         * Escapes of unreserved characters are decoded, the hex digits of the others are uppercased and, when lower is
+         * set, everything else is lowercased. A '%' that does not start an escape is written as "%25", so that decoding
+         * cannot make it one. Runs without a '%' are written in one piece.
+         */
+        template <class Sink>
+        void write_normalized(StringView in, Sink& sink, bool lower) {
+            const char* p = in.begin();
+            const char* end = in.end();
+
+            while (p < end) {
+                const char* escape = static_cast<const char*>(std::memchr(p, '%', static_cast<std::size_t>(end - p)));
+                if (!escape) escape = end;
+                if (lower) write_lower(StringView(p, static_cast<std::size_t>(escape - p)), sink);
+                else sink.write(p, static_cast<std::size_t>(escape - p));
+                p = escape;
+                if (p == end) break;
+
+                int high = end - p >= 3 ? hex_value(p[1]) : -1;
+                int low = high >= 0 ? hex_value(p[2]) : -1;
+                if (low < 0) {
+                    sink.write("%25", 3);
+                    ++p;
+                    continue;
+                }
+
+                char decoded = static_cast<char>((high << 4) | low);
+                if (is_unreserved(decoded)) {
+                    sink.put(lower ? to_lower(decoded) : decoded);
+                } else {
+                    sink.put('%');
+                    sink.put(hex_digit(static_cast<unsigned>(high)));
+                    sink.put(hex_digit(static_cast<unsigned>(low)));
+                }
+                p += 3;
+            }
+        }
+
+        inline std::size_t count_percent(StringView in) {
+            std::size_t count = 0;
+            const char* p = in.begin();
+            while ((p = static_cast<const char*>(std::memchr(p, '%', static_cast<std::size_t>(in.end() - p)))) != nullptr) {
+                ++count;
+                ++p;
+            }
+            return count;
+        }
+
+        /**
+         * @brief Indicates if a port is written as the default port of a scheme; "080" is kept as written
+         * 
+         */
+        inline bool is_default_port(StringView scheme, StringView port) {
+            std::uint16_t number = default_port(scheme);
+            return number != 0 && !port.empty() && port[0] != '0' && port_number(port) == number;
+        }
+
+        /**
+         * @brief Writes the path of an absolute URI with percent-encoding normalized and dot segments removed
+         * 
+         * Only a path with a "." or ".." segment, or with an escape that may decode to one, is normalized into a scratch
+         * buffer so that remove_dot_segments can look ahead. Every other path is streamed straight to the sink. When no "//"
+         * precedes the path, a path that removing dot segments left starting with "//" gets a "/." prefix, as in RFC 3986
+         * section 5.3, so that it is not read back as an authority.
+         */
+        template <class Sink>
+        void write_absolute_path(StringView path, Sink& sink, bool after_authority) {
+            if (!std::memchr(path.data(), '%', path.size()) && !has_dot_segment(path)) {
+                sink.write(path.data(), path.size());
+                return;
+            }
+
+            char stack[256];
+            std::string heap;
+            char* scratch = stack;
+            std::size_t size = path.size() + 2 * count_percent(path);
+            if (size > sizeof(stack)) {
+                heap.resize(size);
+                scratch = &heap[0];
+            }
+
+            BufferSink buffer{scratch};
+            write_normalized(path, buffer, false);
+            char* end = remove_dots(scratch, scratch, scratch, buffer.out);
+            if (!after_authority && end - scratch >= 2 && scratch[0] == '/' && scratch[1] == '/') sink.write("/.", 2);
+            sink.write(scratch, static_cast<std::size_t>(end - scratch));
+        }
+
+        /**
+         * @brief Writes the normalized form of a parsed URI to a sink, walking its components once
+         * 
+         * The sink takes put(char) and write(const char*, std::size_t).
+         */
+        template <class Sink>
+        void normalize_to(const UriView& uri, Sink& sink) {
+            StringView query = uri.getQuery();
+            StringView fragment = uri.getFragment();
+
+            if (uri.isRelativeUri()) {
+                // The query and fragment of a relative URI keep their leading '?' and '#'
+                write_normalized(uri.getPath(), sink, false);
+                if (!query.empty()) {
+                    sink.put('?');
+                    write_normalized(query.substr(1), sink, false);
+                }
+                if (!fragment.empty()) {
+                    sink.put('#');
+                    write_normalized(fragment.substr(1), sink, false);
+                }
+                return;
+            }
+
+            StringView scheme = uri.getScheme();
+            write_lower(scheme, sink);
+            sink.put(':');
+
+            StringView path = uri.getPath();
+            bool after_authority = true;
+            if (uri.hasAuthority()) {
+                StringView authority = uri.getAuthority();
+                sink.put('/');
+                sink.put('/');
+
+                const char* host = authority.begin();
+                for (const char* p = authority.end(); p > authority.begin(); --p) {
+                    if (p[-1] == '@') {
+                        host = p;
+                        break;
+                    }
+                }
+                write_normalized(StringView(authority.begin(), static_cast<std::size_t>(host - authority.begin())), sink, false);
+
+                const char* host_end = authority.end();
+                for (const char* p = authority.end(); p > host && p[-1] != ']'; --p) {
+                    if (p[-1] == ':') {
+                        host_end = p - 1;
+                        break;
+                    }
+                }
+                write_normalized(StringView(host, static_cast<std::size_t>(host_end - host)), sink, true);
+
+                if (host_end < authority.end()) {
+                    StringView port(host_end + 1, static_cast<std::size_t>(authority.end() - host_end - 1));
+                    if (!is_default_port(scheme, port)) {
+                        sink.put(':');
+                        sink.write(port.data(), port.size());
+                    }
+                }
+
+                if (path.empty()) sink.put('/');
+            } else if (path.data() != scheme.end() + 1) {
+                // An empty authority is not a component, but its "//" must stay so that a path like "//x" is not read as one
+                sink.put('/');
+                sink.put('/');
+            } else {
+                after_authority = false;
+            }
+            write_absolute_path(path, sink, after_authority);
+
+            if (!query.empty()) {
+                sink.put('?');
+                write_normalized(query, sink, false);
+            }
+            if (!fragment.empty()) {
+                sink.put('#');
+                write_normalized(fragment, sink, false);
+            }
+        }
+    }
+
+    /**
+     * @brief Get an upper bound on the size of the normalized form of a URI
+     * 
+     * @param uri parsed URI
+     * @return std::size_t
+     */
+    inline std::size_t max_normalized_size(const UriView& uri) {
+        return uri.getHref().size() + 2 * detail::count_percent(uri.getHref()) + 1;
+    }
+
+    /**
+     * @brief Normalize a URI into a caller-provided buffer
+     * 
+     * Applies the syntax-based normalization of RFC 3986 section 6.2.2 and the scheme-based normalization of section
+     * 6.2.3: scheme and host are lowercased, percent-encodings of unreserved characters are decoded and the hex digits
+     * of the others uppercased, dot segments are removed from the path of an absolute URI, the default port of http,
+     * https, ws, wss and ftp is dropped, and an empty path after an authority becomes "/".
+     * The components of a relative URI only get their percent-encodings normalized.
+     * 
+     * @param uri parsed URI
+     * @param out output buffer of at least max_normalized_size(uri) characters
+     * @return std::size_t size of the normalized href
+     */
+    inline std::size_t normalize(const UriView& uri, char* out) {
+        detail::BufferSink sink{out};
+        detail::normalize_to(uri, sink);
+        return static_cast<std::size_t>(sink.out - out);
+    }
+
+    /**
+     * @brief Normalize a URI, see normalize(const UriView&, char*)
+     * 
+     * @param uri parsed URI
+     * @return std::string normalized href
+     */
+    inline std::string normalize(const UriView& uri) {
+        std::string out(max_normalized_size(uri), '\0');
+        out.resize(normalize(uri, &out[0]));
+        return out;
+    }
+
+    /**
+     * @brief Normalize a URI, see normalize(const UriView&, char*)
+     * 
+     * @param uri parsed URI
+     * @return std::string normalized href
+     */
+    inline std::string normalize(const Uri& uri) {
+        return normalize(uri.view());
+    }
+
+    /**
+     * @brief Hash the normalized form of a URI without writing it out
+     * 
+     * The result is the MurmurHash3 x64_128 of the href normalize() returns, computed while walking the components,
+     * so URIs that normalize alike hash alike. Only a path with a '.' or a '%' is copied, to a scratch buffer.
+     * 
+     * @param uri parsed URI
+     * @param seed hash seed; default 0
+     * @return UriHash 128-bit hash
+     */
+    inline UriHash canonical_hash(const UriView& uri, std::uint64_t seed = 0) {
+        detail::HashSink sink(seed);
+        detail::normalize_to(uri, sink);
+        return sink.digest();
+    }
+
+    /**
+     * @brief Hash the normalized form of a URI without writing it out, see canonical_hash(const UriView&, std::uint64_t)
+     * 
+     * @param uri parsed URI
+     * @param seed hash seed; default 0
+     * @return UriHash 128-bit hash
+     */
+    inline UriHash canonical_hash(const Uri& uri, std::uint64_t seed = 0) {
+        return canonical_hash(uri.view(), seed);
+    }
+
+    /**
+     * @brief Get the low 64 bits of canonical_hash()
+     * 
+     * @param uri parsed URI
+     * @param seed hash seed; default 0
+     * @return std::uint64_t 64-bit hash
+     */
+    inline std::uint64_t canonical_hash64(const UriView& uri, std::uint64_t seed = 0) {
+        return canonical_hash(uri, seed).low;
+    }
+
+    /**
+     * @brief Get the low 64 bits of canonical_hash()
+     * 
+     * @param uri parsed URI
+     * @param seed hash seed; default 0
+     * @return std::uint64_t 64-bit hash
+     */
+    inline std::uint64_t canonical_hash64(const Uri& uri, std::uint64_t seed = 0) {
+        return canonical_hash(uri.view(), seed).low;
+    }
+}
@@ -0,0 +1,326 @@
+#pragma once
+#include "uri.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace uripp {
+    /**
+     * @brief Scheme family of a ParsePolicy: "http" and "https" in any case, which must have a non-empty authority
+     * 
+     */
+    struct WebSchemes {};
+
+    /**
+     * @brief Scheme family of a ParsePolicy: non-hierarchical schemes such as "mailto" and "urn", which have no authority
+     * 
+     * Everything after the ':' is path, query and fragment, so "urn://x" has the path "//x".
+     */
+    struct OpaqueSchemes {};
+
+    /**
+     * @brief Scheme family of a ParsePolicy: any scheme, or a relative reference, as parsed by the Uri constructors
+     * 
+     */
+    struct AnyScheme {};
+
+    /**
+     * @brief Strictness of a ParsePolicy: accepts what the Uri constructors accept
+     * 
+     */
+    struct LenientSyntax {
+        static constexpr bool strict = false;
+    };
+
+    /**
+     * @brief Strictness of a ParsePolicy: also checks the scheme against the RFC 3986 grammar, rejects a userinfo in
+     * web URIs, as RFC 9110 deprecates it, and a path starting with '/' in opaque URIs
+     * 
+     */
+    struct StrictSyntax {
+        static constexpr bool strict = true;
+    };
+
+    /**
+     * @brief Character validation of a ParsePolicy: the path, query and fragment of an absolute URI are only split at
+     * their delimiters, as by the Uri constructors
+     * 
+     */
+    struct CheckDelimiters {
+        static constexpr bool characters = false;
+    };
+
+    /**
+     * @brief Character validation of a ParsePolicy: every character of the path, query and fragment of an absolute URI
+     * must also be allowed there by RFC 3986, as in a relative reference
+     * 
+     */
+    struct CheckCharacters {
+        static constexpr bool characters = true;
+    };
+
+    /**
+     * @brief Compile-time rules for try_parse_view<Policy>() and try_parse<Policy>()
+     * 
+     * Each combination compiles to its own scan, so the rules cost nothing when they are not checked and the branches a
+     * family cannot take are left out: the web scan matches its scheme without searching for the ':' and never falls
+     * back to a relative reference, and the opaque scan never looks for an authority. ParsePolicy<> scans as the Uri
+     * constructors do.
+     * 
+     * @tparam Family WebSchemes, OpaqueSchemes or AnyScheme
+     * @tparam Syntax LenientSyntax or StrictSyntax
+     * @tparam Characters CheckDelimiters or CheckCharacters
+     */
+    template <class Family = AnyScheme, class Syntax = LenientSyntax, class Characters = CheckDelimiters>
+    struct ParsePolicy {
+        typedef Family family;
+        typedef Syntax syntax;
+        typedef Characters characters;
+    };
+
+    typedef ParsePolicy<WebSchemes> WebPolicy;
+    typedef ParsePolicy<WebSchemes, StrictSyntax, CheckCharacters> StrictWebPolicy;
+    typedef ParsePolicy<OpaqueSchemes> OpaquePolicy;
+
+    namespace detail {
+        /**
+         * @brief Matches the scheme grammar "ALPHA *( ALPHA / DIGIT / '+' / '-' / '.' )" over s[0, end)
+         * 
+         * @return std::size_t end, or the position of the first rejected character
+         */
+        inline std::size_t check_scheme(const char* s, std::size_t end) {
+            if (end == 0 || is_digit(s[0]) || !is_alnum(s[0])) return 0;
+            std::size_t i = 1;
+            while (i < end && (is_alnum(s[i]) || s[i] == '+' || s[i] == '-' || s[i] == '.')) ++i;
+            return i;
+        }
+
+        /**
+         * @brief Matches "path [ '?' query ] [ '#' fragment ]" of an absolute URI from s[i], as scan_href() does,
+         * checking every character against its component when Characters asks for it
+         * 
+         */
+        template <class Characters>
+        inline parse_error scan_policy_tail(const char* s, std::size_t i, std::size_t n, UriParts& parts, std::size_t& error_offset) {
+            std::size_t path_begin = i;
+            i = scan_to(s, i, n, ByteClass{{'?', '#', '#', '#'}, Characters::characters});
+            parts.set(part_path, path_begin, i);
+
+            if (i < n && s[i] == '?') {
+                std::size_t query_begin = ++i;
+                i = scan_to(s, i, n, ByteClass{{'#', '#', '#', '#'}, Characters::characters});
+                if (i > query_begin) parts.set(part_query, query_begin, i);
+            }
+
+            if (i < n && s[i] == '#') {
+                std::size_t fragment_begin = ++i;
+                i = Characters::characters ? scan_to(s, i, n, ByteClass{{'#', '#', '#', '#'}, true})
+                                           : scan_to(s, i, n, ByteClass{{'\n', '\r', '\n', '\r'}, false});
+                if (i > fragment_begin) parts.set(part_fragment, fragment_begin, i);
+            }
+
+            if (i < n) {
+                error_offset = i;
+                return parse_error::invalid_character;
+            }
+            parts.flags = static_cast<std::uint16_t>(parts.flags | flag_absolute);
+            return parse_error::none;
+        }
+
+        /**
+         * @brief Scans "http" or "https", in any case, then "://" and a non-empty authority
+         * 
+         * The scheme is compared in place instead of searched for, and the authority is split before the path is
+         * scanned, so a malformed host is rejected without scanning the rest of the href.
+         */
+        template <class Syntax, class Characters>
+        inline parse_error scan_policy(WebSchemes, const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset) {
+            std::size_t i = 0;
+            while (i < 4 && i < n && to_lower(s[i]) == "http"[i]) ++i;
+            if (i == 4 && i < n && to_lower(s[i]) == 's') ++i;
+            if (i < 4 || i == n || s[i] != ':') {
+                error_offset = i;
+                return parse_error::invalid_character;
+            }
+            parts.set(part_scheme, 0, i);
+
+            if (n - i < 3 || s[i + 1] != '/' || s[i + 2] != '/') {
+                error_offset = i + 1;
+                return parse_error::invalid_authority;
+            }
+            std::size_t authority_begin = i + 3;
+            i = scan_to(s, authority_begin, n, ByteClass{{'/', '?', '#', '#'}, false});
+            if (i == authority_begin) {
+                error_offset = i;
+                return parse_error::invalid_host;
+            }
+            parts.set(part_authority, authority_begin, i);
+
+            if (Syntax::strict) {
+                // without a userinfo there is no '@' to look for; one shows up as a rejected host or port instead
+                parse_error error = scan_host_port(s, authority_begin, i, parts, error_offset);
+                if (error != parse_error::none) {
+                    const void* at = std::memchr(s + authority_begin, '@', i - authority_begin);
+                    if (at) {
+                        error_offset = static_cast<std::size_t>(static_cast<const char*>(at) - s);
+                        return parse_error::invalid_authority;
+                    }
+                    return error;
+                }
+            } else {
+                parse_error error = scan_authority(s, authority_begin, i, parts, error_offset);
+                if (error != parse_error::none) return error;
+            }
+
+            return scan_policy_tail<Characters>(s, i, n, parts, error_offset);
+        }
+
+        /**
+         * @brief Scans "scheme ':' path [ '?' query ] [ '#' fragment ]" without looking for an authority
+         * 
+         */
+        template <class Syntax, class Characters>
+        inline parse_error scan_policy(OpaqueSchemes, const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset) {
+            std::size_t i = scan_to(s, 0, n, ByteClass{{':', '/', '?', '#'}, false});
+            if (i == 0 || i == n || s[i] != ':') {
+                error_offset = i;
+                return parse_error::invalid_character;
+            }
+            if (Syntax::strict) {
+                std::size_t bad = check_scheme(s, i);
+                if (bad != i) {
+                    error_offset = bad;
+                    return parse_error::invalid_character;
+                }
+            }
+            parts.set(part_scheme, 0, i);
+            ++i;
+
+            if (Syntax::strict && i < n && s[i] == '/') {
+                error_offset = i;
+                return parse_error::invalid_character;
+            }
+            return scan_policy_tail<Characters>(s, i, n, parts, error_offset);
+        }
+
+        /**
+         * @brief Scans an absolute URI or a relative reference, as scan_href() does
+         * 
+         * ParsePolicy<> is scan_href() itself; the other combinations add their checks to the same steps.
+         */
+        template <class Syntax, class Characters>
+        inline parse_error scan_policy(AnyScheme, const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset) {
+            if (!Syntax::strict && !Characters::characters) return scan_href<RuntimeScan>(s, n, parts, error_offset, true);
+
+            std::size_t i = scan_to(s, 0, n, ByteClass{{':', '/', '?', '#'}, false});
+            if (i == 0 || i == n || s[i] != ':') return scan_relative(s, n, parts, error_offset);
+            if (Syntax::strict) {
+                std::size_t bad = check_scheme(s, i);
+                if (bad != i) {
+                    error_offset = bad;
+                    return parse_error::invalid_character;
+                }
+            }
+            parts.set(part_scheme, 0, i);
+            ++i;
+
+            if (i + 1 < n && s[i] == '/' && s[i + 1] == '/') {
+                std::size_t authority_begin = i + 2;
+                i = scan_to(s, authority_begin, n, ByteClass{{'/', '?', '#', '#'}, false});
+                if (i > authority_begin) parts.set(part_authority, authority_begin, i);
+            }
+
+            parse_error error = scan_policy_tail<Characters>(s, i, n, parts, error_offset);
+            if (error != parse_error::none || !parts.has(part_authority)) return error;
+            std::size_t authority_begin = parts.offset[part_authority];
+            return scan_authority(s, authority_begin, authority_begin + parts.length[part_authority], parts, error_offset);
+        }
+
+        /**
+         * @brief Scans an href with the scan of a ParsePolicy and records the span of every component
+         * 
+         * With URIPP_ENABLE_STATS, the href is also counted in the parse counters.
+         * 
+         * @param s href characters
+         * @param n number of characters
+         * @param parts receives the component spans
+         * @param error_offset receives the position at which the href was rejected
+         * @return parse_error none, or the reason the href was rejected
+         */
+        template <class Policy>
+        inline parse_error scan_with(const char* s, std::size_t n, UriParts& parts, std::size_t& error_offset) {
+            parts = UriParts();
+            error_offset = 0;
+            parse_error error;
+            if (n > UINT32_MAX) {
+                error_offset = UINT32_MAX;
+                error = parse_error::too_long;
+            } else {
+                error = scan_policy<typename Policy::syntax, typename Policy::characters>(typename Policy::family(), s, n, parts, error_offset);
+            }
+#ifdef URIPP_ENABLE_STATS
+            count_parse(n, parts, error);
+#endif
+            return error;
+        }
+    }
+
+    /**
+     * @brief Parse a borrowed character range into a UriView under a ParsePolicy, without throwing or allocating
+     * 
+     * For example, `try_parse_view<WebPolicy>(data, size)` accepts only http and https URIs with an authority.
+     * 
+     * @tparam Policy a ParsePolicy
+     * @param data first character of the href
+     * @param size number of characters
+     * @return ParseResult<UriView> the parsed UriView, or the reason and offset at which the href was rejected
+     */
+    template <class Policy>
+    inline ParseResult<UriView> try_parse_view(const char* data, std::size_t size) {
+        detail::UriParts parts;
+        std::size_t error_offset;
+        parse_error error = detail::scan_with<Policy>(data, size, parts, error_offset);
+
+        if (error != parse_error::none) return ParseResult<UriView>(error, error_offset);
+        return ParseResult<UriView>(detail::UriAccess::make_view(StringView(data, size), parts));
+    }
+
+    /**
+     * @brief Parse a borrowed href into a UriView under a ParsePolicy, without throwing or allocating
+     * 
+     * @tparam Policy a ParsePolicy
+     * @param href URI characters
+     * @return ParseResult<UriView> the parsed UriView, or the reason and offset at which href was rejected
+     */
+    template <class Policy>
+    inline ParseResult<UriView> try_parse_view(StringView href) {
+        return try_parse_view<Policy>(href.data(), href.size());
+    }
+
+    /**
+     * @brief Parse an href under a ParsePolicy without throwing
+     * 
+     * @tparam Policy a ParsePolicy
+     * @param href URI string
+     * @return ParseResult<Uri> the parsed Uri, or the reason and offset at which href was rejected
+     */
+    template <class Policy>
+    inline ParseResult<Uri> try_parse(StringView href) {
+        detail::UriParts parts;
+        std::size_t error_offset;
+        parse_error error = detail::scan_with<Policy>(href.data(), href.size(), parts, error_offset);
+
+        if (error != parse_error::none) return ParseResult<Uri>(error, error_offset);
+        return ParseResult<Uri>(detail::UriAccess::make_uri(detail::href_string(href.data(), href.size()), parts));
+    }
+
+    /**
+     * @brief Get the port a URI connects to: its Port component, or else the default port of its scheme
+     * 
+     * @param uri parsed URI
+     * @return std::uint16_t the port; 0 for a relative URI or a scheme without a default port
+     */
+    inline std::uint16_t effective_port(const UriView& uri) {
+        return uri.hasPort() ? uri.getPortNumber() : default_port(uri.getScheme());
+    }
+}
@@ -0,0 +1,455 @@
+#pragma once
+#include "uri.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace uripp {
+    namespace detail {
+        /**
+         * @brief The five components of a URI reference as split by RFC 3986 Appendix B, with defined-but-empty
+         * components told apart from undefined ones
+         * 
+         */
+        struct ReferenceParts {
+            StringView scheme;
+            StringView authority;
+            StringView path;
+            StringView query;
+            StringView fragment;
+            bool has_scheme = false;
+            bool has_authority = false;
+            bool has_query = false;
+            bool has_fragment = false;
+        };
+
+        inline bool is_scheme_char(char c) {
+            return is_alnum(c) || c == '+' || c == '-' || c == '.';
+        }
+
+        /**
+         * @brief Splits a URI reference into its components without validating them
+         * 
+         * A scheme is only recognised when it is a valid RFC 3986 scheme, so "a b:c" is a path, not a scheme.
+         */
+        inline void split_reference(StringView ref, ReferenceParts& parts) {
+            const char* p = ref.begin();
+            const char* end = ref.end();
+            parts = ReferenceParts();
+
+            if (p < end && is_alnum(*p) && !is_digit(*p)) {
+                const char* s = p + 1;
+                while (s < end && is_scheme_char(*s)) ++s;
+                if (s < end && *s == ':') {
+                    parts.scheme = StringView(p, static_cast<std::size_t>(s - p));
+                    parts.has_scheme = true;
+                    p = s + 1;
+                }
+            }
+
+            if (end - p >= 2 && p[0] == '/' && p[1] == '/') {
+                const char* a = p + 2;
+                const char* a_end = find_first(a, end, ByteClass{{'/', '?', '#', '#'}, false});
+                parts.authority = StringView(a, static_cast<std::size_t>(a_end - a));
+                parts.has_authority = true;
+                p = a_end;
+            }
+
+            const char* path_end = find_first(p, end, ByteClass{{'?', '#', '#', '#'}, false});
+            parts.path = StringView(p, static_cast<std::size_t>(path_end - p));
+            p = path_end;
+
+            if (p < end && *p == '?') {
+                const char* q_end = static_cast<const char*>(std::memchr(p, '#', static_cast<std::size_t>(end - p)));
+                if (!q_end) q_end = end;
+                parts.query = StringView(p + 1, static_cast<std::size_t>(q_end - p - 1));
+                parts.has_query = true;
+                p = q_end;
+            }
+
+            if (p < end) {
+                parts.fragment = StringView(p + 1, static_cast<std::size_t>(end - p - 1));
+                parts.has_fragment = true;
+            }
+        }
+
+        inline bool is_dot_segment(const char* begin, const char* end) {
+            return (end - begin == 1 && begin[0] == '.') || (end - begin == 2 && begin[0] == '.' && begin[1] == '.');
+        }
+
+        /**
+         * @brief Indicates if a path has a "." or ".." segment, i.e. if remove_dot_segments can change it
+         * 
+         */
+        inline bool has_dot_segment(StringView path) {
+            const char* p = path.begin();
+            const char* end = path.end();
+
+            // Jump from '.' to '.'; most paths have none or only a file extension
+            while ((p = static_cast<const char*>(std::memchr(p, '.', static_cast<std::size_t>(end - p)))) != nullptr) {
+                if (p == path.begin() || p[-1] == '/') {
+                    const char* segment_end = p + 1;
+                    if (segment_end < end && *segment_end == '.') ++segment_end;
+                    if (segment_end == end || *segment_end == '/') return true;
+                }
+                ++p;
+            }
+            return false;
+        }
+
+        /**
+         * @brief The remove_dot_segments algorithm of RFC 3986 section 5.2.4, run in place
+         * 
+         * The output buffer starts at begin and currently ends at out; the input is [in, end), which must not start
+         * before out. Output never outgrows the input it consumes, so the input may be the tail of the same buffer.
+         * 
+         * @return char* end of the output
+         */
+        inline char* remove_dots(char* begin, char* out, const char* in, const char* end) {
+            while (in < end) {
+                std::size_t left = static_cast<std::size_t>(end - in);
+
+                // A: drop a leading "../" or "./"
+                if (left >= 3 && in[0] == '.' && in[1] == '.' && in[2] == '/') { in += 3; continue; }
+                if (left >= 2 && in[0] == '.' && in[1] == '/') { in += 2; continue; }
+
+                // B: "/./" and a final "/." become "/"
+                if (left >= 3 && in[0] == '/' && in[1] == '.' && in[2] == '/') { in += 2; continue; }
+                if (left == 2 && in[0] == '/' && in[1] == '.') {
+                    *out++ = '/';
+                    break;
+                }
+
+                // C: "/../" and a final "/.." become "/" and drop the last output segment
+                if (left >= 3 && in[0] == '/' && in[1] == '.' && in[2] == '.' && (left == 3 || in[3] == '/')) {
+                    while (out > begin && *--out != '/') {}
+                    if (left == 3) {
+                        *out++ = '/';
+                        break;
+                    }
+                    in += 3;
+                    continue;
+                }
+
+                // D: a final "." or ".." is dropped
+                if (is_dot_segment(in, end)) break;
+
+                // E: move the first segment, with its leading '/', to the output
+                const char* segment_end = in + 1;
+                while (segment_end < end && *segment_end != '/') ++segment_end;
+                std::size_t size = static_cast<std::size_t>(segment_end - in);
+                if (out != in) std::memmove(out, in, size);
+                out += size;
+                in = segment_end;
+            }
+
+            return out;
+        }
+    }
+
+    /**
+     * @brief Remove the "." and ".." segments of a path, as in RFC 3986 section 5.2.4
+     * 
+     * @param path path to clean
+     * @param out output buffer of at least path.size() characters; may be path.data()
+     * @return std::size_t size of the cleaned path
+     */
+    inline std::size_t remove_dot_segments(StringView path, char* out) {
+        return static_cast<std::size_t>(detail::remove_dots(out, out, path.begin(), path.end()) - out);
+    }
+
+    /**
+     * @brief Remove the "." and ".." segments of a path, as in RFC 3986 section 5.2.4
+     * 
+     * @param path path to clean
+     * @return std::string cleaned path
+     */
+    inline std::string remove_dot_segments(StringView path) {
+        std::string out(path.str());
+        if (!out.empty()) out.resize(remove_dot_segments(out, &out[0]));
+        return out;
+    }
+
+    /**
+     * @brief The hrefs written by UriResolver::resolveBatch, packed into one shared arena
+     * 
+     * clear() keeps the capacity of the arena, so a batch reused across documents stops allocating once it has grown
+     * to the largest one. Views returned by get() are invalidated by the next resolveBatch() or clear().
+     */
+    class ResolvedBatch {
+        public:
+        /**
+         * @brief Get the number of resolved hrefs
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return offsets.size();
+        }
+
+        /**
+         * @brief Get a resolved href
+         * 
+         * @param index index in the order the references were resolved
+         * @return StringView
+         */
+        StringView get(std::size_t index) const {
+            return StringView(arena.data() + offsets[index], lengths[index]);
+        }
+
+        /**
+         * @brief Get the arena holding all the resolved hrefs back to back
+         * 
+         * @return const std::string&
+         */
+        const std::string& getArena() const {
+            return arena;
+        }
+
+        /**
+         * @brief Drop all resolved hrefs, keeping the allocated capacity
+         * 
+         */
+        void clear() {
+            arena.clear();
+            offsets.clear();
+            lengths.clear();
+        }
+
+        private:
+        friend class UriResolver;
+
+        std::string arena;
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> lengths;
+    };
+
+    /**
+     * @brief Resolves URI references against a base URI, as in RFC 3986 section 5.2
+     * 
+     * The base is split and its merge directory examined once, in the constructor, so resolving many references found
+     * in the same document only splits each reference and writes the target. Resolution is strict: a reference with the
+     * same scheme as the base is not treated as relative. A resolver is immutable and may be shared between threads.
+     */
+    class UriResolver {
+        public:
+        /**
+         * @brief Construct a new UriResolver object
+         * 
+         * @param base absolute base URI; its fragment, if any, is ignored
+         * @throws std::invalid_argument if base is a relative URI
+         */
+        explicit UriResolver(const UriView& base) : href(base.getHref().str()) {
+            init();
+            if (base.isRelativeUri() || !this->base.has_scheme) {
+                URIPP_THROW(std::invalid_argument("The base of a reference resolution must be an absolute URI"));
+            }
+        }
+
+        /**
+         * @brief Construct a new UriResolver object
+         * 
+         * @param base absolute base URI; its fragment, if any, is ignored
+         * @throws std::invalid_argument if base is a relative URI
+         */
+        explicit UriResolver(const Uri& base) : UriResolver(base.view()) {}
+
+        // The split base points into href, so copies and moves re-split their own href
+        UriResolver(const UriResolver& other) : href(other.href) {
+            init();
+        }
+
+        UriResolver(UriResolver&& other) : href(std::move(other.href)) {
+            init();
+            other.init();
+        }
+
+        UriResolver& operator=(const UriResolver& other) {
+            href = other.href;
+            init();
+            return *this;
+        }
+
+        UriResolver& operator=(UriResolver&& other) {
+            href.swap(other.href);
+            init();
+            other.init();
+            return *this;
+        }
+
+        /**
+         * @brief Get the base href
+         * 
+         * @return StringView
+         */
+        StringView getBase() const {
+            return href;
+        }
+
+        /**
+         * @brief Get an upper bound on the size of the href resolveInto() writes for a reference
+         * 
+         * @param reference URI reference
+         * @return std::size_t
+         */
+        std::size_t maxResolvedSize(StringView reference) const {
+            return href.size() + reference.size() + 1;
+        }
+
+        /**
+         * @brief Resolve a reference into a caller-provided buffer
+         * 
+         * @param reference URI reference, e.g. the value of an href attribute
+         * @param out output buffer of at least maxResolvedSize(reference) characters
+         * @return std::size_t size of the resolved href
+         */
+        std::size_t resolveInto(StringView reference, char* out) const {
+            detail::ReferenceParts ref;
+            detail::split_reference(reference, ref);
+            char* o = out;
+
+            const detail::ReferenceParts& scheme_source = ref.has_scheme ? ref : base;
+            o = write(o, scheme_source.scheme);
+            *o++ = ':';
+
+            if (ref.has_scheme || ref.has_authority) {
+                if (ref.has_authority) {
+                    o = write(o, "//", 2);
+                    o = write(o, ref.authority);
+                }
+                o = detail::remove_dots(o, o, ref.path.begin(), ref.path.end());
+                if (ref.has_query) o = writeQuery(o, ref.query);
+            } else {
+                if (base.has_authority) {
+                    o = write(o, "//", 2);
+                    o = write(o, base.authority);
+                }
+
+                if (ref.path.empty()) {
+                    o = write(o, base.path);
+                    if (ref.has_query) o = writeQuery(o, ref.query);
+                    else if (base.has_query) o = writeQuery(o, base.query);
+                } else {
+                    if (ref.path[0] == '/') o = detail::remove_dots(o, o, ref.path.begin(), ref.path.end());
+                    else o = merge(o, ref.path);
+                    if (ref.has_query) o = writeQuery(o, ref.query);
+                }
+            }
+
+            if (ref.has_fragment) {
+                *o++ = '#';
+                o = write(o, ref.fragment);
+            }
+
+            return static_cast<std::size_t>(o - out);
+        }
+
+        /**
+         * @brief Resolve a reference into a Uri
+         * 
+         * @param reference URI reference, e.g. the value of an href attribute
+         * @return Uri the resolved URI
+         * @throws std::invalid_argument if the resolved href is not a valid absolute or relative URI
+         */
+        Uri resolve(StringView reference) const {
+            std::string out(maxResolvedSize(reference), '\0');
+            out.resize(resolveInto(reference, &out[0]));
+            return Uri(std::move(out));
+        }
+
+        /**
+         * @brief Resolve a batch of references, appending the resolved hrefs to a shared arena
+         * 
+         * The arena grows at most once per call, to fit the worst case of the whole batch.
+         * 
+         * @param references first reference
+         * @param count number of references
+         * @param out batch receiving one href per reference, in order
+         */
+        void resolveBatch(const StringView* references, std::size_t count, ResolvedBatch& out) const {
+            std::size_t used = out.arena.size();
+            std::size_t bound = used;
+            for (std::size_t i = 0; i < count; ++i) bound += maxResolvedSize(references[i]);
+
+            out.arena.resize(bound);
+            out.offsets.reserve(out.offsets.size() + count);
+            out.lengths.reserve(out.lengths.size() + count);
+
+            for (std::size_t i = 0; i < count; ++i) {
+                std::size_t size = resolveInto(references[i], &out.arena[0] + used);
+                out.offsets.push_back(static_cast<std::uint32_t>(used));
+                out.lengths.push_back(static_cast<std::uint32_t>(size));
+                used += size;
+            }
+
+            out.arena.resize(used);
+        }
+
+        /**
+         * @brief Resolve a batch of references, appending the resolved hrefs to a shared arena
+         * 
+         * @param references references; may be freed once the call returns
+         * @param out batch receiving one href per reference, in order
+         */
+        void resolveBatch(const std::vector<StringView>& references, ResolvedBatch& out) const {
+            resolveBatch(references.data(), references.size(), out);
+        }
+
+        private:
+        void init() {
+            detail::split_reference(href, base);
+            StringView path = base.path;
+
+            const char* last_slash = path.end();
+            while (last_slash > path.begin() && last_slash[-1] != '/') --last_slash;
+            directory_size = static_cast<std::size_t>(last_slash - path.begin());
+            directory_clean = !detail::has_dot_segment(StringView(path.data(), directory_size));
+        }
+
+        static char* write(char* out, const char* value, std::size_t size) {
+            std::memcpy(out, value, size);
+            return out + size;
+        }
+
+        static char* write(char* out, StringView value) {
+            return write(out, value.data(), value.size());
+        }
+
+        static char* writeQuery(char* out, StringView query) {
+            *out++ = '?';
+            return write(out, query);
+        }
+
+        /**
+         * @brief Writes remove_dot_segments(merge(base path, path)), as in RFC 3986 section 5.2.3
+         * 
+         * A base directory without dot segments comes out of remove_dot_segments unchanged, so it is copied and only
+         * the reference path is cleaned, with the last '/' of the directory as the start of its input.
+         */
+        char* merge(char* out, StringView path) const {
+            char* begin = out;
+
+            if (base.has_authority && base.path.empty()) {
+                *out++ = '/';
+            } else {
+                out = write(out, base.path.data(), directory_size);
+            }
+            out = write(out, path);
+
+            if (!directory_clean) return detail::remove_dots(begin, begin, begin, out);
+
+            char* resume = out - path.size();
+            if (resume > begin && resume[-1] == '/') --resume;
+            return detail::remove_dots(begin, resume, resume, out);
+        }
+
+        std::string href;
+        detail::ReferenceParts base;
+        std::size_t directory_size;
+        bool directory_clean;
+    };
+}
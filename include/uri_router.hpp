@@ -0,0 +1,477 @@
+#pragma once
+#include "uri.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace uripp {
+    namespace detail {
+        inline bool equals_ignore_case(StringView a, StringView b) {
+            if (a.size() != b.size()) return false;
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                if (to_lower(a[i]) != to_lower(b[i])) return false;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief The route a path matched and the values of its template variables, viewed in the matched href
+     * 
+     * Matching fills a RouteMatch in place, so it allocates nothing. The values refer to the matched characters and the
+     * names to the Router; both are valid until either changes.
+     */
+    class RouteMatch {
+        public:
+        /**
+         * @brief The most variables a route template can declare
+         */
+        static const std::size_t max_variables = 16;
+
+        /**
+         * @brief The route ID of a RouteMatch that matched nothing
+         */
+        static const std::size_t npos = static_cast<std::size_t>(-1);
+
+        RouteMatch() : names(nullptr), count(0), route(npos) {}
+
+        /**
+         * @brief Indicates if a route matched
+         * 
+         * @return true if getRoute() is a route ID
+         */
+        bool ok() const {
+            return route != npos;
+        }
+
+        explicit operator bool() const {
+            return ok();
+        }
+
+        /**
+         * @brief Get the ID of the matched route, as returned by Router::add()
+         * 
+         * @return std::size_t route ID, or npos if nothing matched
+         */
+        std::size_t getRoute() const {
+            return route;
+        }
+
+        /**
+         * @brief Get the number of variables captured
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return count;
+        }
+
+        /**
+         * @brief Get the name of a variable, without its braces
+         * 
+         * @param index variable index, in template order
+         * @return StringView
+         */
+        StringView getName(std::size_t index) const {
+            return names[index];
+        }
+
+        /**
+         * @brief Get the value of a variable, as it appears in the href
+         * 
+         * @param index variable index, in template order
+         * @return StringView
+         */
+        StringView getValue(std::size_t index) const {
+            return values[index];
+        }
+
+        /**
+         * @brief Indicates if the matched route declares a variable
+         * 
+         * @param name variable name
+         * @return true if declared
+         */
+        bool contains(StringView name) const {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (StringView(names[i]) == name) return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Get the value of a variable by name
+         * 
+         * @param name variable name
+         * @return StringView the value if the route declares name; otherwise an empty view
+         */
+        StringView get(StringView name) const {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (StringView(names[i]) == name) return values[i];
+            }
+            return StringView();
+        }
+
+        private:
+        friend class Router;
+
+        const std::string* names;
+        StringView values[max_variables];
+        std::size_t count;
+        std::size_t route;
+    };
+
+    /**
+     * @brief A set of path templates compiled into a segment trie, matched in one pass over a parsed path
+     * 
+     * A template is a path whose segments are literals, "{name}" variables that match one non-empty segment, or a final
+     * "{name*}" that matches the rest of the path, one segment or more. Literal segments are compared byte for byte,
+     * without percent-decoding, and a literal beats a variable, which beats a rest variable, backtracking if what
+     * follows does not match. Literal edges of every node share one hash table keyed by node and segment, so a lookup
+     * costs one probe per segment however many routes there are, though once the tables outgrow the CPU cache each
+     * probe is likely a cache miss.
+     * 
+     * A route can also be constrained to a scheme and a host, compared case-insensitively with those of the matched
+     * URI. Routes that end at the same node are tried in the order they were added.
+     */
+    class Router {
+        public:
+        Router() : nodes(1, Node()), edges(64, Edge()), edge_count(0) {}
+
+        /**
+         * @brief Compile a route into the router
+         * 
+         * @param path_template path template, e.g. "/api/v1/users/{id}/orders" or "/static/{file*}"
+         * @param scheme scheme the URI must have; empty for any
+         * @param host host the URI must have; empty for any
+         * @return std::size_t route ID reported by RouteMatch::getRoute()
+         * @throws std::invalid_argument if a segment has unbalanced braces, a variable is unnamed, a rest variable is
+         * not the last segment, or the template declares more than RouteMatch::max_variables variables
+         */
+        std::size_t add(StringView path_template, StringView scheme = StringView(), StringView host = StringView()) {
+            StringView declared[RouteMatch::max_variables];
+            std::size_t declared_count = 0;
+
+            // Validate before touching the trie, so a rejected template leaves the router as it was
+            PathSegments segments(path_template);
+            for (PathSegments::iterator it = segments.begin(); it != segments.end(); ++it) {
+                StringView name;
+                segment_kind kind = classify(*it, name);
+                if (kind == segment_kind::literal) continue;
+
+                PathSegments::iterator next = it;
+                if (kind == segment_kind::rest && ++next != segments.end()) {
+                    URIPP_THROW(std::invalid_argument("A rest variable must be the last segment of a route template"));
+                }
+                if (declared_count == RouteMatch::max_variables) {
+                    URIPP_THROW(std::invalid_argument("A route template declares too many variables"));
+                }
+                declared[declared_count++] = name;
+            }
+
+            std::uint32_t node = 0;
+            bool rest = false;
+            for (StringView segment : segments) {
+                StringView name;
+                switch (classify(segment, name)) {
+                    case segment_kind::literal:
+                        node = literalChild(node, segment);
+                        break;
+                    case segment_kind::variable:
+                        if (nodes[node].variable == none) {
+                            nodes.push_back(Node());
+                            nodes[node].variable = static_cast<std::uint32_t>(nodes.size() - 1);
+                        }
+                        node = nodes[node].variable;
+                        break;
+                    case segment_kind::rest:
+                        rest = true;
+                        break;
+                }
+            }
+
+            Route route;
+            route.next = none;
+            route.first_name = static_cast<std::uint32_t>(names.size());
+            route.scheme = constraint(scheme);
+            route.host = constraint(host);
+            for (std::size_t i = 0; i < declared_count; ++i) names.push_back(std::string(declared[i].data(), declared[i].size()));
+            templates.push_back(std::string(path_template.data(), path_template.size()));
+
+            std::uint32_t id = static_cast<std::uint32_t>(routes.size());
+            routes.push_back(route);
+            append(rest ? nodes[node].rest_routes : nodes[node].routes, id);
+            return id;
+        }
+
+        /**
+         * @brief Get the number of routes
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return routes.size();
+        }
+
+        /**
+         * @brief Get the template a route was added with
+         * 
+         * @param route route ID
+         * @return StringView
+         */
+        StringView getTemplate(std::size_t route) const {
+            return templates[route];
+        }
+
+        /**
+         * @brief Match the path, scheme and host of a parsed URI
+         * 
+         * @param uri parsed URI
+         * @param match receives the matched route and its variables
+         * @return true if a route matched
+         */
+        bool match(const UriView& uri, RouteMatch& match) const {
+            return run(uri.getPath(), uri.getScheme(), uri.getHost(), true, match);
+        }
+
+        /**
+         * @brief Match the path, scheme and host of a parsed URI
+         * 
+         * @param uri parsed URI; in parse_mode::lazy its authority is split here
+         * @param match receives the matched route and its variables
+         * @return true if a route matched
+         * @throws std::invalid_argument if the Authority component is not valid; only in lazy mode
+         */
+        bool match(const Uri& uri, RouteMatch& match) const {
+            return this->match(uri.view(), match);
+        }
+
+        /**
+         * @brief Match a bare path against the routes without a scheme or host constraint
+         * 
+         * @param path path component
+         * @param match receives the matched route and its variables
+         * @return true if a route matched
+         */
+        bool match(StringView path, RouteMatch& match) const {
+            return run(path, StringView(), StringView(), false, match);
+        }
+
+        private:
+        static const std::uint32_t none = UINT32_MAX;
+
+        enum class segment_kind {
+            literal,
+            variable,
+            rest
+        };
+
+        struct Node {
+            Node() : variable(none), routes(none), rest_routes(none) {}
+
+            std::uint32_t variable;
+            std::uint32_t routes;
+            std::uint32_t rest_routes;
+        };
+
+        /**
+         * @brief A literal edge of the trie; label_offset indexes labels, as the edges only move when the table grows
+         * 
+         */
+        struct Edge {
+            Edge() : from(none), to(none), hash(0), label_offset(0), label_size(0) {}
+
+            std::uint32_t from;
+            std::uint32_t to;
+            std::uint32_t hash;
+            std::uint32_t label_offset;
+            std::uint32_t label_size;
+        };
+
+        /**
+         * @brief A scheme or host constraint, viewed in constraint_text; an empty one matches any URI
+         * 
+         */
+        struct Constraint {
+            std::uint32_t offset;
+            std::uint32_t size;
+        };
+
+        /**
+         * @brief What matching reads of a route, kept apart from its template and names so a match touches 24 bytes
+         * 
+         */
+        struct Route {
+            std::uint32_t next;
+            std::uint32_t first_name;
+            Constraint scheme;
+            Constraint host;
+        };
+
+        /**
+         * @brief The state of one match, threaded through the backtracking walk
+         * 
+         */
+        struct Walk {
+            const char* path_end;
+            StringView scheme;
+            StringView host;
+            bool has_uri;
+            RouteMatch* match;
+        };
+
+        static segment_kind classify(StringView segment, StringView& name) {
+            bool open = !segment.empty() && segment[0] == '{';
+            bool close = !segment.empty() && segment[segment.size() - 1] == '}';
+
+            if (!open && !close) {
+                if (hasBrace(segment)) {
+                    URIPP_THROW(std::invalid_argument("A route template segment must be a literal or a whole {variable}"));
+                }
+                return segment_kind::literal;
+            }
+            if (!open || !close || segment.size() < 3) {
+                URIPP_THROW(std::invalid_argument("A route template variable must be a non-empty {name}"));
+            }
+
+            name = segment.substr(1, segment.size() - 2);
+            bool rest = name[name.size() - 1] == '*';
+            if (rest) name = name.substr(0, name.size() - 1);
+            if (name.empty() || hasBrace(name)) {
+                URIPP_THROW(std::invalid_argument("A route template variable must be a non-empty {name}"));
+            }
+            return rest ? segment_kind::rest : segment_kind::variable;
+        }
+
+        static bool hasBrace(StringView text) {
+            return std::memchr(text.data(), '{', text.size()) || std::memchr(text.data(), '}', text.size());
+        }
+
+        static std::uint32_t edgeHash(std::uint32_t from, StringView label) {
+            return detail::hash_key(label, false) ^ (from * 0x9E3779B1u);
+        }
+
+        StringView label(const Edge& edge) const {
+            return StringView(labels.data() + edge.label_offset, edge.label_size);
+        }
+
+        std::uint32_t findEdge(std::uint32_t from, StringView segment) const {
+            std::uint32_t hash = edgeHash(from, segment);
+            std::size_t mask = edges.size() - 1;
+            for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+                const Edge& edge = edges[i];
+                if (edge.from == none) return none;
+                if (edge.hash == hash && edge.from == from && label(edge) == segment) return edge.to;
+            }
+        }
+
+        std::uint32_t literalChild(std::uint32_t from, StringView segment) {
+            std::uint32_t to = findEdge(from, segment);
+            if (to != none) return to;
+
+            if ((edge_count + 1) * 2 > edges.size()) grow();
+
+            nodes.push_back(Node());
+            Edge edge;
+            edge.from = from;
+            edge.to = static_cast<std::uint32_t>(nodes.size() - 1);
+            edge.hash = edgeHash(from, segment);
+            edge.label_offset = static_cast<std::uint32_t>(labels.size());
+            edge.label_size = static_cast<std::uint32_t>(segment.size());
+            labels.append(segment.data(), segment.size());
+            place(edge);
+            ++edge_count;
+            return edge.to;
+        }
+
+        void place(const Edge& edge) {
+            std::size_t mask = edges.size() - 1;
+            std::size_t i = edge.hash & mask;
+            while (edges[i].from != none) i = (i + 1) & mask;
+            edges[i] = edge;
+        }
+
+        void grow() {
+            std::vector<Edge> old;
+            old.swap(edges);
+            edges.assign(old.size() * 2, Edge());
+            for (const Edge& edge : old) {
+                if (edge.from != none) place(edge);
+            }
+        }
+
+        Constraint constraint(StringView text) {
+            Constraint c = {static_cast<std::uint32_t>(constraint_text.size()), static_cast<std::uint32_t>(text.size())};
+            constraint_text.append(text.data(), text.size());
+            return c;
+        }
+
+        bool satisfies(const Constraint& c, const Walk& walk, StringView actual) const {
+            return c.size == 0 || (walk.has_uri && detail::equals_ignore_case(StringView(constraint_text.data() + c.offset, c.size), actual));
+        }
+
+        void append(std::uint32_t& head, std::uint32_t id) {
+            std::uint32_t* link = &head;
+            while (*link != none) link = &routes[*link].next;
+            *link = id;
+        }
+
+        bool run(StringView path, StringView scheme, StringView host, bool has_uri, RouteMatch& match) const {
+            match.route = RouteMatch::npos;
+            match.count = 0;
+            match.names = nullptr;
+
+            Walk walk = {path.end(), scheme, host, has_uri, &match};
+            PathSegments segments(path);
+            return visit(walk, 0, segments.begin(), 0);
+        }
+
+        bool accept(const Walk& walk, std::uint32_t head, std::size_t count) const {
+            for (std::uint32_t id = head; id != none; id = routes[id].next) {
+                const Route& route = routes[id];
+                if (!satisfies(route.scheme, walk, walk.scheme) || !satisfies(route.host, walk, walk.host)) continue;
+
+                walk.match->route = id;
+                walk.match->count = count;
+                walk.match->names = names.data() + route.first_name;
+                return true;
+            }
+            return false;
+        }
+
+        bool visit(const Walk& walk, std::uint32_t node, PathSegments::iterator it, std::size_t count) const {
+            const Node& n = nodes[node];
+            if (it == PathSegments::iterator()) return accept(walk, n.routes, count);
+
+            StringView segment = *it;
+            PathSegments::iterator next = it;
+            ++next;
+
+            std::uint32_t literal = findEdge(node, segment);
+            if (literal != none && visit(walk, literal, next, count)) return true;
+
+            if (n.variable != none && !segment.empty()) {
+                walk.match->values[count] = segment;
+                if (visit(walk, n.variable, next, count + 1)) return true;
+            }
+
+            if (n.rest_routes != none) {
+                walk.match->values[count] = StringView(segment.data(), static_cast<std::size_t>(walk.path_end - segment.data()));
+                if (accept(walk, n.rest_routes, count + 1)) return true;
+            }
+            return false;
+        }
+
+        std::vector<Node> nodes;
+        std::vector<Edge> edges;
+        std::vector<Route> routes;
+        std::vector<std::string> templates;
+        std::vector<std::string> names;
+        std::string labels;
+        std::string constraint_text;
+        std::size_t edge_count;
+    };
+}
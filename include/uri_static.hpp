@@ -0,0 +1,192 @@
+#pragma once
+#include "uri.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace uripp {
+    /**
+     * @brief A URI over a string literal, parsed in a constant expression from C++14 on
+     * 
+     * Declared constexpr, as in `constexpr StaticUri health = "http://localhost:8080/health"_uri;`, a StaticUri costs
+     * nothing at startup, an invalid href fails to compile, and its components are compile-time constants. From C++17
+     * on they also compare with string literals in constant expressions. Before C++14 it is parsed when constructed.
+     */
+    class StaticUri {
+        public:
+        /**
+         * @brief Construct a new StaticUri over a character range
+         * 
+         * @param data first character of the href; must outlive the StaticUri, as a string literal does
+         * @param size number of characters
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI; a compile error in a constant expression
+         */
+        URIPP_CONSTEXPR14 StaticUri(const char* data, std::size_t size) : href(data), href_size(size), parts(scan(data, size)) {}
+
+        /**
+         * @brief Get the href
+         * 
+         * @return StringView
+         */
+        URIPP_CONSTEXPR14 StringView getHref() const {
+            return StringView(href, href_size);
+        }
+
+        /**
+         * @brief Get the Scheme component of an absolute URI
+         * 
+         * @return StringView Scheme component; empty for a relative URI
+         */
+        URIPP_CONSTEXPR14 StringView getScheme() const {
+            return part(detail::part_scheme);
+        }
+
+        /**
+         * @brief Get the Authority component of an absolute URI
+         * 
+         * @return StringView Authority component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getAuthority() const {
+            return part(detail::part_authority);
+        }
+
+        /**
+         * @brief Get the Path component of the absolute or relative URI
+         * 
+         * @return StringView Path component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getPath() const {
+            return part(detail::part_path);
+        }
+
+        /**
+         * @brief Get the Query component of the absolute or relative URI
+         * 
+         * @return StringView Query component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getQuery() const {
+            return part(detail::part_query);
+        }
+
+        /**
+         * @brief Get the Fragment component of the absolute or relative URI
+         * 
+         * @return StringView Fragment component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getFragment() const {
+            return part(detail::part_fragment);
+        }
+
+        /**
+         * @brief Get the Username component of the Authority component
+         * 
+         * @return StringView Username component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getUsername() const {
+            return part(detail::part_username);
+        }
+
+        /**
+         * @brief Get the Password component of the Authority component
+         * 
+         * @return StringView Password component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getPassword() const {
+            return part(detail::part_password);
+        }
+
+        /**
+         * @brief Get the Host component of the Authority component
+         * 
+         * @return StringView Host component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getHost() const {
+            return part(detail::part_host);
+        }
+
+        /**
+         * @brief Get the Port component of the Authority component
+         * 
+         * @return StringView Port component if available; otherwise an empty view
+         */
+        URIPP_CONSTEXPR14 StringView getPort() const {
+            return part(detail::part_port);
+        }
+
+        /**
+         * @brief Get the Port component of the Authority component as a number
+         * 
+         * @return std::uint16_t Port component if available; otherwise 0
+         */
+        URIPP_CONSTEXPR14 std::uint16_t getPortNumber() const {
+            return detail::port_number(part(detail::part_port));
+        }
+
+        /**
+         * @brief Get the kind of the Host component
+         * 
+         * @return host_type kind of Host if available; otherwise host_type::none
+         */
+        URIPP_CONSTEXPR14 host_type getHostType() const {
+            return detail::classify_host(part(detail::part_host));
+        }
+
+        URIPP_CONSTEXPR14 bool hasAuthority() const { return parts.has(detail::part_authority); }
+        URIPP_CONSTEXPR14 bool hasQuery() const { return parts.has(detail::part_query); }
+        URIPP_CONSTEXPR14 bool hasFragment() const { return parts.has(detail::part_fragment); }
+        URIPP_CONSTEXPR14 bool hasUsername() const { return parts.has(detail::part_username); }
+        URIPP_CONSTEXPR14 bool hasPassword() const { return parts.has(detail::part_password); }
+        URIPP_CONSTEXPR14 bool hasPort() const { return parts.has(detail::part_port); }
+        URIPP_CONSTEXPR14 bool isRelativeUri() const { return (parts.flags & detail::flag_relative) != 0; }
+
+        /**
+         * @brief Get a view of the URI, to pass it where a UriView is taken
+         * 
+         * @return UriView
+         */
+        UriView view() const {
+            return detail::UriAccess::make_view(getHref(), parts);
+        }
+
+        /**
+         * @brief Copy the href into an owning Uri without parsing it again
+         * 
+         * @return Uri owning copy of the URI
+         */
+        Uri toUri() const {
+            return view().toUri();
+        }
+
+        private:
+        static URIPP_CONSTEXPR14 detail::UriParts scan(const char* data, std::size_t size) {
+            detail::UriParts parts = detail::UriParts();
+            std::size_t error_offset = 0;
+            parse_error error = detail::scan_uri<detail::ConstantScan>(data, size, parts, error_offset);
+            if (error == parse_error::invalid_authority || error == parse_error::invalid_host || error == parse_error::invalid_port) {
+                URIPP_THROW(std::invalid_argument("The authority component of href is not valid"));
+            }
+            if (error != parse_error::none) URIPP_THROW(std::invalid_argument("The provided href is not a valid absolute or relative URI"));
+            return parts;
+        }
+
+        URIPP_CONSTEXPR14 StringView part(detail::part_index index) const {
+            return parts.has(index) ? StringView(href + parts.offset[index], parts.length[index]) : StringView();
+        }
+
+        const char* href;
+        std::size_t href_size;
+        detail::UriParts parts;
+    };
+
+    inline namespace literals {
+        /**
+         * @brief Parse a string literal into a StaticUri, e.g. `"https://example.com/"_uri`
+         * 
+         * @return StaticUri
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI; a compile error in a constant expression
+         */
+        URIPP_CONSTEXPR14 StaticUri operator"" _uri(const char* data, std::size_t size) {
+            return StaticUri(data, size);
+        }
+    }
+}
@@ -0,0 +1,524 @@
+#pragma once
+#include "uri.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace uripp {
+    /**
+     * @brief A bump allocator that hands out memory from large blocks and frees it all at once
+     * 
+     * deallocate() is a no-op; memory is given back by release() or when the arena is destroyed. As a
+     * UriMemoryResource, an arena can back Uri objects directly: Uri(href, arena) or try_parse(href, arena).
+     */
+    class UriArena : public UriMemoryResource {
+        public:
+        /**
+         * @brief Construct a new UriArena object
+         * 
+         * @param block_size size of the blocks memory is carved from; requests over a quarter of it get a block of their own; default 1 MiB
+         */
+        explicit UriArena(std::size_t block_size = 1 << 20)
+            : block_size(block_size ? block_size : 1), cursor(nullptr), limit(nullptr), allocated(0), reserved(0) {}
+
+        UriArena(const UriArena&) = delete;
+        UriArena& operator=(const UriArena&) = delete;
+
+        void* allocate(std::size_t bytes, std::size_t alignment) override {
+            std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(cursor) + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+            if (!cursor || p + bytes > reinterpret_cast<std::uintptr_t>(limit)) return allocateSlow(bytes, alignment);
+
+            cursor = reinterpret_cast<char*>(p + bytes);
+            allocated += bytes;
+            return reinterpret_cast<void*>(p);
+        }
+
+        void deallocate(void*, std::size_t, std::size_t) override {}
+
+        /**
+         * @brief Free every block at once, invalidating all memory handed out
+         * 
+         */
+        void release() {
+            blocks.clear();
+            cursor = limit = nullptr;
+            allocated = reserved = 0;
+        }
+
+        /**
+         * @brief Get the number of bytes handed out since the last release()
+         * 
+         * @return std::size_t
+         */
+        std::size_t getBytesAllocated() const {
+            return allocated;
+        }
+
+        /**
+         * @brief Get the number of bytes held in blocks
+         * 
+         * @return std::size_t
+         */
+        std::size_t getBytesReserved() const {
+            return reserved;
+        }
+
+        /**
+         * @brief Get the number of blocks held
+         * 
+         * @return std::size_t
+         */
+        std::size_t getBlockCount() const {
+            return blocks.size();
+        }
+
+        private:
+        void* allocateSlow(std::size_t bytes, std::size_t alignment) {
+            if (bytes + alignment > block_size / 4) {
+                // Keep the current block for the small requests that follow
+                char* block = newBlock(bytes + alignment);
+                std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(block) + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+                allocated += bytes;
+                return reinterpret_cast<void*>(p);
+            }
+
+            cursor = newBlock(block_size);
+            limit = cursor + block_size;
+            return allocate(bytes, alignment);
+        }
+
+        char* newBlock(std::size_t size) {
+            blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+            reserved += size;
+            return blocks.back().get();
+        }
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        std::size_t block_size;
+        char* cursor;
+        char* limit;
+        std::size_t allocated;
+        std::size_t reserved;
+    };
+
+    /**
+     * @brief A compact reference to a URI held by a UriStore
+     * 
+     */
+    struct UriHandle {
+        std::uint32_t index;
+
+        bool operator==(const UriHandle& other) const { return index == other.index; }
+        bool operator!=(const UriHandle& other) const { return index != other.index; }
+    };
+
+    /**
+     * @brief Memory statistics of a UriStore
+     * 
+     */
+    struct UriStoreStats {
+        /**
+         * @brief Number of URIs held
+         */
+        std::size_t uris;
+
+        /**
+         * @brief Total size of the hrefs added
+         */
+        std::size_t href_bytes;
+
+        /**
+         * @brief Bytes of href text in the arena: the distinct interned prefixes plus the rest of every href
+         */
+        std::size_t text_bytes;
+
+        /**
+         * @brief Number of distinct interned prefixes
+         */
+        std::size_t interned_prefixes;
+
+        /**
+         * @brief Bytes handed out by the arena, text and component tables included
+         */
+        std::size_t arena_allocated;
+
+        /**
+         * @brief Bytes held in arena blocks
+         */
+        std::size_t arena_reserved;
+
+        /**
+         * @brief Number of arena blocks
+         */
+        std::size_t arena_blocks;
+
+        /**
+         * @brief Heap bytes of the handle and intern tables, outside the arena
+         */
+        std::size_t table_bytes;
+    };
+
+    /**
+     * @brief An arena-backed store of parsed URIs, addressed by 32-bit handles
+     * 
+     * The href of every URI and its component table are bump-allocated from a UriArena, so adding a URI costs no heap
+     * allocation of its own and clear() frees everything at once. With prefix interning on, the "scheme:" or
+     * "scheme://authority" prefix of an absolute URI is stored once and shared by every URI that starts with it; only
+     * the path, query and fragment are stored per URI. The href of such a URI is then split in two, so it is read
+     * through get() and copyHref() rather than view().
+     */
+    class UriStore {
+        public:
+        /**
+         * @brief Construct a new UriStore object
+         * 
+         * @param intern_prefixes share the scheme and authority of absolute URIs between URIs; default false
+         * @param block_size size of the arena blocks; default 1 MiB
+         */
+        explicit UriStore(bool intern_prefixes = false, std::size_t block_size = 1 << 20)
+            : arena(block_size), intern_prefixes(intern_prefixes), count(0), href_bytes(0), text_bytes(0) {}
+
+        UriStore(const UriStore&) = delete;
+        UriStore& operator=(const UriStore&) = delete;
+
+        /**
+         * @brief Parse an href and add it to the store
+         * 
+         * @param href URI characters; copied into the store
+         * @return UriHandle handle of the URI
+         * @throws std::invalid_argument if cannot parse URI or Authority component of absolute URI
+         */
+        UriHandle add(StringView href) {
+            ParseResult<UriHandle> result = tryAdd(href);
+            if (!result.ok()) detail::throw_parse_error(result.getError());
+            return result.getUri();
+        }
+
+        /**
+         * @brief Add an already parsed URI to the store without parsing it again
+         * 
+         * @param uri parsed URI; its characters are copied into the store
+         * @return UriHandle handle of the URI
+         */
+        UriHandle add(const UriView& uri) {
+            return insert(uri.getHref(), detail::UriAccess::parts(uri));
+        }
+
+        /**
+         * @brief Parse an href and add it to the store without throwing
+         * 
+         * @param href URI characters; copied into the store if valid
+         * @return ParseResult<UriHandle> handle of the URI, or the reason and offset at which href was rejected
+         */
+        ParseResult<UriHandle> tryAdd(StringView href) {
+            detail::UriParts parts;
+            std::size_t error_offset;
+            parse_error error = detail::scan_uri(href.data(), href.size(), parts, error_offset);
+
+            if (error != parse_error::none) return ParseResult<UriHandle>(error, error_offset);
+            return ParseResult<UriHandle>(insert(href, parts));
+        }
+
+        /**
+         * @brief Get the number of URIs held
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return count;
+        }
+
+        /**
+         * @brief Indicates if a component is present
+         * 
+         * @param handle URI handle
+         * @param comp component ID
+         * @return true if present
+         */
+        bool has(UriHandle handle, uri_components comp) const {
+            return (record(handle).flags & (1u << int(comp))) != 0;
+        }
+
+        /**
+         * @brief Get a component
+         * 
+         * @param handle URI handle
+         * @param comp component ID
+         * @return StringView the component if present; otherwise an empty view
+         */
+        StringView get(UriHandle handle, uri_components comp) const {
+            const Record& r = record(handle);
+            int part = int(comp);
+            if (!(r.flags & (1u << part))) return StringView();
+
+            std::uint32_t offset = r.offset[part];
+            std::uint32_t length = r.length[part];
+            if (r.flags & flag_wide) {
+                const detail::UriParts& wide = wide_parts[wideIndex(r)];
+                offset = wide.offset[part];
+                length = wide.length[part];
+            }
+
+            StringView prefix = prefixOf(r);
+            const char* text = offset < prefix.size() ? prefix.data() + offset : r.tail + (offset - prefix.size());
+            return StringView(text, length);
+        }
+
+        /**
+         * @brief Indicates if a URI is relative
+         * 
+         * @param handle URI handle
+         * @return true if relative URI
+         */
+        bool isRelativeUri(UriHandle handle) const {
+            return (record(handle).flags & detail::flag_relative) != 0;
+        }
+
+        /**
+         * @brief Get the size of the href of a URI
+         * 
+         * @param handle URI handle
+         * @return std::size_t
+         */
+        std::size_t hrefSize(UriHandle handle) const {
+            const Record& r = record(handle);
+            return prefixOf(r).size() + r.tail_size;
+        }
+
+        /**
+         * @brief Copy the href of a URI into a caller-provided buffer
+         * 
+         * @param handle URI handle
+         * @param out output buffer of at least hrefSize(handle) characters
+         * @return std::size_t number of characters written
+         */
+        std::size_t copyHref(UriHandle handle, char* out) const {
+            const Record& r = record(handle);
+            StringView prefix = prefixOf(r);
+            std::memcpy(out, prefix.data(), prefix.size());
+            std::memcpy(out + prefix.size(), r.tail, r.tail_size);
+            return prefix.size() + r.tail_size;
+        }
+
+        /**
+         * @brief Get the href of a URI
+         * 
+         * @param handle URI handle
+         * @return std::string
+         */
+        std::string getHref(UriHandle handle) const {
+            std::string href(hrefSize(handle), '\0');
+            if (!href.empty()) copyHref(handle, &href[0]);
+            return href;
+        }
+
+        /**
+         * @brief Get a view over a URI held in the store, without copying
+         * 
+         * @param handle URI handle
+         * @return UriView view valid until clear() or the store is destroyed
+         * @throws std::domain_error if the store interns prefixes, which splits hrefs
+         */
+        UriView view(UriHandle handle) const {
+            if (intern_prefixes) URIPP_THROW(std::domain_error("A UriStore that interns prefixes does not hold contiguous hrefs"));
+            const Record& r = record(handle);
+            return detail::UriAccess::make_view(StringView(r.tail, r.tail_size), partsOf(r));
+        }
+
+        /**
+         * @brief Copy a URI out of the store
+         * 
+         * @param handle URI handle
+         * @return Uri owning copy
+         */
+        Uri toUri(UriHandle handle) const {
+            detail::href_string href(hrefSize(handle), '\0');
+            if (!href.empty()) copyHref(handle, &href[0]);
+            return detail::UriAccess::make_uri(std::move(href), partsOf(record(handle)));
+        }
+
+        /**
+         * @brief Copy a URI out of the store into a Uri allocated from a memory resource
+         * 
+         * @param handle URI handle
+         * @param resource resource to allocate the href from; must outlive the Uri
+         * @return Uri owning copy
+         */
+        Uri toUri(UriHandle handle, UriMemoryResource& resource) const {
+            detail::href_string href(hrefSize(handle), '\0', detail::ResourceAllocator<char>(&resource));
+            if (!href.empty()) copyHref(handle, &href[0]);
+            return detail::UriAccess::make_uri(std::move(href), partsOf(record(handle)));
+        }
+
+        /**
+         * @brief Free every URI at once, invalidating all handles and views
+         * 
+         */
+        void clear() {
+            arena.release();
+            chunks.clear();
+            slots.clear();
+            prefixes.clear();
+            wide_parts.clear();
+            count = href_bytes = text_bytes = 0;
+        }
+
+        /**
+         * @brief Get the memory statistics of the store
+         * 
+         * @return UriStoreStats
+         */
+        UriStoreStats getStats() const {
+            UriStoreStats stats;
+            stats.uris = count;
+            stats.href_bytes = href_bytes;
+            stats.text_bytes = text_bytes;
+            stats.interned_prefixes = prefixes.size();
+            stats.arena_allocated = arena.getBytesAllocated();
+            stats.arena_reserved = arena.getBytesReserved();
+            stats.arena_blocks = arena.getBlockCount();
+            stats.table_bytes = chunks.capacity() * sizeof(Record*) + slots.capacity() * sizeof(Slot) +
+                                prefixes.capacity() * sizeof(StringView) + wide_parts.capacity() * sizeof(detail::UriParts);
+            return stats;
+        }
+
+        private:
+        static const std::size_t chunk_shift = 10;
+        static const std::size_t chunk_size = std::size_t(1) << chunk_shift;
+
+        // Set in Record::flags when the component table did not fit in 16 bits and lives in wide_parts
+        static const std::uint16_t flag_wide = 1u << 15;
+
+        /**
+         * @brief The stored form of a URI: 56 bytes, with a 16-bit component table for hrefs under 64 KiB
+         * 
+         */
+        struct Record {
+            const char* tail;
+            std::uint32_t prefix;
+            std::uint32_t tail_size;
+            std::uint16_t offset[detail::part_count];
+            std::uint16_t length[detail::part_count];
+            std::uint16_t flags;
+        };
+
+        struct Slot {
+            std::uint32_t prefix;
+            std::uint32_t hash;
+        };
+
+        const Record& record(UriHandle handle) const {
+            return chunks[handle.index >> chunk_shift][handle.index & (chunk_size - 1)];
+        }
+
+        StringView prefixOf(const Record& r) const {
+            return r.prefix ? prefixes[r.prefix - 1] : StringView();
+        }
+
+        static std::uint32_t wideIndex(const Record& r) {
+            return r.offset[0] | (static_cast<std::uint32_t>(r.offset[1]) << 16);
+        }
+
+        detail::UriParts partsOf(const Record& r) const {
+            if (r.flags & flag_wide) return wide_parts[wideIndex(r)];
+
+            detail::UriParts parts;
+            for (int i = 0; i < detail::part_count; ++i) {
+                parts.offset[i] = r.offset[i];
+                parts.length[i] = r.length[i];
+            }
+            parts.flags = r.flags;
+            return parts;
+        }
+
+        UriHandle insert(StringView href, const detail::UriParts& parts) {
+            if ((count & (chunk_size - 1)) == 0) {
+                chunks.push_back(static_cast<Record*>(arena.allocate(chunk_size * sizeof(Record), alignof(Record))));
+            }
+
+            Record& r = chunks.back()[count & (chunk_size - 1)];
+            r.flags = parts.flags;
+            if (href.size() <= UINT16_MAX) {
+                for (int i = 0; i < detail::part_count; ++i) {
+                    r.offset[i] = static_cast<std::uint16_t>(parts.offset[i]);
+                    r.length[i] = static_cast<std::uint16_t>(parts.length[i]);
+                }
+            } else {
+                r.offset[0] = static_cast<std::uint16_t>(wide_parts.size());
+                r.offset[1] = static_cast<std::uint16_t>(wide_parts.size() >> 16);
+                r.flags = static_cast<std::uint16_t>(r.flags | flag_wide);
+                wide_parts.push_back(parts);
+            }
+
+            r.prefix = 0;
+            std::size_t split = 0;
+            if (intern_prefixes && (parts.flags & detail::flag_absolute)) {
+                split = parts.offset[detail::part_path];
+                r.prefix = intern(href.substr(0, split));
+            }
+
+            r.tail_size = static_cast<std::uint32_t>(href.size() - split);
+            r.tail = copy(href.substr(split));
+
+            href_bytes += href.size();
+            return UriHandle{static_cast<std::uint32_t>(count++)};
+        }
+
+        const char* copy(StringView text) {
+            char* stored = static_cast<char*>(arena.allocate(text.size() ? text.size() : 1, 1));
+            std::memcpy(stored, text.data(), text.size());
+            text_bytes += text.size();
+            return stored;
+        }
+
+        /**
+         * @brief Finds or stores a prefix in an open-addressing table
+         * 
+         * @return std::uint32_t 1-based index of the prefix in prefixes
+         */
+        std::uint32_t intern(StringView prefix) {
+            if (prefixes.size() * 2 >= slots.size()) grow();
+
+            std::uint32_t hash = detail::hash_key(prefix, false);
+            std::size_t mask = slots.size() - 1;
+            for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+                Slot& slot = slots[i];
+                if (!slot.prefix) {
+                    prefixes.push_back(StringView(copy(prefix), prefix.size()));
+                    slot.prefix = static_cast<std::uint32_t>(prefixes.size());
+                    slot.hash = hash;
+                    return slot.prefix;
+                }
+                if (slot.hash == hash && prefixes[slot.prefix - 1] == prefix) return slot.prefix;
+            }
+        }
+
+        void grow() {
+            std::vector<Slot> old;
+            old.swap(slots);
+            slots.assign(old.empty() ? 64 : old.size() * 2, Slot{0, 0});
+
+            std::size_t mask = slots.size() - 1;
+            for (const Slot& slot : old) {
+                if (!slot.prefix) continue;
+                std::size_t i = slot.hash & mask;
+                while (slots[i].prefix) i = (i + 1) & mask;
+                slots[i] = slot;
+            }
+        }
+
+        UriArena arena;
+        std::vector<Record*> chunks;
+        std::vector<Slot> slots;
+        std::vector<StringView> prefixes;
+        std::vector<detail::UriParts> wide_parts;
+        bool intern_prefixes;
+        std::size_t count;
+        std::size_t href_bytes;
+        std::size_t text_bytes;
+    };
+}
@@ -0,0 +1,409 @@
+#pragma once
+#include "uri.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace uripp {
+    /**
+     * @brief The progress of a UriStreamParser
+     * 
+     */
+    enum class stream_status {
+        /**
+         * @brief The URI may continue; feed more characters or call finish()
+         */
+        need_more,
+
+        /**
+         * @brief A whole URI was parsed
+         */
+        done,
+
+        /**
+         * @brief The URI was rejected; see getError()
+         */
+        error
+    };
+
+    /**
+     * @brief A push parser for an href that arrives in pieces, e.g. a request-target split across network reads
+     * 
+     * Characters are appended to one buffer, kept from one href to the next, and scanned as they arrive: the parser
+     * keeps its position in the grammar and the spans found so far between calls, so no character is scanned twice and
+     * an invalid one is reported as soon as it can be. The href ends at one of up to four terminator
+     * characters, such as the ' ' after an HTTP request-target, or at finish(). The result is the same as parsing the
+     * whole href at once.
+     */
+    class UriStreamParser {
+        public:
+        /**
+         * @brief The default maximum href length, in characters
+         */
+        static const std::size_t default_max_length = 8192;
+
+        /**
+         * @brief Construct a new UriStreamParser
+         * 
+         * @param max_length longest href accepted; the buffer never grows past it
+         * @param terminators up to four characters that end the href, none of them part of it; default none
+         * @throws std::invalid_argument if there are more than four terminators
+         */
+        explicit UriStreamParser(std::size_t max_length = default_max_length, StringView terminators = StringView())
+            : UriStreamParser(max_length, terminators, *default_resource()) {}
+
+        /**
+         * @brief Construct a new UriStreamParser that allocates its buffer, and the href of the parsed Uri, from a memory resource
+         * 
+         * @param max_length longest href accepted; the buffer never grows past it
+         * @param terminators up to four characters that end the href, none of them part of it
+         * @param resource resource to allocate from, e.g. a UriArena; must outlive the parser and every Uri it releases
+         * @throws std::invalid_argument if there are more than four terminators
+         */
+        UriStreamParser(std::size_t max_length, StringView terminators, UriMemoryResource& resource)
+            : max_length(max_length < UINT32_MAX ? max_length : UINT32_MAX), terminated(!terminators.empty()),
+              buffer(detail::ResourceAllocator<char>(&resource)) {
+            if (terminators.size() > 4) URIPP_THROW(std::invalid_argument("A UriStreamParser takes at most four terminators"));
+            for (std::size_t i = 0; i < 4; ++i) {
+                terminator.delimiters[i] = terminated ? terminators[i < terminators.size() ? i : 0] : '\0';
+            }
+            terminator.invalid = false;
+            reset();
+        }
+
+        /**
+         * @brief Feed the next characters of the href
+         * 
+         * Characters after a terminator are not consumed; getConsumed() tells where they start.
+         * 
+         * @param chunk next characters; only read during the call
+         * @return stream_status done if a terminator ended the href, error if it was rejected, otherwise need_more
+         */
+        stream_status feed(StringView chunk) {
+            consumed = 0;
+            if (status != stream_status::need_more) return status;
+
+            const char* end = terminated ? detail::find_first(chunk.begin(), chunk.end(), terminator) : chunk.end();
+            std::size_t take = static_cast<std::size_t>(end - chunk.begin());
+
+            if (take > max_length - buffer.size()) {
+                fail(parse_error::too_long, max_length);
+                return status;
+            }
+            buffer.append(chunk.data(), take);
+            consumed = take;
+
+            advance(end != chunk.end());
+            return status;
+        }
+
+        /**
+         * @brief End the href at the characters fed so far
+         * 
+         * @return stream_status done, or error if the href was rejected
+         */
+        stream_status finish() {
+            consumed = 0;
+            if (status != stream_status::need_more) return status;
+
+            advance(true);
+            return status;
+        }
+
+        /**
+         * @brief Get the progress of the parser
+         * 
+         * @return stream_status
+         */
+        stream_status getStatus() const {
+            return status;
+        }
+
+        /**
+         * @brief Get the number of characters of the last chunk that were taken into the href
+         * 
+         * @return std::size_t the whole chunk while need_more; the position of the terminator once done
+         */
+        std::size_t getConsumed() const {
+            return consumed;
+        }
+
+        /**
+         * @brief Get the number of characters buffered so far
+         * 
+         * @return std::size_t
+         */
+        std::size_t size() const {
+            return buffer.size();
+        }
+
+        /**
+         * @brief Get the reason the href was rejected
+         * 
+         * @return parse_error parse_error::none unless the status is error; too_long if the href outgrew the maximum length
+         */
+        parse_error getError() const {
+            return error;
+        }
+
+        /**
+         * @brief Get the byte offset in the href at which it was rejected
+         * 
+         * @return std::size_t 0 unless the status is error
+         */
+        std::size_t getErrorOffset() const {
+            return error_offset;
+        }
+
+        /**
+         * @brief Get a view of the parsed URI, over the buffer of the parser
+         * 
+         * @return UriView valid until the parser is released, reset or destroyed
+         * @throws std::domain_error if the status is not done
+         */
+        UriView view() const {
+            if (status != stream_status::done) URIPP_THROW(std::domain_error("The UriStreamParser has not parsed a URI"));
+            return detail::UriAccess::make_view(StringView(buffer.data(), buffer.size()), parts);
+        }
+
+        /**
+         * @brief Copy the parsed URI out, without scanning it again, and reset the parser
+         * 
+         * @return Uri the parsed URI
+         * @throws std::domain_error if the status is not done
+         */
+        Uri release() {
+            if (status != stream_status::done) URIPP_THROW(std::domain_error("The UriStreamParser has not parsed a URI"));
+            Uri uri = detail::UriAccess::make_uri(detail::href_string(buffer.data(), buffer.size(), buffer.get_allocator()), parts);
+            reset();
+            return uri;
+        }
+
+        /**
+         * @brief Discard the buffered characters, keeping the capacity of the buffer, and start a new href
+         * 
+         */
+        void reset() {
+            buffer.clear();
+            parts = detail::UriParts();
+            state = state_start;
+            status = stream_status::need_more;
+            error = parse_error::none;
+            position = begin = consumed = error_offset = 0;
+        }
+
+        private:
+        /**
+         * @brief Positions in the grammar of scan_uri(), at which a scan can stop for want of characters
+         * 
+         */
+        enum State {
+            state_start,
+            state_scheme_end,
+            state_authority,
+            state_path,
+            state_query,
+            state_fragment,
+            state_relative_start,
+            state_relative_segment,
+            state_relative_path,
+            state_relative_query,
+            state_relative_fragment
+        };
+
+        /**
+         * @brief Scans the buffer from the saved position as far as it goes
+         * 
+         * @param last whether the buffer holds the whole href, in which case the scan ends in done or error
+         */
+        void advance(bool last) {
+            const char* s = buffer.data();
+            std::size_t n = buffer.size();
+
+            for (;;) {
+                std::size_t i;
+                switch (state) {
+                    case state_start:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{':', '/', '?', '#'}, false});
+                        if (i == n && !last) return wait(n);
+                        if (i == 0 || i == n || s[i] != ':') {
+                            // a relative reference is matched from its first character again, this time validating it
+                            position = 0;
+                            state = state_relative_start;
+                            break;
+                        }
+                        parts.set(detail::part_scheme, 0, i);
+                        position = i + 1;
+                        state = state_scheme_end;
+                        break;
+
+                    case state_scheme_end:
+                        if (n - position < 2 && !last && (n == position || s[position] == '/')) return wait(position);
+                        if (n - position >= 2 && s[position] == '/' && s[position + 1] == '/') {
+                            position += 2;
+                            state = state_authority;
+                        } else {
+                            state = state_path;
+                        }
+                        begin = position;
+                        break;
+
+                    case state_authority:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{'/', '?', '#', '#'}, false});
+                        if (i == n && !last) return wait(n);
+                        if (i > begin) parts.set(detail::part_authority, begin, i);
+                        begin = position = i;
+                        state = state_path;
+                        break;
+
+                    case state_path:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{'?', '#', '#', '#'}, false});
+                        if (i == n && !last) return wait(n);
+                        parts.set(detail::part_path, begin, i);
+                        if (i == n) return complete();
+                        begin = position = i + 1;
+                        state = s[i] == '?' ? state_query : state_fragment;
+                        break;
+
+                    case state_query:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{'#', '#', '#', '#'}, false});
+                        if (i == n && !last) return wait(n);
+                        if (i > begin) parts.set(detail::part_query, begin, i);
+                        if (i == n) return complete();
+                        begin = position = i + 1;
+                        state = state_fragment;
+                        break;
+
+                    case state_fragment:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{'\n', '\r', '\n', '\r'}, false});
+                        if (i < n) return fail(parse_error::invalid_character, i);
+                        if (!last) return wait(n);
+                        if (i > begin) parts.set(detail::part_fragment, begin, i);
+                        return complete();
+
+                    case state_relative_start:
+                        if (n == 0) {
+                            if (!last) return wait(0);
+                            return complete();
+                        }
+                        if (s[0] == '/') {
+                            if (n < 2 && !last) return wait(0);
+                            if (n >= 2 && (s[1] == '/' || detail::is_pchar(s[1]))) {
+                                position = 2;
+                                state = state_relative_path;
+                                break;
+                            }
+                            if (relativeAfterPath(0, n)) return;
+                            break;
+                        }
+                        if (detail::is_segment_nc_char(s[0])) {
+                            position = 1;
+                            state = state_relative_segment;
+                            break;
+                        }
+                        if (relativeAfterPath(0, n)) return;
+                        break;
+
+                    case state_relative_segment:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{':', '/', '?', '?'}, true});
+                        if (i == n && !last) return wait(n);
+                        if (i < n && s[i] == '/') {
+                            position = i;
+                            state = state_relative_path;
+                            break;
+                        }
+                        if (relativeAfterPath(i, n)) return;
+                        break;
+
+                    case state_relative_path:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{'?', '?', '?', '?'}, true});
+                        if (i == n && !last) return wait(n);
+                        if (relativeAfterPath(i, n)) return;
+                        break;
+
+                    case state_relative_query:
+                    case state_relative_fragment:
+                        i = detail::scan_to(s, position, n, detail::ByteClass{{'#', '#', '#', '#'}, true});
+                        if (i == n && !last) return wait(n);
+                        parts.set(state == state_relative_query ? detail::part_query : detail::part_fragment, begin, i);
+                        if (i == n) return complete();
+                        if (state == state_relative_fragment || s[i] != '#') return fail(parse_error::invalid_character, i);
+                        begin = i;
+                        position = i + 1;
+                        state = state_relative_fragment;
+                        break;
+                }
+            }
+        }
+
+        /**
+         * @brief Continues a relative reference whose path, if any, ends at i
+         * 
+         * @return true if the scan is over
+         */
+        bool relativeAfterPath(std::size_t i, std::size_t n) {
+            if (i > 0) parts.set(detail::part_path, 0, i);
+            if (i == n) {
+                complete();
+                return true;
+            }
+
+            const char* s = buffer.data();
+            if (s[i] != '?' && s[i] != '#') {
+                // a lone "/" is not matched by any path alternative, so report the character that made it lone
+                fail(parse_error::invalid_character, (i == 0 && s[0] == '/') ? 1 : i);
+                return true;
+            }
+            begin = i;
+            position = i + 1;
+            state = s[i] == '?' ? state_relative_query : state_relative_fragment;
+            return false;
+        }
+
+        void wait(std::size_t at) {
+            position = at;
+        }
+
+        void complete() {
+            status = stream_status::done;
+            if (state >= state_relative_start) {
+                parts.flags = static_cast<std::uint16_t>(parts.flags | detail::flag_relative);
+            } else {
+                parts.flags = static_cast<std::uint16_t>(parts.flags | detail::flag_absolute);
+                if (parts.has(detail::part_authority)) {
+                    std::size_t authority_begin = parts.offset[detail::part_authority];
+                    std::size_t offset;
+                    parse_error result = detail::scan_authority(buffer.data(), authority_begin, authority_begin + parts.length[detail::part_authority], parts, offset);
+                    if (result != parse_error::none) return fail(result, offset);
+                }
+            }
+#ifdef URIPP_ENABLE_STATS
+            detail::count_parse(buffer.size(), parts, parse_error::none);
+#endif
+        }
+
+        void fail(parse_error reason, std::size_t offset) {
+            parts = detail::UriParts();
+            status = stream_status::error;
+            error = reason;
+            error_offset = offset;
+#ifdef URIPP_ENABLE_STATS
+            detail::count_parse(buffer.size(), parts, reason);
+#endif
+        }
+
+        std::size_t max_length;
+        bool terminated;
+        detail::ByteClass terminator;
+        detail::href_string buffer;
+        detail::UriParts parts;
+        State state;
+        stream_status status;
+        parse_error error;
+        std::size_t position;
+        std::size_t begin;
+        std::size_t consumed;
+        std::size_t error_offset;
+    };
+}
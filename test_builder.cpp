@@ -0,0 +1,120 @@
+#include "include/uri.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Round-trip test of UriBuilder::make(), buildInto() and build() with encode_components set.
+//
+//   test_builder [COUNT] [SEED]
+//
+// Random components, delimiters included, are built into a URI. The getters of the built Uri, percent-decoded, must
+// give back the components of the config, and parsing the built href again must give the same components. build()
+// writes the same href, except for the '/' it gives an empty path.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+
+   std::string text(std::size_t max_size) {
+      static const char alphabet[] = "abcXYZ019-._~!$&'()*+,;=:@/?#%[] \"<>^`{|}\\";
+      std::string out;
+      std::size_t size = next() % (max_size + 1);
+      for (std::size_t i = 0; i < size; ++i) out += alphabet[next() % (sizeof(alphabet) - 1)];
+      return out;
+   }
+};
+
+static std::string decode(uripp::StringView component) {
+   return uripp::percent_decode(component);
+}
+
+static std::string dump(const uripp::UriView& uri) {
+   std::string out;
+   for (uripp::StringView part : {uri.getScheme(), uri.getAuthority(), uri.getPath(), uri.getQuery(), uri.getFragment(),
+                                  uri.getUsername(), uri.getPassword(), uri.getHost(), uri.getPort()}) {
+      out += part.str();
+      out += '\n';
+   }
+   return out;
+}
+
+// The first component of a built Uri that does not decode to its config, or an empty string
+static std::string compare(const uripp::UriView& view, const uripp::UriBuilderConfig& config, const std::string& path) {
+   if (decode(view.getUsername()) != config.username) return "username";
+   if (decode(view.getPassword()) != config.password) return "password";
+   if (view.getHost() != config.host) return "host";
+   if (view.getPort() != config.port) return "port";
+   if (decode(view.getPath()) != path) return "path";
+   if (decode(view.getQuery()) != config.query) return "query";
+   if (decode(view.getFragment()) != config.fragment) return "fragment";
+   return std::string();
+}
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 100000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+   static const char* const hosts[] = {"example.com", "a.b.c", "127.0.0.1", "[::1]", "[2001:db8::7]", "localhost"};
+   static const char* const ports[] = {"", "", "80", "8080", "65535"};
+
+   std::size_t failures = 0;
+   std::vector<char> buffer;
+   for (std::size_t i = 0; i < count; ++i) {
+      uripp::UriBuilderConfig config;
+      config.scheme = random.next() % 2 ? "https" : "http";
+      config.username = random.text(6);
+      config.password = config.username.empty() ? std::string() : random.text(6);
+      config.host = hosts[random.next() % (sizeof(hosts) / sizeof(*hosts))];
+      config.port = ports[random.next() % (sizeof(ports) / sizeof(*ports))];
+      config.path = random.text(12);
+      config.query = random.text(8);
+      config.fragment = random.text(8);
+      config.encode_components = true;
+
+      std::string error;
+      try {
+         uripp::Uri uri = uripp::UriBuilder::make(config);
+         uripp::UriView view = uri.view();
+         std::string path = config.path.empty() || config.path[0] == '/' ? config.path : "/" + config.path;
+
+         error = compare(view, config, path);
+         if (error.empty()) {
+            uripp::ParseResult<uripp::UriView> parsed = uripp::try_parse_view(view.getHref());
+            buffer.resize(uripp::UriBuilder::builtSize(config));
+            uripp::ParseResult<uripp::UriView> built = uripp::UriBuilder::buildInto(config, buffer.data());
+            if (!parsed || dump(parsed.getUri()) != dump(view)) error = "reparse";
+            else if (!built || built.getUri().getHref() != view.getHref() || dump(built.getUri()) != dump(view)) error = "buildInto";
+         }
+         if (error.empty()) {
+            // build() logs the href it builds
+            std::ostringstream log;
+            std::streambuf* saved = std::cout.rdbuf(log.rdbuf());
+            std::unique_ptr<uripp::Uri> built;
+            try {
+               built.reset(uripp::UriBuilder::build(config));
+            } catch (...) {
+               std::cout.rdbuf(saved);
+               throw;
+            }
+            std::cout.rdbuf(saved);
+            error = compare(built->view(), config, path.empty() ? "/" : path);
+            if (!error.empty()) error = "build() " + error;
+         }
+         if (!error.empty() && ++failures <= 10) std::cout << "mismatch in " << error << ": " << view.getHref() << std::endl;
+      } catch (const std::exception& e) {
+         if (++failures <= 10) std::cout << "building threw " << e.what() << " for username \"" << config.username << "\"" << std::endl;
+      }
+   }
+
+   std::cout << count << " configs, " << failures << " mismatches" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
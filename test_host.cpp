@@ -0,0 +1,171 @@
+#include "include/uri.hpp"
+#include <arpa/inet.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Tests of the host, port and userinfo checks of the authority scanner.
+//
+//   test_host [COUNT] [SEED]
+//
+// decode_ipv4() and decode_ipv6() must agree with inet_pton() on COUNT random strings and on the IPv6 forms listed
+// below. The hrefs below must then be split, or rejected at the offset of the first character that makes them invalid.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+};
+
+// Decodes text with decode_ipv4() or decode_ipv6() and with inet_pton(), which must agree on validity and bytes
+static bool same_as_inet_pton(const std::string& text, bool ipv6) {
+   std::uint8_t decoded[16], expected[16];
+   const char* end = text.data() + text.size();
+   bool valid = ipv6 ? uripp::detail::decode_ipv6(text.data(), end, decoded) : uripp::detail::decode_ipv4(text.data(), end, decoded);
+   bool expected_valid = inet_pton(ipv6 ? AF_INET6 : AF_INET, text.c_str(), expected) == 1;
+   return valid == expected_valid && (!valid || std::memcmp(decoded, expected, ipv6 ? 16 : 4) == 0);
+}
+
+static const char* const ipv6_forms[] = {
+   "::", "::1", "1::", "1:2:3:4:5:6:7:8", "1:2:3:4:5:6:7::", "::2:3:4:5:6:7:8", "1::8", "::ffff:192.168.0.1",
+   "1:2:3:4:5:6:1.2.3.4", "2001:DB8::ff00:42:8329", "1:2:3:4:5:6:7:8:9", "1::2::3", ":1", "1:", "12345::",
+   "1:2:3:4:5:6:7:1.2.3.4", "::1.2.3", "::01.2.3.4", "::256.0.0.1", "1.2.3.4", "fe80::1%eth0", "",
+};
+
+struct Accepted {
+   const char* href;
+   const char* username;
+   const char* password;
+   const char* host;
+   const char* port;
+   uripp::host_type type;
+};
+
+static const Accepted accepted[] = {
+   {"http://example.com/", "", "", "example.com", "", uripp::host_type::reg_name},
+   {"http://ex%41mple.com/", "", "", "ex%41mple.com", "", uripp::host_type::reg_name},
+   {"http://sub_delims!$&'()*+,;=.com/", "", "", "sub_delims!$&'()*+,;=.com", "", uripp::host_type::reg_name},
+   {"http://256.1.1.1/", "", "", "256.1.1.1", "", uripp::host_type::reg_name},
+   {"http://10.0.0.1:8080/", "", "", "10.0.0.1", "8080", uripp::host_type::ipv4},
+   {"http://[::1]:8080/", "", "", "[::1]", "8080", uripp::host_type::ipv6},
+   {"http://[fe80::1%25eth0]/", "", "", "[fe80::1%25eth0]", "", uripp::host_type::ipv6},
+   {"http://[v1.fe:80]/", "", "", "[v1.fe:80]", "", uripp::host_type::ipv_future},
+   {"http://[V7.a:b]/", "", "", "[V7.a:b]", "", uripp::host_type::ipv_future},
+   {"http://h:65535/", "", "", "h", "65535", uripp::host_type::reg_name},
+   {"http://h:0080/", "", "", "h", "0080", uripp::host_type::reg_name},
+   {"http://user@host/", "user", "", "host", "", uripp::host_type::reg_name},
+   {"http://u:p@h:1/", "u", "p", "h", "1", uripp::host_type::reg_name},
+   {"http://a:b:c@h/", "a:b", "c", "h", "", uripp::host_type::reg_name},
+   {"http://:p@h/", "", "p", "h", "", uripp::host_type::reg_name},
+   {"http://u:@h/", "u", "", "h", "", uripp::host_type::reg_name},
+   {"http://@h/", "", "", "h", "", uripp::host_type::reg_name},
+};
+
+struct Rejected {
+   const char* href;
+   uripp::parse_error error;
+   std::size_t offset;
+};
+
+static const Rejected rejected[] = {
+   {"http://h:/", uripp::parse_error::invalid_port, 9},
+   {"http://h:65536/", uripp::parse_error::invalid_port, 13},
+   {"http://h:99999999999/", uripp::parse_error::invalid_port, 13},
+   {"http://h:8a/", uripp::parse_error::invalid_port, 10},
+   {"http://exa mple.com/", uripp::parse_error::invalid_host, 10},
+   {"http://a\"b/", uripp::parse_error::invalid_host, 8},
+   {"http://ex%4mple.com/", uripp::parse_error::invalid_host, 9},
+   {"http://[::g]/", uripp::parse_error::invalid_host, 8},
+   {"http://[1::2::3]/", uripp::parse_error::invalid_host, 8},
+   {"http://[]/", uripp::parse_error::invalid_host, 8},
+   {"http://[fe80::1%eth0]/", uripp::parse_error::invalid_host, 15},
+   {"http://[fe80::1%25]/", uripp::parse_error::invalid_host, 15},
+   {"http://[v.x]/", uripp::parse_error::invalid_host, 9},
+   {"http://[vz.x]/", uripp::parse_error::invalid_host, 9},
+   {"http://[v1.]/", uripp::parse_error::invalid_host, 10},
+   {"http://a:b@c@h/", uripp::parse_error::invalid_host, 12},
+   {"http://a b@h/", uripp::parse_error::invalid_authority, 8},
+};
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 1000000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+   static const char ipv4_alphabet[] = "0123456789..";
+   static const char ipv6_alphabet[] = "0123456789abcdefABCDEF:.::";
+   static const char* const octets[] = {"0", "9", "10", "99", "199", "255", "256", "300", "01", ""};
+   static const char* const groups[] = {"0", "1", "ff", "FFFF", "0db8", "12345", "g", ""};
+
+   int failures = 0;
+   std::size_t valid = 0;
+   for (std::size_t i = 0; i < count; ++i) {
+      bool ipv6 = i % 3 != 0;
+      std::string text;
+      // half of the strings are random characters, and half are made of octets or groups, of which many are valid
+      if (i % 2) {
+         std::size_t size = random.next() % 40;
+         for (std::size_t k = 0; k < size; ++k) {
+            text += ipv6 ? ipv6_alphabet[random.next() % (sizeof(ipv6_alphabet) - 1)] : ipv4_alphabet[random.next() % (sizeof(ipv4_alphabet) - 1)];
+         }
+      } else if (!ipv6) {
+         std::size_t size = 3 + random.next() % 3;
+         for (std::size_t k = 0; k < size; ++k) text += std::string(k ? "." : "") + octets[random.next() % (sizeof(octets) / sizeof(*octets))];
+      } else {
+         std::size_t size = random.next() % 9, gap = random.next() % 12;
+         for (std::size_t k = 0; k < size; ++k) {
+            text += k == gap ? "::" : k ? ":" : "";
+            text += groups[random.next() % (sizeof(groups) / sizeof(*groups))];
+         }
+         if (gap == size) text += "::";
+         if (random.next() % 4 == 0) text += std::string(text.empty() || gap == size ? "" : ":") + "192.168.0." + octets[random.next() % 3];
+      }
+      std::uint8_t bytes[16];
+      const char* end = text.data() + text.size();
+      valid += ipv6 ? uripp::detail::decode_ipv6(text.data(), end, bytes) : uripp::detail::decode_ipv4(text.data(), end, bytes);
+      if (!same_as_inet_pton(text, ipv6) && ++failures <= 10) std::cout << "\"" << text << "\": differs from inet_pton" << std::endl;
+   }
+   for (const char* form : ipv6_forms) {
+      if (!same_as_inet_pton(form, true)) {
+         std::cout << "\"" << form << "\": differs from inet_pton" << std::endl;
+         ++failures;
+      }
+   }
+
+   for (const Accepted& expected : accepted) {
+      uripp::ParseResult<uripp::UriView> result = uripp::try_parse_view(expected.href);
+      if (!result || result.getUri().getUsername() != expected.username || result.getUri().getPassword() != expected.password ||
+          result.getUri().getHost() != expected.host || result.getUri().getPort() != expected.port ||
+          result.getUri().getHostType() != expected.type) {
+         std::cout << expected.href << ": not split as expected" << std::endl;
+         ++failures;
+      }
+   }
+
+   for (const Rejected& expected : rejected) {
+      uripp::ParseResult<uripp::UriView> result = uripp::try_parse_view(expected.href);
+      if (result || result.getError() != expected.error || result.getErrorOffset() != expected.offset) {
+         std::cout << expected.href << ": expected " << uripp::ErrorToString(expected.error) << " at " << expected.offset << ", got "
+                   << uripp::ErrorToString(result.getError()) << " at " << result.getErrorOffset() << std::endl;
+         ++failures;
+      }
+   }
+
+   // The decoded address of an IPv6 host keeps its zone ID, still percent-encoded
+   uripp::IpAddress address = uripp::Uri("http://[2001:db8::ff00:42:8329%25en1]:443/x").getHostAddress();
+   std::uint8_t expected_bytes[16];
+   inet_pton(AF_INET6, "2001:db8::ff00:42:8329", expected_bytes);
+   if (address.type != uripp::host_type::ipv6 || std::memcmp(address.bytes, expected_bytes, 16) != 0 || address.zone != "en1") {
+      std::cout << "zone ID: not decoded as expected" << std::endl;
+      ++failures;
+   }
+
+   std::cout << count << " random addresses, " << valid << " valid, " << sizeof(accepted) / sizeof(*accepted) << " accepted and "
+             << sizeof(rejected) / sizeof(*rejected) << " rejected hrefs, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#include "include/uri_host_matcher.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Test of HostMatcher against a brute force.
+//
+//   test_host_matcher [COUNT] [SEED]
+//
+// The listed rules and hosts must match as given. Then rules built from a few labels are added at random, repeats
+// included, and COUNT random hosts of up to 10 labels are matched one by one and in batches. Both must give the rule a scan of every
+// label-aligned suffix of the host finds: the longest, and for the whole host an exact rule before a with_subdomains one.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+
+   template <std::size_t N>
+   const char* pick(const char* const (&pieces)[N]) {
+      return pieces[next() % N];
+   }
+};
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+   if (ok) return;
+   std::cout << "FAILED: " << what << std::endl;
+   ++failures;
+}
+
+static std::string lower(const std::string& text) {
+   std::string out = text;
+   for (char& c : out) c = uripp::detail::to_lower(c);
+   return out;
+}
+
+// The rules added so far, by lowercased host and kind
+typedef std::map<std::pair<std::string, bool>, std::uint32_t> Rules;
+
+static std::uint32_t brute_force(const Rules& rules, std::string host) {
+   if (!host.empty() && host[host.size() - 1] == '.') host.erase(host.size() - 1);
+   if (host.empty()) return uripp::HostMatcher::no_match;
+   host = lower(host);
+
+   std::uint8_t address[4];
+   bool literal = host[0] == '[' || uripp::detail::decode_ipv4(host.data(), host.data() + host.size(), address);
+   Rules::const_iterator exact = rules.find(std::make_pair(host, true));
+   if (exact != rules.end()) return exact->second;
+   if (literal) return uripp::HostMatcher::no_match;
+   for (std::size_t i = 0; i < host.size(); i = host.find('.', i) == std::string::npos ? host.size() : host.find('.', i) + 1) {
+      Rules::const_iterator sub = rules.find(std::make_pair(host.substr(i), false));
+      if (sub != rules.end()) return sub->second;
+   }
+   return uripp::HostMatcher::no_match;
+}
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 500000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+   const std::uint32_t none = uripp::HostMatcher::no_match;
+
+   uripp::HostMatcher fixed;
+   std::uint32_t example = fixed.add("Example.com");
+   std::uint32_t www = fixed.add("www.example.com", uripp::host_rule::exact);
+   std::uint32_t dotted = fixed.add(".example.org", uripp::host_rule::exact);
+   std::uint32_t ipv4 = fixed.add("1.2.3.4");
+   std::uint32_t ipv6 = fixed.add("[::1]");
+   check(fixed.match(uripp::StringView("WWW.EXAMPLE.COM.")) == www, "an exact rule wins for the whole host, whatever its case");
+   check(fixed.match(uripp::StringView("a.www.example.com")) == example, "an exact rule does not match a subdomain");
+   check(fixed.match(uripp::StringView("example.com")) == example, "a with_subdomains rule matches the host itself");
+   check(fixed.match(uripp::StringView("notexample.com")) == none, "a rule matches whole labels only");
+   check(fixed.match(uripp::StringView("a.example.org")) == dotted && fixed.match(uripp::StringView("example.org")) == dotted,
+         "a leading '.' makes a with_subdomains rule");
+   check(fixed.getHost(example) == "example.com" && fixed.getHost(dotted) == "example.org", "getHost");
+   check(fixed.match(uripp::StringView("1.2.3.4")) == ipv4 && fixed.match(uripp::StringView("evil.1.2.3.4")) == none,
+         "an IPv4 rule matches the address only");
+   check(fixed.match(uripp::StringView("[::1]")) == ipv6, "an IPv6 rule");
+   check(fixed.match(uripp::Uri("https://u@Docs.Example.com:8443/p")) == example, "match a Uri");
+   check(fixed.match(uripp::UriView("http://[::1]/")) == ipv6, "match a UriView");
+   check(fixed.match(uripp::UriView("/example.com/p")) == none && fixed.match(uripp::StringView("")) == none, "no host");
+   check(fixed.size() == 5, "size");
+   for (const char* invalid : {"", ".", "..x", ".."}) {
+      bool threw = false;
+      try {
+         fixed.add(invalid);
+      } catch (const std::invalid_argument&) {
+         threw = true;
+      }
+      check(threw, "an invalid rule throws");
+   }
+
+   static const char* const labels[] = {"com", "org", "example", "www", "a", "b", "Docs", "x-y", "1", "2", "3", "4", ""};
+   static const char* const literals[] = {"1.2.3.4", "10.0.0.1", "[::1]", "[2001:db8::1]", "[v1.x]"};
+   uripp::HostMatcher matcher;
+   Rules rules;
+   auto generate = [&](bool rule) {
+      if (random.next() % 10 == 0) return std::string(random.pick(literals));
+      std::string host;
+      for (std::size_t k = rule ? 2 + random.next() % 2 : 1 + random.next() % 10; k > 0; --k) host = random.pick(labels) + (host.empty() ? "" : "." + host);
+      if (!rule && random.next() % 8 == 0) host += ".";
+      return host;
+   };
+   for (std::size_t i = 0; i < 150; ++i) {
+      std::string host = generate(true);
+      if (!host.empty() && host[host.size() - 1] == '.') host.erase(host.size() - 1);
+      if (host.empty() || host[0] == '.') continue;
+      bool exact = random.next() % 3 == 0;
+      std::uint32_t id = matcher.add(host, exact ? uripp::host_rule::exact : uripp::host_rule::with_subdomains);
+      std::uint8_t address[4];
+      bool literal = host[0] == '[' || uripp::detail::decode_ipv4(host.data(), host.data() + host.size(), address);
+      rules[std::make_pair(lower(host), exact || literal)] = id;
+   }
+
+   std::vector<std::string> hosts;
+   std::size_t matched = 0, mismatches = 0;
+   for (std::size_t i = 0; i < count; ++i) {
+      hosts.push_back(generate(false));
+      std::uint32_t expected = brute_force(rules, hosts.back());
+      matched += expected != none;
+      if (matcher.match(uripp::StringView(hosts.back())) != expected && ++mismatches <= 10) {
+         std::cout << "match(\"" << hosts.back() << "\") differs from the brute force" << std::endl;
+      }
+   }
+
+   std::vector<uripp::StringView> views(hosts.begin(), hosts.end());
+   std::vector<std::uint32_t> out(views.size());
+   for (std::size_t at = 0; at < views.size();) {
+      std::size_t size = std::min<std::size_t>(random.next() % 100, views.size() - at);
+      matcher.matchBatch(views.data() + at, size, out.data() + at);
+      at += size;
+   }
+   for (std::size_t i = 0; i < hosts.size(); ++i) {
+      if (out[i] != matcher.match(views[i]) && ++mismatches <= 10) std::cout << "matchBatch(\"" << hosts[i] << "\") differs from match()" << std::endl;
+   }
+   failures += static_cast<int>(mismatches);
+
+   std::cout << matcher.size() << " rules, " << count << " hosts, " << matched << " matched, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
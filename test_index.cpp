@@ -0,0 +1,138 @@
+#include "include/uri_index.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// Test of UriIndex against a std::set brute force.
+//
+//   test_index [COUNT] [SEED]
+//
+// COUNT random hrefs, invalid ones and repeats included, are indexed over 1 and 4 threads with several block sizes.
+// The index must hold every distinct valid href and no other, and prefix and host queries must visit the hrefs a scan
+// of the set finds. A few hrefs are longer than the stack buffer of a query.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+
+   template <std::size_t N>
+   const char* pick(const char* const (&pieces)[N]) {
+      return pieces[next() % N];
+   }
+};
+
+static std::string generate(Random& random) {
+   static const char* const hosts[] = {"example.com", "docs.example.com", "a.docs.example.com", "example.org", "xexample.com",
+                                       "[::1]", "1.2.3.4", "EXAMPLE.com"};
+   static const char* const paths[] = {"/", "/docs/", "/docs/a", "/docs/b?x=1", "/docsx", "/api/v1", ""};
+
+   std::string n = std::to_string(random.next() % 500);
+   switch (random.next() % 10) {
+      case 0: return "mailto:u" + n + "@x";
+      case 1: return "/rel/" + n;
+      case 2: return "http://bad host/";
+      default: break;
+   }
+   std::string href = random.next() % 2 ? "https://" : "http://";
+   if (random.next() % 7 == 0) href += "u@";
+   href += random.pick(hosts);
+   if (random.next() % 5 == 0) href += ":8080";
+   href += random.pick(paths);
+   if (random.next() % 3) href += n;
+   if (random.next() % 100 == 0) href += "?q=" + std::string(2000 + random.next() % 3000, 'q');
+   return href;
+}
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 60000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+
+   std::vector<std::string> hrefs;
+   std::set<std::string> valid;
+   std::size_t invalid = 0;
+   for (std::size_t i = 0; i < count; ++i) {
+      hrefs.push_back(generate(random));
+      if (uripp::try_parse_view(hrefs.back())) valid.insert(hrefs.back());
+      else ++invalid;
+   }
+
+   static const char* const prefixes[] = {"https://example.com/docs/", "http://docs.example.com", "https://u@example.com/", "mailto:",
+                                          "/rel/1", "https://[::1]/", "http://1.2.3.4:8080/api", ""};
+   static const char* const hosts[] = {"example.com", "docs.example.com", "[::1]", "nothere.com", ""};
+
+   int failures = 0;
+   for (unsigned threads : {1u, 4u}) {
+      for (std::size_t block_size : {1, 3, 16, 64}) {
+         uripp::WorkerPool pool(threads);
+         uripp::UriIndex index(hrefs, pool, block_size);
+         uripp::UriIndexStats stats = index.getStats();
+         std::string config = std::to_string(threads) + " threads, blocks of " + std::to_string(block_size);
+
+         if (index.size() != valid.size() || stats.rejected != invalid || stats.duplicates != count - invalid - valid.size()) {
+            std::cout << config << ": " << index.size() << " uris, " << stats.rejected << " rejected, " << stats.duplicates
+                      << " duplicates" << std::endl;
+            ++failures;
+         }
+
+         std::size_t missing = 0;
+         for (const std::string& href : valid) missing += !index.contains(href);
+         for (const char* absent : {"https://example.com/nothere", "", "zzz:", "http://bad host/"}) missing += index.contains(absent);
+         if (missing) {
+            std::cout << config << ": contains() wrong for " << missing << " hrefs" << std::endl;
+            ++failures;
+         }
+
+         for (const char* prefix : prefixes) {
+            std::string text = prefix;
+            std::multiset<std::string> expected, visited;
+            for (const std::string& href : valid) {
+               if (href.compare(0, text.size(), text) == 0 && uripp::detail::index_host(href) == uripp::detail::index_host(text)) {
+                  expected.insert(href);
+               }
+            }
+            std::size_t n = index.findPrefix(prefix, [&](const uripp::UriView& uri) { visited.insert(uri.getHref().str()); });
+            if (n != expected.size() || visited != expected) {
+               std::cout << config << ": findPrefix(\"" << prefix << "\") visited " << n << ", expected " << expected.size() << std::endl;
+               ++failures;
+            }
+         }
+
+         for (const char* host : hosts) {
+            for (bool subdomains : {false, true}) {
+               std::string suffix = std::string(".") + host;
+               std::multiset<std::string> expected, visited;
+               for (const std::string& href : valid) {
+                  std::string actual = uripp::try_parse_view(href).getUri().getHost().str();
+                  bool sub = subdomains && *host && actual.size() > suffix.size() &&
+                             actual.compare(actual.size() - suffix.size(), suffix.size(), suffix) == 0;
+                  if (actual == host || sub) expected.insert(href);
+               }
+               std::size_t n = index.findHost(host, subdomains, [&](const uripp::UriView& uri) { visited.insert(uri.getHref().str()); });
+               if (n != expected.size() || visited != expected) {
+                  std::cout << config << ": findHost(\"" << host << "\", " << subdomains << ") visited " << n << ", expected "
+                            << expected.size() << std::endl;
+                  ++failures;
+               }
+            }
+         }
+      }
+   }
+
+   uripp::UriIndex empty;
+   if (empty.size() != 0 || empty.contains("a") || empty.findPrefix("", [](const uripp::UriView&) {}) != 0) {
+      std::cout << "empty index not empty" << std::endl;
+      ++failures;
+   }
+
+   std::cout << count << " hrefs, " << valid.size() << " distinct valid, " << invalid << " invalid, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
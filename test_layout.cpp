@@ -0,0 +1,95 @@
+#include "include/uri.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Reports the footprint of a Uri: sizeof(Uri) and the heap allocations and bytes of constructing one.
+//
+//   test_layout
+//
+// A Uri keeps its href in one buffer and its components in a fixed offset table, so constructing one may allocate
+// once, for the href, and reading its components may not allocate at all.
+
+static std::uint64_t allocations = 0;
+static std::uint64_t allocated_bytes = 0;
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+   ++allocations;
+   allocated_bytes += size;
+   if (void* p = std::malloc(size ? size : 1)) return p;
+   throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+   return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+   std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+   std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+   std::free(p);
+}
+
+int main() {
+   std::cout << "sizeof(Uri) = " << sizeof(uripp::Uri) << ", sizeof(UriView) = " << sizeof(uripp::UriView)
+             << ", sizeof(UriParts) = " << sizeof(uripp::detail::UriParts) << std::endl;
+
+   const char* hrefs[] = {
+      "http://user:pw@www.example.com:8080/path/to/home?name=fady#fragment",
+      "https://example.com/",
+      "https://[2001:db8::1]:443/a/b/c?x=1&y=2",
+      "mailto:someone@example.com",
+      "/relative/path?query#fragment",
+      "a",
+   };
+
+   int failures = 0;
+   for (const char* text : hrefs) {
+      std::string href = text;
+
+      std::uint64_t before = allocations, before_bytes = allocated_bytes;
+      uripp::Uri uri(href);
+      std::uint64_t count = allocations - before, bytes = allocated_bytes - before_bytes;
+
+      before = allocations;
+      std::size_t seen = 0;
+      uripp::UriView view = uri.view();
+      for (uripp::StringView part : {view.getScheme(), view.getAuthority(), view.getPath(), view.getQuery(), view.getFragment(),
+                                     view.getUsername(), view.getPassword(), view.getHost(), view.getPort()}) {
+         seen += part.size();
+      }
+      if (uri.isRelativeUri()) {
+         for (const auto& entry : uri.getRelativeURIComponents()) seen += entry.second.size();
+      } else {
+         for (const auto& entry : uri.getURIComponents()) seen += entry.second.size();
+         for (const auto& entry : uri.getAuthorityComponents()) seen += entry.second.size();
+      }
+      std::uint64_t reads = allocations - before;
+
+      std::cout << href << ": " << count << " allocations, " << bytes << " heap bytes, " << reads
+                << " allocations reading " << seen << " component bytes" << std::endl;
+
+      // at most the href itself, with its terminator
+      if (count > 1 || bytes > href.size() + 1 || reads != 0) {
+         std::cout << "  FAILED: expected at most one allocation of " << href.size() + 1 << " bytes and none on reads" << std::endl;
+         ++failures;
+      }
+   }
+   return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include "include/uri_normalize.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Tests of normalize() and canonical_hash().
+//
+//   test_normalize [COUNT] [SEED]
+//
+// The listed hrefs must normalize as given. Then COUNT random hrefs are normalized. Each result must fit in
+// max_normalized_size(), be the same through the string and the buffer overloads, and normalize to itself again. Its
+// canonical_hash() must be the MurmurHash3 x64_128 of the normalized href, computed here by a one-shot reference.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+};
+
+static std::uint64_t rotl(std::uint64_t x, int r) {
+   return (x << r) | (x >> (64 - r));
+}
+
+static std::uint64_t fmix(std::uint64_t k) {
+   k ^= k >> 33;
+   k *= 0xff51afd7ed558ccdull;
+   k ^= k >> 33;
+   k *= 0xc4ceb9fe1a85ec53ull;
+   k ^= k >> 33;
+   return k;
+}
+
+// MurmurHash3_x64_128 as published with SMHasher, for a little-endian host
+static uripp::UriHash murmur3(const std::string& text, std::uint64_t seed) {
+   const std::uint64_t c1 = 0x87c37b91114253d5ull, c2 = 0x4cf5ad432745937full;
+   const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+   std::size_t size = text.size(), blocks = size / 16;
+   std::uint64_t h1 = seed, h2 = seed;
+
+   for (std::size_t i = 0; i < blocks; ++i) {
+      std::uint64_t k1, k2;
+      std::memcpy(&k1, data + i * 16, 8);
+      std::memcpy(&k2, data + i * 16 + 8, 8);
+      k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1;
+      h1 = rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+      k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2;
+      h2 = rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+   }
+
+   const unsigned char* tail = data + blocks * 16;
+   std::uint64_t k1 = 0, k2 = 0;
+   for (std::size_t i = size & 15; i > 8; --i) k2 ^= static_cast<std::uint64_t>(tail[i - 1]) << (8 * (i - 9));
+   if ((size & 15) > 8) { k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; h2 ^= k2; }
+   for (std::size_t i = (size & 15) < 8 ? size & 15 : 8; i > 0; --i) k1 ^= static_cast<std::uint64_t>(tail[i - 1]) << (8 * (i - 1));
+   if (size & 15) { k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; h1 ^= k1; }
+
+   h1 ^= size; h2 ^= size;
+   h1 += h2; h2 += h1;
+   h1 = fmix(h1); h2 = fmix(h2);
+   h1 += h2; h2 += h1;
+   return uripp::UriHash{h1, h2};
+}
+
+struct Example {
+   const char* href;
+   const char* normalized;
+};
+
+static const Example examples[] = {
+   {"HTTP://Example.COM:80/a/./b/../c", "http://example.com/a/c"},
+   {"http://example.com", "http://example.com/"},
+   {"https://h:8443", "https://h:8443/"},
+   {"https://a.com:443/%7euser/%2fx%2Fy", "https://a.com/~user/%2Fx%2Fy"},
+   {"http://%41B.com/%2E%2E/a", "http://ab.com/a"},
+   {"http://u%3aP@Host:8080/p?Q=%7e%3d#F%7E", "http://u%3AP@host:8080/p?Q=~%3D#F~"},
+   {"http://[FE80::1]:80/", "http://[fe80::1]/"},
+   {"http://[::1]/", "http://[::1]/"},
+   {"http://u:p@h:81/", "http://u:p@h:81/"},
+   {"ftp://h:21/x", "ftp://h/x"},
+   {"ws://h:443/", "ws://h:443/"},
+   {"mailto:Joe@Example.org", "mailto:Joe@Example.org"},
+   {"../a/%7e/./b?%2a#%41", "../a/~/./b?%2A#A"},
+   {"http://user@Host/", "http://user@host/"},
+};
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 300000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+   static const char* const pieces[] = {"http", "HTTP", "://", "a", "B", "%41", "%2e", "%2E", ".", "..", "/", "/", "?", "#",
+                                        ":80", ":", "@", "%7e", "%zz", "%", "x%2fy", "[::A]", ";", "~"};
+
+   std::size_t failures = 0;
+   for (const Example& example : examples) {
+      uripp::Uri uri(example.href);
+      std::string normalized = uripp::normalize(uri);
+      if (normalized != example.normalized || uripp::canonical_hash(uri) != murmur3(normalized, 0) ||
+          uripp::canonical_hash(uripp::Uri(normalized)) != uripp::canonical_hash(uri)) {
+         std::cout << example.href << ": normalized to " << normalized << ", expected " << example.normalized << std::endl;
+         ++failures;
+      }
+   }
+
+   // The hash does not depend on how its input is split into writes
+   for (std::size_t i = 0; i < 10000; ++i) {
+      std::string text;
+      std::size_t size = random.next() % 400;
+      for (std::size_t k = 0; k < size; ++k) text += static_cast<char>(random.next());
+      uripp::detail::HashSink sink(i);
+      for (std::size_t at = 0; at < text.size();) {
+         std::size_t chunk = std::min<std::size_t>(random.next() % (i % 2 ? 20 : 150), text.size() - at);
+         if (random.next() % 3 == 0 || chunk == 0) {
+            sink.put(text[at]);
+            chunk = 1;
+         } else {
+            sink.write(text.data() + at, chunk);
+         }
+         at += chunk;
+      }
+      if (sink.digest() != murmur3(text, i) && ++failures <= 10) std::cout << "HashSink differs on " << text.size() << " bytes" << std::endl;
+   }
+
+   std::size_t parsed = 0;
+   std::vector<char> buffer;
+   for (std::size_t i = 0; i < count; ++i) {
+      std::string href;
+      std::size_t size = random.next() % 12;
+      for (std::size_t k = 0; k < size; ++k) href += pieces[random.next() % (sizeof(pieces) / sizeof(*pieces))];
+      if (random.next() % 4) href = (random.next() % 2 ? "HTTP://h" : "https://H%41:443") + href;
+
+      uripp::ParseResult<uripp::UriView> result = uripp::try_parse_view(href);
+      if (!result) continue;
+      ++parsed;
+      const uripp::UriView& uri = result.getUri();
+
+      std::string normalized = uripp::normalize(uri);
+      buffer.resize(uripp::max_normalized_size(uri));
+      std::string error;
+      if (normalized.size() > buffer.size()) error = "longer than max_normalized_size()";
+      else if (std::string(buffer.data(), uripp::normalize(uri, buffer.data())) != normalized) error = "buffer overload differs";
+      else if (uripp::canonical_hash(uri, 7) != murmur3(normalized, 7)) error = "canonical_hash differs";
+      else if (!uri.isRelativeUri() && std::isalpha(static_cast<unsigned char>(href[0]))) {
+         // an absolute URI normalizes to a fixed point
+         uripp::ParseResult<uripp::UriView> again = uripp::try_parse_view(normalized);
+         if (!again) error = "normalized href does not parse";
+         else if (uripp::normalize(again.getUri()) != normalized) error = "not idempotent";
+      }
+      if (!error.empty() && ++failures <= 10) std::cout << "\"" << href << "\" -> \"" << normalized << "\": " << error << std::endl;
+   }
+
+   std::cout << count << " hrefs, " << parsed << " parsed, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#include "include/uri.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Test of QueryView and QueryIndex.
+//
+//   test_query
+//
+// A query given as a string is viewed as-is, while the query of a parsed URI is viewed without the '?' that a relative
+// URI keeps, so a key written as "?x" reads the same in an absolute and a relative URI. Lookups of a QueryIndex must
+// agree with those of its QueryView.
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+   if (ok) return;
+   std::cout << "FAILED: " << what << std::endl;
+   ++failures;
+}
+
+static std::string keys(const uripp::QueryView& query) {
+   std::string out;
+   for (const uripp::QueryParameter& parameter : query) {
+      out += parameter.getKey().str();
+      out += parameter.hasValue() ? "=" + parameter.getValue().str() + ";" : ";";
+   }
+   return out;
+}
+
+int main() {
+   check(keys(uripp::QueryView("a=1&&b&c=")) == "a=1;b;c=;", "pairs of a query string");
+   check(keys(uripp::QueryView("?x=1")) == "?x=1;", "a query string is taken as-is");
+   check(keys(uripp::QueryView("a=1;b=2&c", "&;")) == "a=1;b=2;c;", "several separators");
+   check(uripp::QueryView("").empty() && uripp::QueryView("&&").empty(), "empty queries");
+
+   uripp::UriView absolute("http://a/??x=1&y");
+   uripp::UriView relative("/p??x=1&y");
+   check(keys(uripp::QueryView(absolute)) == "?x=1;y;", "query of an absolute URI");
+   check(keys(uripp::QueryView(relative)) == "?x=1;y;", "query of a relative URI");
+   check(uripp::QueryView(uripp::UriView("/p?a=1")).get("a") == "1", "relative query without a repeated '?'");
+   check(uripp::QueryView(uripp::UriView("http://a/p")).empty() && uripp::QueryView(uripp::UriView("/p")).empty(), "no query");
+
+   uripp::QueryView decoded(uripp::UriView("http://a/?a%20b=1&c+d=2&a+b=3"), "&", true);
+   check(decoded.get("a b") == "1" && decoded.get("c d") == "2" && !decoded.contains("a%20b"), "decoded keys");
+
+   uripp::QueryIndex index(decoded);
+   check(index.size() == 3 && index.get("a b") == "1" && index.get("c d") == "2" && !index.contains("x"), "QueryIndex");
+
+   for (const char* separators : {"", "&;,+/"}) {
+      bool threw = false;
+      try {
+         uripp::QueryView query(absolute, separators);
+      } catch (const std::invalid_argument&) {
+         threw = true;
+      }
+      check(threw, "invalid separators throw");
+   }
+
+   std::cout << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include "include/uri_resolve.hpp"
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Resolves the examples of RFC 3986 section 5.4 against their base "http://a/b/c/d;p?q".
+//
+//   test_resolve
+//
+// Every example goes through resolveInto(), resolve() and resolveBatch(), which must all give the expected target.
+
+struct Example {
+   const char* reference;
+   const char* target;
+};
+
+// Section 5.4.1, normal examples
+static const Example normal[] = {
+   {"g:h", "g:h"},
+   {"g", "http://a/b/c/g"},
+   {"./g", "http://a/b/c/g"},
+   {"g/", "http://a/b/c/g/"},
+   {"/g", "http://a/g"},
+   {"//g", "http://g"},
+   {"?y", "http://a/b/c/d;p?y"},
+   {"g?y", "http://a/b/c/g?y"},
+   {"#s", "http://a/b/c/d;p?q#s"},
+   {"g#s", "http://a/b/c/g#s"},
+   {"g?y#s", "http://a/b/c/g?y#s"},
+   {";x", "http://a/b/c/;x"},
+   {"g;x", "http://a/b/c/g;x"},
+   {"g;x?y#s", "http://a/b/c/g;x?y#s"},
+   {"", "http://a/b/c/d;p?q"},
+   {".", "http://a/b/c/"},
+   {"./", "http://a/b/c/"},
+   {"..", "http://a/b/"},
+   {"../", "http://a/b/"},
+   {"../g", "http://a/b/g"},
+   {"../..", "http://a/"},
+   {"../../", "http://a/"},
+   {"../../g", "http://a/g"},
+};
+
+// Section 5.4.2, abnormal examples, with the strict parser for "http:g"
+static const Example abnormal[] = {
+   {"../../../g", "http://a/g"},
+   {"../../../../g", "http://a/g"},
+   {"/./g", "http://a/g"},
+   {"/../g", "http://a/g"},
+   {"g.", "http://a/b/c/g."},
+   {".g", "http://a/b/c/.g"},
+   {"g..", "http://a/b/c/g.."},
+   {"..g", "http://a/b/c/..g"},
+   {"./../g", "http://a/b/g"},
+   {"./g/.", "http://a/b/c/g/"},
+   {"g/./h", "http://a/b/c/g/h"},
+   {"g/../h", "http://a/b/c/h"},
+   {"g;x=1/./y", "http://a/b/c/g;x=1/y"},
+   {"g;x=1/../y", "http://a/b/c/y"},
+   {"g?y/./x", "http://a/b/c/g?y/./x"},
+   {"g?y/../x", "http://a/b/c/g?y/../x"},
+   {"g#s/./x", "http://a/b/c/g#s/./x"},
+   {"g#s/../x", "http://a/b/c/g#s/../x"},
+   {"http:g", "http:g"},
+};
+
+int main() {
+   uripp::UriResolver resolver(uripp::Uri("http://a/b/c/d;p?q"));
+   std::vector<Example> examples(std::begin(normal), std::end(normal));
+   examples.insert(examples.end(), std::begin(abnormal), std::end(abnormal));
+
+   std::vector<uripp::StringView> references;
+   for (const Example& example : examples) references.push_back(example.reference);
+   uripp::ResolvedBatch batch;
+   resolver.resolveBatch(references, batch);
+
+   int failures = 0;
+   for (std::size_t i = 0; i < examples.size(); ++i) {
+      const Example& example = examples[i];
+      std::string into(resolver.maxResolvedSize(example.reference), '\0');
+      into.resize(resolver.resolveInto(example.reference, &into[0]));
+      std::string resolved = resolver.resolve(example.reference).getHref();
+      std::string batched = batch.get(i).str();
+
+      if (into != example.target || resolved != example.target || batched != example.target) {
+         std::cout << "\"" << example.reference << "\": expected " << example.target << ", resolveInto " << into
+                   << ", resolve " << resolved << ", resolveBatch " << batched << std::endl;
+         ++failures;
+      }
+   }
+
+   std::cout << examples.size() << " examples, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
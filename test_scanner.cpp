@@ -0,0 +1,213 @@
+#include "include/uri.hpp"
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <regex>
+#include <string>
+
+// Differential test of the scanner against the std::regex patterns it replaced.
+//
+//   test_scanner [COUNT] [SEED]
+//
+// Random hrefs are parsed by try_parse_view() and by the former patterns, and every component and presence flag must
+// agree. The host and port checks added since are stricter, and a userinfo is now split at its last ':' with empty
+// fields treated as absent, so the test only allows these differences: the scanner rejecting an authority the patterns
+// accepted for a port above 65535, a character its host or userinfo may not hold, a second '@' or an empty host after
+// a userinfo, each checked at the offset of the error; and a userinfo the patterns rejected, took as part of the host,
+// or split at another ':'.
+
+static const std::regex uri_regex("^(([^:/?#]+):)?(\\/\\/([^/?#]*))?([^?#]*)(\\?([^#]*))?(#(.*))?", std::regex_constants::ECMAScript);
+static const std::regex authority_regex("^(([^@]+)(:([^@]+))@)?(\\[[^\\]]+\\]|[^:\\[\\]]+)(:(\\d+))?$", std::regex_constants::ECMAScript);
+static const std::regex relative_uri_regex("^((?:\\/\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*)(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*))*)|(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]+(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*))*))|(?:[A-Za-z0-9\\-._~%!$&'()*+,;=@]+(?:\\/(?:[A-Za-z0-9\\-._~%!$&'()*+,;=:@]*))*))?(\\?[A-Za-z0-9\\-._~%!$&'()*+,;=:@\\/\\?]*)?(\\#[A-Za-z0-9\\-._~%!$&'()*+,;=:@\\/\\?]*)?$");
+
+// The components of an href, as the former constructor filled its maps: absent components are empty
+struct Parsed {
+   bool ok = false;
+   bool relative = false;
+   bool authority_error = false;
+   uripp::parse_error error = uripp::parse_error::none;
+   std::size_t error_offset = 0;
+   std::string scheme, authority, path, query, fragment, username, password, host, port;
+};
+
+static Parsed parse_with_patterns(const std::string& href) {
+   Parsed parsed;
+   std::smatch groups;
+   if (std::regex_match(href, groups, uri_regex) && !groups[2].str().empty()) {
+      parsed.scheme = groups[2].str();
+      parsed.authority = groups[4].str();
+      parsed.path = groups[5].str();
+      parsed.query = groups[7].str();
+      parsed.fragment = groups[9].str();
+      if (!parsed.authority.empty()) {
+         std::smatch authority_groups;
+         if (!std::regex_match(parsed.authority, authority_groups, authority_regex)) {
+            parsed.authority_error = true;
+            return parsed;
+         }
+         parsed.username = authority_groups[2].str();
+         parsed.password = authority_groups[4].str();
+         parsed.host = authority_groups[5].str();
+         parsed.port = authority_groups[7].str();
+      }
+      parsed.ok = true;
+      return parsed;
+   }
+
+   if (!std::regex_match(href, groups, relative_uri_regex)) return parsed;
+   parsed.relative = true;
+   parsed.path = groups[1].str();
+   parsed.query = groups[2].str();
+   parsed.fragment = groups[3].str();
+   parsed.ok = true;
+   return parsed;
+}
+
+static Parsed parse_with_scanner(const std::string& href) {
+   Parsed parsed;
+   uripp::ParseResult<uripp::UriView> result = uripp::try_parse_view(href);
+   if (!result) {
+      parsed.error = result.getError();
+      parsed.error_offset = result.getErrorOffset();
+      return parsed;
+   }
+   const uripp::UriView& uri = result.getUri();
+   parsed.ok = true;
+   parsed.relative = uri.isRelativeUri();
+   parsed.scheme = uri.getScheme().str();
+   parsed.authority = uri.getAuthority().str();
+   parsed.path = uri.getPath().str();
+   parsed.query = uri.getQuery().str();
+   parsed.fragment = uri.getFragment().str();
+   parsed.username = uri.getUsername().str();
+   parsed.password = uri.getPassword().str();
+   parsed.host = uri.getHost().str();
+   parsed.port = uri.getPort().str();
+   return parsed;
+}
+
+static bool same_components(const Parsed& a, const Parsed& b) {
+   return a.relative == b.relative && a.scheme == b.scheme && a.authority == b.authority && a.path == b.path &&
+          a.query == b.query && a.fragment == b.fragment;
+}
+
+static bool same_authority(const Parsed& a, const Parsed& b) {
+   return a.username == b.username && a.password == b.password && a.host == b.host && a.port == b.port;
+}
+
+// Whether href[offset] is not a character of a reg-name, or of a userinfo when colon is set
+static bool invalid_char(const std::string& href, std::size_t offset, bool colon) {
+   unsigned char c = static_cast<unsigned char>(href[offset]);
+   if (c == '%') {
+      return offset + 2 >= href.size() || !std::isxdigit(static_cast<unsigned char>(href[offset + 1])) ||
+             !std::isxdigit(static_cast<unsigned char>(href[offset + 2]));
+   }
+   return !(std::isalnum(c) || (c != '\0' && std::strchr("-._~!$&'()*+,;=", c)) || (colon && c == ':'));
+}
+
+// Whether the scanner rejected an authority the patterns accepted for a reason the host and port checks intend, judged
+// by the character at the error offset rather than by the kind of error alone
+static bool intended_rejection(const std::string& href, const Parsed& expected, const Parsed& actual) {
+   std::size_t begin = expected.scheme.size() + 3, end = begin + expected.authority.size(), offset = actual.error_offset;
+   std::size_t at = expected.authority.find('@');
+   at = at == std::string::npos ? std::string::npos : begin + at;
+   std::size_t host = at == std::string::npos ? begin : at + 1;
+   if (offset < begin || offset > end) return false;
+
+   switch (actual.error) {
+      case uripp::parse_error::invalid_port: {
+         // The patterns only take a port of digits, so only its value can be out of range
+         std::size_t colon = href.rfind(':', end - 1);
+         return colon != std::string::npos && colon >= host && offset > colon && offset < end &&
+                (expected.port.size() > 5 || std::atol(expected.port.c_str()) > 65535);
+      }
+      case uripp::parse_error::invalid_authority:
+         return at != std::string::npos && offset < at && invalid_char(href, offset, true);
+      case uripp::parse_error::invalid_host:
+         if (offset == end) return at != std::string::npos && host == end;
+         if (offset < host) return false;
+         if (href[offset] == '@') return at != std::string::npos;
+         if (href[host] == '[') {
+            // An IPv6 address without a zone ID holds only hex digits, ':' and '.'
+            return href[host + 1] != 'v' && expected.host.find('%') == std::string::npos && !std::isxdigit(static_cast<unsigned char>(href[offset])) && href[offset] != ':' &&
+                   href[offset] != '.';
+         }
+         return invalid_char(href, offset, false);
+      default:
+         return false;
+   }
+}
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+
+   template <std::size_t N>
+   const char* pick(const char* const (&pieces)[N]) {
+      return pieces[next() % N];
+   }
+};
+
+static std::string generate(Random& random) {
+   static const char* const schemes[] = {"http:", "https:", "mailto:", "urn:isbn:", "a+b.c-d:", "1x:", "", "", ":", "h t:"};
+   static const char* const authorities[] = {"example.com", "a.b.c", "1.2.3.4", "[::1]", "[v1.x]", "[zz]", "h:80", "h:65535",
+                                             "h:99999", "h:", "h:8a", "u:p@h", "u@h", "@h", "u:@h", ":p@h", "a b", "h%41",
+                                             "[::1]:8080", "h]", "", "u:p:w@h"};
+   static const char* const pieces[] = {"/", "a", "b/c", "%41", ":", "@", "?", "#", "=", "&", "..", " ", "\n", "\r", "\"",
+                                        "{", "~", "!", "//", "?x=1", "#f", "'", "\\", "^", "\xc3\xa9"};
+
+   std::string href = random.pick(schemes);
+   if (random.next() % 2) href += std::string("//") + random.pick(authorities);
+   std::size_t count = random.next() % 6;
+   for (std::size_t i = 0; i < count; ++i) href += random.pick(pieces);
+   return href;
+}
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 400000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+
+   std::size_t accepted = 0, stricter_authority = 0, userinfo = 0, failures = 0;
+   for (std::size_t i = 0; i < count; ++i) {
+      std::string href = generate(random);
+      Parsed expected = parse_with_patterns(href);
+      Parsed actual = parse_with_scanner(href);
+      bool has_at = expected.authority.find('@') != std::string::npos;
+
+      bool pass = true;
+      if (expected.ok && actual.ok) {
+         if (!same_components(expected, actual)) {
+            pass = false;
+         } else if (!same_authority(expected, actual)) {
+            pass = has_at && (expected.username.empty() || (expected.host == actual.host && expected.port == actual.port));
+            if (pass) ++userinfo;
+         } else {
+            ++accepted;
+         }
+      } else if (expected.ok) {
+         pass = intended_rejection(href, expected, actual);
+         if (pass) ++stricter_authority;
+      } else if (actual.ok) {
+         pass = expected.authority_error && has_at;
+         if (pass) ++userinfo;
+      }
+
+      if (!pass && ++failures <= 10) {
+         std::cout << "mismatch: \"" << href << "\" patterns " << (expected.ok ? "accept" : "reject") << ", scanner "
+                   << (actual.ok ? "accepts" : "rejects") << std::endl;
+      }
+   }
+
+   std::cout << count << " hrefs, " << accepted << " accepted alike, " << stricter_authority
+             << " authorities rejected by the host and port checks, " << userinfo << " userinfo splits, " << failures
+             << " mismatches" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#include "include/uri.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Test of the in-place setters of Uri.
+//
+//   test_setters [COUNT] [SEED]
+//
+// COUNT random calls of setHost(), setPort(), setPath(), setQuery(), setFragment() and removeQueryParam() are made on
+// Uris of many shapes, four in a row on each. After every call the components of the Uri must be those of a fresh parse
+// of its href, and a call that throws must leave the href unchanged.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+
+   template <std::size_t N>
+   const char* pick(const char* const (&pieces)[N]) {
+      return pieces[next() % N];
+   }
+};
+
+static std::string dump(const uripp::UriView& uri) {
+   std::string out = uri.isRelativeUri() ? "relative\n" : "absolute\n";
+   for (uripp::StringView part : {uri.getScheme(), uri.getAuthority(), uri.getPath(), uri.getQuery(), uri.getFragment(),
+                                  uri.getUsername(), uri.getPassword(), uri.getHost(), uri.getPort()}) {
+      out += part.str();
+      out += '\n';
+   }
+   for (bool has : {uri.hasAuthority(), uri.hasQuery(), uri.hasFragment(), uri.hasPort()}) out += has ? '1' : '0';
+   out += std::to_string(static_cast<int>(uri.getHostType()));
+   return out;
+}
+
+static const char* const bases[] = {
+   "http://example.com/a/b?x=1&utm_source=z&y=2#frag", "https://u:p@[::1]:8080/p", "http://h", "http://h?q", "http:///p",
+   "http://h/p?", "http://h/p#", "mailto:a@b", "urn:x:y", "file:/etc/x", "foo:", "/rel/path?a=1#f", "rel?x", "?q", "#f", "",
+   "a/b", "//net/p", "http://[v1.x]/", "http://1.2.3.4:1/", "http://h:80",
+};
+
+static const char* const values[] = {
+   "", "new.host", "[::2]", "1.2.3.4", "bad host", "h:1", "[zz]", "/", "/x/y", "x", "//z", "a:b", "?", "#", "8080", "99999",
+   "a=1&b=2", "a b", "q#", "frag\n", "utm_source=1", "%41", "x/y:z", "65535", "0",
+};
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 800000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+
+   std::size_t applied = 0, thrown = 0, failures = 0;
+   uripp::Uri uri(random.pick(bases));
+   for (std::size_t i = 0; i < count; ++i) {
+      if (i % 4 == 0) uri = uripp::Uri(random.pick(bases), random.next() % 2 ? uripp::parse_mode::lazy : uripp::parse_mode::eager);
+
+      std::string before = uri.getHref();
+      std::string value = random.pick(values);
+      std::uint64_t call = random.next() % 7;
+      std::string error;
+      try {
+         switch (call) {
+            case 0: uri.setHost(value); break;
+            case 1: uri.setPort(value); break;
+            case 2: uri.setPath(value); break;
+            case 3: uri.setQuery(value); break;
+            case 4: uri.setFragment(value); break;
+            case 5: uri.removeQueryParam(value.substr(0, value.find('=')).empty() ? "y" : value.substr(0, value.find('=')), "&;"); break;
+            default: uri.setPort(static_cast<std::uint16_t>(random.next() % 3 ? random.next() : 0)); break;
+         }
+         ++applied;
+
+         std::string href = uri.getHref();
+         uripp::ParseResult<uripp::UriView> fresh = uripp::try_parse_view(href);
+         if (!fresh || dump(fresh.getUri()) != dump(uri.view())) error = "differs from a fresh parse";
+         else if (call == 0 && uri.view().getHost() != value) error = "host not set";
+         else if (call == 2 && uri.view().getPath() != value) error = "path not set";
+         else if (uripp::Uri(uri).getHref() != uri.getHref()) error = "copy differs";
+      } catch (const std::invalid_argument&) {
+         ++thrown;
+         if (uri.getHref() != before) error = "changed by a call that threw";
+      } catch (const std::domain_error&) {
+         ++thrown;
+         if (uri.getHref() != before) error = "changed by a call that threw";
+      }
+      if (!error.empty() && ++failures <= 10) {
+         std::cout << "call " << call << " with \"" << value << "\" on " << before << " gives " << uri.getHref() << ": " << error << std::endl;
+      }
+   }
+
+   // A value may view the href it replaces a part of
+   uripp::Uri aliased("http://h/abc?q");
+   aliased.setPath(aliased.view().getPath().substr(0, 2));
+   aliased.setQuery(aliased.view().getHref());
+   if (aliased.getHref() != "http://h/a?http://h/a?q") {
+      std::cout << "aliased value: " << aliased.getHref() << std::endl;
+      ++failures;
+   }
+
+   // A copy of a lazily parsed Uri is not changed by a setter of the original
+   uripp::Uri lazy("http://u@h:1/p", uripp::parse_mode::lazy);
+   uripp::Uri copy(lazy);
+   lazy.setPort("");
+   if (lazy.getHref() != "http://u@h/p" || lazy.getUsername() != "u" || copy.getPort() != "1") {
+      std::cout << "lazy copy: " << lazy.getHref() << ", copy port " << copy.getPort() << std::endl;
+      ++failures;
+   }
+
+   std::cout << count << " calls, " << applied << " applied, " << thrown << " thrown, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
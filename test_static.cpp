@@ -0,0 +1,103 @@
+#include "include/uri_static.hpp"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Test of StaticUri.
+//
+//   test_static
+//
+// From C++14 on the components, port number and host type of _uri literals are checked by static_assert, so a change
+// that makes StaticUri no longer constexpr fails to compile. Before C++14 the same checks run when the test runs.
+// Then StaticUri must accept the hrefs Uri accepts, with the same components.
+
+using namespace uripp::literals;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+   if (ok) return;
+   std::cout << "FAILED: " << what << std::endl;
+   ++failures;
+}
+
+static URIPP_CONSTEXPR14 bool same(uripp::StringView view, const char* text) {
+   std::size_t size = 0;
+   while (text[size] != '\0') ++size;
+   if (view.size() != size) return false;
+   for (std::size_t i = 0; i < size; ++i) {
+      if (view[i] != text[i]) return false;
+   }
+   return true;
+}
+
+template <typename U>
+static std::string dump(const U& uri) {
+   std::string out = uri.isRelativeUri() ? "relative" : "absolute";
+   for (uripp::StringView part : {uri.getScheme(), uri.getAuthority(), uri.getPath(), uri.getQuery(), uri.getFragment(),
+                                  uri.getUsername(), uri.getPassword(), uri.getHost(), uri.getPort()}) {
+      out += '|';
+      out += part.str();
+   }
+   return out;
+}
+
+#if __cplusplus >= 201402L
+#define STATIC_URI constexpr uripp::StaticUri
+#define STATIC_CHECK(ok, what) static_assert(ok, what)
+#else
+#define STATIC_URI const uripp::StaticUri
+#define STATIC_CHECK(ok, what) check(ok, what)
+#endif
+
+int main() {
+   STATIC_URI api = "https://user:pw@api.example.com:8443/v1/items?x=1#top"_uri;
+   STATIC_CHECK(same(api.getScheme(), "https") && same(api.getAuthority(), "user:pw@api.example.com:8443"), "scheme and authority");
+   STATIC_CHECK(same(api.getUsername(), "user") && same(api.getPassword(), "pw") && same(api.getHost(), "api.example.com"),
+                "userinfo and host");
+   STATIC_CHECK(same(api.getPort(), "8443") && api.getPortNumber() == 8443, "port");
+   STATIC_CHECK(same(api.getPath(), "/v1/items") && same(api.getQuery(), "x=1") && same(api.getFragment(), "top"),
+                "path, query and fragment");
+   STATIC_CHECK(api.hasAuthority() && api.hasPassword() && api.hasPort() && !api.isRelativeUri(), "flags");
+   STATIC_CHECK(api.getHostType() == uripp::host_type::reg_name, "reg-name host");
+
+   STATIC_URI v6 = "http://[2001:db8::1%25eth0]:80/"_uri;
+   STATIC_CHECK(v6.getHostType() == uripp::host_type::ipv6 && same(v6.getHost(), "[2001:db8::1%25eth0]") && v6.getPortNumber() == 80,
+                "IPv6 host");
+   STATIC_URI v4 = "http://10.0.0.1/"_uri;
+   STATIC_CHECK(v4.getHostType() == uripp::host_type::ipv4 && !v4.hasPort() && v4.getPortNumber() == 0, "IPv4 host");
+   STATIC_URI future = "http://[v1.x]/"_uri;
+   STATIC_CHECK(future.getHostType() == uripp::host_type::ipv_future, "IPvFuture host");
+
+   STATIC_URI relative = "/health?full"_uri;
+   STATIC_CHECK(relative.isRelativeUri() && same(relative.getPath(), "/health") && same(relative.getQuery(), "?full"), "relative");
+   STATIC_URI mail = "mailto:me@x.org"_uri;
+   STATIC_CHECK(!mail.hasAuthority() && same(mail.getPath(), "me@x.org"), "no authority");
+
+#if __cplusplus >= 201703L
+   static_assert(api.getHost() == "api.example.com" && relative.getPath() == "/health", "comparison with a literal");
+#endif
+
+   static const char* const hrefs[] = {"http://a/b", "x:y", "/", "http://h:1/p?q#f", "a/b?c#d", "http://u@h/", "mailto:me@x.org",
+                                       "http://[v1.x]/", "", "?q", "#f", "//net/p", "http://[::1", "http://h:99999/", "/a b",
+                                       "http://a:b@c@h/"};
+   for (const char* href : hrefs) {
+      uripp::ParseResult<uripp::UriView> parsed = uripp::try_parse_view(href);
+      std::string expected = parsed ? dump(parsed.getUri()) : "invalid", actual;
+      try {
+         uripp::StaticUri uri(href, std::strlen(href));
+         actual = dump(uri);
+         check(uri.toUri().getHref() == href && dump(uri.view()) == actual, "toUri() and view()");
+      } catch (const std::invalid_argument&) {
+         actual = "invalid";
+      }
+      if (actual != expected) {
+         std::cout << "\"" << href << "\": " << actual << ", expected " << expected << std::endl;
+         ++failures;
+      }
+   }
+
+   std::cout << "C++ " << __cplusplus << ", " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include "include/uri_store.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Round-trip test of UriStore, with and without prefix interning.
+//
+//   test_store [COUNT] [SEED]
+//
+// COUNT random hrefs are added to a store with small arena blocks, and one in a thousand is made longer than 64 KiB so
+// that it takes a wide component table. tryAdd() must accept the hrefs try_parse_view() accepts. Every URI read back
+// by handle, through get(), has(), copyHref(), toUri() and view(), must match a parse of its href. The store must
+// then hold the same after clear() and a second fill.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+};
+
+static std::string generate(Random& random) {
+   static const char* const pieces[] = {"http", "://", "a", "B", "%41", ".", "/", "?", "#", ":80", ":", "@", "x", "y=1", "u:p@"};
+   std::string href;
+   std::size_t size = random.next() % 10;
+   for (std::size_t k = 0; k < size; ++k) href += pieces[random.next() % (sizeof(pieces) / sizeof(*pieces))];
+   if (random.next() % 1000 == 0) href = "https://u:p@wide.example.com:8443/" + std::string(70000, 'a') + "?q=1#f";
+   return href;
+}
+
+static const uripp::uri_components components[] = {
+   uripp::uri_components::scheme, uripp::uri_components::authority, uripp::uri_components::path,
+   uripp::uri_components::query, uripp::uri_components::fragment, uripp::uri_components::username,
+   uripp::uri_components::password, uripp::uri_components::host, uripp::uri_components::port,
+};
+
+static uripp::StringView component(const uripp::UriView& uri, uripp::uri_components comp) {
+   switch (comp) {
+      case uripp::uri_components::scheme: return uri.getScheme();
+      case uripp::uri_components::authority: return uri.getAuthority();
+      case uripp::uri_components::path: return uri.getPath();
+      case uripp::uri_components::query: return uri.getQuery();
+      case uripp::uri_components::fragment: return uri.getFragment();
+      case uripp::uri_components::username: return uri.getUsername();
+      case uripp::uri_components::password: return uri.getPassword();
+      case uripp::uri_components::host: return uri.getHost();
+      default: return uri.getPort();
+   }
+}
+
+// The first way a stored URI differs from a parse of its href, or an empty string
+static std::string compare(const uripp::UriStore& store, uripp::UriHandle handle, const std::string& href, bool interned) {
+   uripp::UriView expected = uripp::try_parse_view(href).getUri();
+   if (store.getHref(handle) != href || store.hrefSize(handle) != href.size()) return "href";
+   if (store.isRelativeUri(handle) != expected.isRelativeUri()) return "isRelativeUri";
+   for (uripp::uri_components comp : components) {
+      if (store.get(handle, comp) != component(expected, comp)) return "get(" + std::to_string(static_cast<int>(comp)) + ")";
+   }
+   if (store.has(handle, uripp::uri_components::authority) != expected.hasAuthority() ||
+       store.has(handle, uripp::uri_components::query) != expected.hasQuery() ||
+       store.has(handle, uripp::uri_components::fragment) != expected.hasFragment() ||
+       store.has(handle, uripp::uri_components::port) != expected.hasPort()) return "has";
+
+   uripp::Uri copy = store.toUri(handle);
+   if (copy.getHref() != href || copy.view().getPath() != expected.getPath() || copy.view().getHost() != expected.getHost()) return "toUri";
+   if (!interned && store.view(handle).getHref() != href) return "view";
+   return std::string();
+}
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 100000;
+   std::uint64_t seed = argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull;
+
+   std::size_t failures = 0;
+   for (bool interned : {false, true}) {
+      uripp::UriStore store(interned, 4096);
+      std::size_t wide = 0;
+      for (int fill = 0; fill < 2; ++fill) {
+         Random random{seed};
+         std::vector<std::string> hrefs;
+         std::vector<uripp::UriHandle> handles;
+         for (std::size_t i = 0; i < count; ++i) {
+            std::string href = generate(random);
+            uripp::ParseResult<uripp::UriHandle> added = store.tryAdd(href);
+            uripp::ParseResult<uripp::UriView> parsed = uripp::try_parse_view(href);
+            if (added.ok() != parsed.ok() || (!added && added.getError() != parsed.getError())) {
+               if (++failures <= 10) std::cout << "\"" << href << "\": tryAdd() and try_parse_view() disagree" << std::endl;
+               continue;
+            }
+            if (!added) continue;
+            wide += href.size() > UINT16_MAX;
+            hrefs.push_back(href);
+            handles.push_back(added.getUri());
+         }
+
+         if (store.size() != hrefs.size()) {
+            std::cout << "size " << store.size() << ", expected " << hrefs.size() << std::endl;
+            ++failures;
+         }
+         for (std::size_t i = 0; i < hrefs.size(); ++i) {
+            std::string error = compare(store, handles[i], hrefs[i], interned);
+            if (!error.empty() && ++failures <= 10) std::cout << "\"" << hrefs[i].substr(0, 80) << "\": " << error << " differs" << std::endl;
+         }
+
+         uripp::UriStoreStats stats = store.getStats();
+         std::cout << (interned ? "interned" : "plain") << " fill " << fill << ": " << stats.uris << " uris, " << stats.interned_prefixes
+                   << " prefixes, " << stats.arena_blocks << " arena blocks" << std::endl;
+         store.clear();
+      }
+      if (wide == 0) {
+         std::cout << "no href took a wide component table" << std::endl;
+         ++failures;
+      }
+   }
+
+   std::cout << count << " hrefs per fill, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
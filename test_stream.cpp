@@ -0,0 +1,132 @@
+#include "include/uri_stream.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Differential test of UriStreamParser against a one-shot parse.
+//
+//   test_stream [COUNT] [SEED]
+//
+// Random hrefs are fed to a UriStreamParser in random chunks of 1 to 4 characters. It must accept the hrefs
+// try_parse_view() accepts, with the same components, and reject the others with the same error at the same offset.
+// Then the maximum length, terminators and getConsumed() are checked on fixed inputs.
+
+struct Random {
+   std::uint64_t state;
+
+   std::uint64_t next() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+   }
+};
+
+static std::string dump(const uripp::UriView& uri) {
+   std::string out = uri.isRelativeUri() ? "relative\n" : "absolute\n";
+   for (uripp::StringView part : {uri.getHref(), uri.getScheme(), uri.getAuthority(), uri.getPath(), uri.getQuery(),
+                                  uri.getFragment(), uri.getUsername(), uri.getPassword(), uri.getHost(), uri.getPort()}) {
+      out += part.str();
+      out += '\n';
+   }
+   for (bool has : {uri.hasAuthority(), uri.hasQuery(), uri.hasFragment(), uri.hasUsername(), uri.hasPassword(), uri.hasPort()}) {
+      out += has ? '1' : '0';
+   }
+   return out;
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+   if (ok) return;
+   std::cout << "FAILED: " << what << std::endl;
+   ++failures;
+}
+
+int main(int argc, char** argv) {
+   std::size_t count = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 550000;
+   Random random{argc > 2 ? static_cast<std::uint64_t>(std::atoll(argv[2])) : 88172645463325252ull};
+   static const char* const pieces[] = {"http", "://", "/", "//", "?", "#", ":", "@", "a", "b.c", "[::1]", "[v1.x]", "%20",
+                                        "%zz", " ", "\r", "\n", "{", "80", "99999", "x=1&y", "user:pw@", "-", ".", "..",
+                                        "/a/b", "[", "]", "'", "+"};
+
+   std::size_t rejected = 0, mismatches = 0;
+   uripp::UriStreamParser parser;
+   for (std::size_t i = 0; i < count; ++i) {
+      std::string href;
+      std::size_t size = random.next() % 8;
+      for (std::size_t k = 0; k < size; ++k) href += pieces[random.next() % (sizeof(pieces) / sizeof(*pieces))];
+
+      uripp::stream_status status = uripp::stream_status::need_more;
+      bool consumed_all = true;
+      for (std::size_t at = 0; at < href.size() && status == uripp::stream_status::need_more;) {
+         std::size_t chunk = std::min<std::size_t>(1 + random.next() % 4, href.size() - at);
+         status = parser.feed(uripp::StringView(href.data() + at, chunk));
+         consumed_all = consumed_all && (status == uripp::stream_status::error || parser.getConsumed() == chunk);
+         at += chunk;
+      }
+      if (status == uripp::stream_status::need_more) status = parser.finish();
+
+      uripp::ParseResult<uripp::UriView> expected = uripp::try_parse_view(href);
+      bool same;
+      if (!expected) {
+         ++rejected;
+         same = status == uripp::stream_status::error && parser.getError() == expected.getError() &&
+                parser.getErrorOffset() == expected.getErrorOffset();
+      } else {
+         same = status == uripp::stream_status::done && dump(parser.view()) == dump(expected.getUri()) &&
+                parser.release().getHref() == href && parser.size() == 0;
+      }
+      if ((!same || !consumed_all) && ++mismatches <= 10) {
+         std::cout << "mismatch: \"" << href << "\" " << (expected ? "accepted" : uripp::ErrorToString(expected.getError()))
+                   << " by try_parse_view, stream error " << uripp::ErrorToString(parser.getError()) << std::endl;
+      }
+      parser.reset();
+   }
+   failures += static_cast<int>(mismatches);
+
+   // A terminator ends the href; the characters after it are left in the chunk
+   uripp::UriStreamParser terminated(64, " \"");
+   check(terminated.feed("/pa") == uripp::stream_status::need_more && terminated.getConsumed() == 3, "feed before the terminator");
+   check(terminated.feed("th?q=1 HTTP/1.1") == uripp::stream_status::done && terminated.getConsumed() == 6, "feed up to the terminator");
+   check(terminated.view().getPath() == "/path" && terminated.view().getQuery() == "?q=1", "components of a terminated href");
+   check(terminated.feed("more") == uripp::stream_status::done && terminated.getConsumed() == 0, "feed once done");
+   check(terminated.release().getHref() == "/path?q=1" && terminated.getStatus() == uripp::stream_status::need_more, "release");
+   check(terminated.feed("http://h:1/x\"") == uripp::stream_status::done && terminated.release().getPort() == "1", "'\"' terminator");
+
+   // The buffer never grows past the maximum length
+   check(terminated.feed(std::string(60, 'a')) == uripp::stream_status::need_more, "feed up to the maximum length");
+   check(terminated.feed("aaaaa") == uripp::stream_status::error && terminated.getError() == uripp::parse_error::too_long &&
+         terminated.getErrorOffset() == 64 && terminated.size() <= 64, "too_long");
+   terminated.reset();
+   check(terminated.feed(std::string(64, 'a')) == uripp::stream_status::need_more && terminated.finish() == uripp::stream_status::done,
+         "an href of exactly the maximum length");
+
+   // An invalid character is rejected as soon as it is fed
+   uripp::UriStreamParser early;
+   check(early.feed("/a{") == uripp::stream_status::error && early.getError() == uripp::parse_error::invalid_character &&
+         early.getErrorOffset() == 2, "early error");
+
+   bool threw = false;
+   try {
+      uripp::UriStreamParser parser(10, "abcde");
+   } catch (const std::invalid_argument&) {
+      threw = true;
+   }
+   check(threw, "more than four terminators");
+
+   threw = false;
+   try {
+      uripp::UriStreamParser parser;
+      parser.view();
+   } catch (const std::domain_error&) {
+      threw = true;
+   }
+   check(threw, "view() before done");
+
+   std::cout << count << " hrefs, " << rejected << " rejected, " << mismatches << " mismatches, " << failures << " failures" << std::endl;
+   return failures == 0 ? 0 : 1;
+}
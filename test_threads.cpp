@@ -0,0 +1,104 @@
+#include "include/uri.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Stress test of sharing parsed Uris read-only across threads.
+//
+//   test_threads [THREADS] [ROUNDS]
+//
+// Every round, THREADS threads read one shared vector of lazily parsed Uris, a fifth of them with an invalid authority,
+// in a different order each, so that they race to split the same authorities. Every getter, copy and view must agree
+// with an eager parse of the same href. Build it with -fsanitize=thread to also check for data races.
+
+static_assert(std::is_nothrow_move_constructible<uripp::Uri>::value, "std::vector<Uri> must move on growth");
+static_assert(std::is_nothrow_move_assignable<uripp::Uri>::value, "moving a Uri must not throw");
+
+struct Expected {
+   bool valid;
+   std::string host, port, username, authority_components;
+};
+
+static std::string components(const uripp::Uri& uri) {
+   std::string out;
+   for (const auto& entry : uri.getAuthorityComponents()) {
+      out += entry.second.str();
+      out += '|';
+   }
+   return out;
+}
+
+static std::string make_href(std::size_t i) {
+   std::string n = std::to_string(i);
+   switch (i % 5) {
+      case 0: return "https://host" + n + ".example.com/p/" + n + "?q=" + n;
+      case 1: return "http://user" + n + ":pw@10.0." + std::to_string(i % 256) + ".1:" + std::to_string(1024 + i % 60000) + "/";
+      case 2: return "https://[2001:db8::" + std::to_string(i % 9999) + "]:8443/a#f";
+      case 3: return "http://www.site" + n + ".org";
+      default: return "http://bad host" + n + "/p";
+   }
+}
+
+int main(int argc, char** argv) {
+   unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 64;
+   unsigned rounds = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 5;
+   const std::size_t count = 2000;
+
+   std::vector<std::string> hrefs;
+   std::vector<Expected> expected;
+   for (std::size_t i = 0; i < count; ++i) {
+      hrefs.push_back(make_href(i));
+      Expected e;
+      e.valid = uripp::try_parse_view(hrefs.back()).ok();
+      if (e.valid) {
+         uripp::Uri eager(hrefs.back());
+         e.host = eager.getHost();
+         e.port = eager.getPort();
+         e.username = eager.getUsername();
+         e.authority_components = components(eager);
+      }
+      expected.push_back(e);
+   }
+
+   std::atomic<std::size_t> mismatches(0), checks(0);
+   for (unsigned round = 0; round < rounds; ++round) {
+      std::vector<uripp::Uri> shared;
+      shared.reserve(count);
+      for (const std::string& href : hrefs) shared.emplace_back(href, uripp::parse_mode::lazy);
+
+      std::vector<std::thread> workers;
+      for (unsigned t = 0; t < threads; ++t) {
+         workers.emplace_back([&, t]() {
+            for (std::size_t k = 0; k < count; ++k) {
+               std::size_t i = (k * (2 * t + 1) + t * 31) % count;
+               const uripp::Uri& uri = shared[i];
+               const Expected& e = expected[i];
+               bool ok;
+               try {
+                  switch ((k + t) % 4) {
+                     case 0: ok = uri.getHost() == e.host && uri.hasPort() == !e.port.empty(); break;
+                     case 1: { uripp::Uri copy(uri); ok = copy.getPort() == e.port && copy.getUsername() == e.username; break; }
+                     case 2: ok = uri.view().getHost() == e.host; break;
+                     default: ok = components(uri) == e.authority_components; break;
+                  }
+                  ok = ok && e.valid;
+               } catch (const std::invalid_argument&) {
+                  ok = !e.valid;
+               }
+               // path and query never need the authority, so they read the same whether or not it is valid
+               ok = ok && uri.getPath() == uripp::Uri(hrefs[i], uripp::parse_mode::lazy).getPath();
+               if (!ok) ++mismatches;
+               ++checks;
+            }
+         });
+      }
+      for (std::thread& worker : workers) worker.join();
+   }
+
+   std::cout << threads << " threads, " << rounds << " rounds, " << checks << " checks, " << mismatches << " mismatches" << std::endl;
+   return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#include "../include/uri_log.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// Counts the hosts and paths requested in an access log.
+//
+//   uri_log_stats [--threads N] [--field request|N] [--delimiter C] [--host-field N] [--top K] [--baseline] FILE
+//
+// --field selects the URI field: the request-target of a Common/Combined Log Format line (default), or column N.
+// --host-field selects a column to count as the host of relative request-targets, e.g. a virtual host column.
+// --baseline counts with std::getline and one Uri per line instead, for comparison.
+
+static void usage() {
+   std::cerr << "usage: uri_log_stats [--threads N] [--field request|N] [--delimiter C] [--host-field N] [--top K] [--baseline] FILE" << std::endl;
+   std::exit(2);
+}
+
+static void print(const char* title, const uripp::LogCounters::Ranking& ranking) {
+   std::cout << title << std::endl;
+   for (const auto& entry : ranking) {
+      std::cout << "  " << entry.second << "\t" << (entry.first.empty() ? uripp::StringView("(none)") : entry.first) << std::endl;
+   }
+}
+
+static int baseline(const std::string& path, const uripp::LogField& field) {
+   std::ifstream in(path, std::ios::binary);
+   if (!in) {
+      std::cerr << "Cannot open " << path << std::endl;
+      return 1;
+   }
+
+   std::unordered_map<std::string, std::uint64_t> hosts, paths;
+   std::uint64_t lines = 0, parsed = 0, rejected = 0;
+   std::string line;
+   while (std::getline(in, line)) {
+      if (!line.empty() && line[line.size() - 1] == '\r') line.pop_back();
+      ++lines;
+      uripp::StringView value = field.extract(line);
+      if (value.empty()) continue;
+      try {
+         uripp::Uri uri(static_cast<std::string>(value));
+         ++parsed;
+         ++hosts[uri.isRelativeUri() ? std::string() : static_cast<std::string>(uri.getHost())];
+         ++paths[static_cast<std::string>(uri.getPath())];
+      } catch (const std::invalid_argument&) {
+         ++rejected;
+      }
+   }
+
+   std::cout << "lines " << lines << ", parsed " << parsed << ", rejected " << rejected << std::endl;
+   std::cout << "distinct hosts " << hosts.size() << ", distinct paths " << paths.size() << std::endl;
+   return 0;
+}
+
+int main(int argc, char** argv) {
+   unsigned threads = 0;
+   uripp::LogField field = uripp::LogField::requestTarget();
+   std::size_t field_column = 0;
+   bool field_is_column = false;
+   char delimiter = ' ';
+   long host_field = -1;
+   std::size_t top = 10;
+   bool run_baseline = false;
+   std::string path;
+
+   for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool has_value = i + 1 < argc;
+      if (arg == "--threads" && has_value) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+      else if (arg == "--field" && has_value) {
+         std::string value = argv[++i];
+         field_is_column = value != "request";
+         if (field_is_column) field_column = static_cast<std::size_t>(std::atol(value.c_str()));
+      }
+      else if (arg == "--delimiter" && has_value) delimiter = std::strcmp(argv[++i], "\\t") == 0 ? '\t' : argv[i][0];
+      else if (arg == "--host-field" && has_value) host_field = std::atol(argv[++i]);
+      else if (arg == "--top" && has_value) top = static_cast<std::size_t>(std::atol(argv[++i]));
+      else if (arg == "--baseline") run_baseline = true;
+      else if (!arg.empty() && arg[0] != '-' && path.empty()) path = arg;
+      else usage();
+   }
+   if (path.empty()) usage();
+   if (field_is_column) field = uripp::LogField::column(field_column, delimiter);
+
+   auto start = std::chrono::steady_clock::now();
+   if (run_baseline) {
+      int status = baseline(path, field);
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "elapsed " << elapsed.count() << " ms" << std::endl;
+      return status;
+   }
+
+   try {
+      uripp::MappedFile file(path);
+      std::vector<uripp::StringView> chunks = uripp::split_log(file.view());
+      uripp::WorkerPool pool(threads);
+      uripp::LogCounters counters(chunks.size());
+      uripp::LogField host_column = uripp::LogField::column(host_field < 0 ? 0 : static_cast<std::size_t>(host_field), delimiter);
+
+      uripp::scan_log(chunks, field, pool, [&](std::size_t chunk, uripp::StringView line, uripp::StringView value,
+                                               const uripp::ParseResult<uripp::UriView>& uri) {
+         counters.count(chunk, value, uri, host_field < 0 ? uripp::StringView() : host_column.extract(line));
+      });
+      counters.merge();
+
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "lines " << counters.getLines() << ", parsed " << counters.getParsed() << ", rejected "
+                << counters.getRejected() << std::endl;
+      print("top hosts", counters.topHosts(top));
+      print("top paths", counters.topPaths(top));
+      std::cout << "elapsed " << elapsed.count() << " ms on " << pool.size() << " threads" << std::endl;
+   } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}